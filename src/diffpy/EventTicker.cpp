@@ -20,12 +20,27 @@
 *
 *****************************************************************************/
 
+#include <mutex>
+
 #include <diffpy/EventTicker.hpp>
 #include <diffpy/serialization.ipp>
 
 namespace diffpy {
 namespace eventticker {
 
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// guard of the global ticker for calculators used in parallel threads
+std::mutex& globalTickLock()
+{
+    static std::mutex lck;
+    return lck;
+}
+
+}   // namespace
+
 //////////////////////////////////////////////////////////////////////////////
 // class EventTicker
 //////////////////////////////////////////////////////////////////////////////
@@ -39,6 +54,7 @@ EventTicker::EventTicker() : mtick(0, 0)
 
 void EventTicker::click()
 {
+    std::lock_guard<std::mutex> lck(globalTickLock());
     ++gtick.second;
     if (0 >= gtick.second)
     {
@@ -25,6 +25,16 @@
 # define DIFFPY_HAS_OBJCRYST
 #endif
 
+// distributed evaluation with MPI
+#if ${DIFFPY_HAS_MPI}
+# define DIFFPY_HAS_MPI
+#endif
+
+// numerical kernels compiled for several x86_64 instruction sets
+#if ${DIFFPY_HAS_SIMD_DISPATCH}
+# define DIFFPY_HAS_SIMD_DISPATCH
+#endif
+
 #endif  // FEATURES_HPP_INCLUDED
 
 // vim:ft=cpp:
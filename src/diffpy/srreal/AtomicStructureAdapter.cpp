@@ -152,6 +152,17 @@ const R3::Matrix& AtomicStructureAdapter::siteCartesianUij(int idx) const
     return matoms[idx].uij_cartn;
 }
 
+
+MemoryUsage AtomicStructureAdapter::memoryUsage() const
+{
+    MemoryUsage rv;
+    size_t nbytes = byteSize(matoms);
+    const_iterator ai = matoms.begin();
+    for (; ai != matoms.end(); ++ai)  nbytes += byteSize(ai->atomtype);
+    rv.add("atoms", nbytes);
+    return rv;
+}
+
 // helper for diff
 namespace {
 
@@ -162,6 +173,28 @@ bool cmpatomindex(const atomindex& ai0, const atomindex& ai1)
     return (*(ai0.first) < *(ai1.first));
 }
 
+
+/// Return true if atoms differ only in isotropic displacement parameters.
+bool differsInUisoOnly(const Atom& a0, const Atom& a1)
+{
+    bool rv = !a0.anisotropy && !a1.anisotropy &&
+        a0.atomtype == a1.atomtype &&
+        a0.xyz_cartn == a1.xyz_cartn &&
+        a0.occupancy == a1.occupancy;
+    return rv;
+}
+
+
+/// Return true if atoms differ only in occupancy.
+bool differsInOccupancyOnly(const Atom& a0, const Atom& a1)
+{
+    bool rv = a0.atomtype == a1.atomtype &&
+        a0.xyz_cartn == a1.xyz_cartn &&
+        a0.anisotropy == a1.anisotropy &&
+        a0.uij_cartn == a1.uij_cartn;
+    return rv;
+}
+
 }   // namespace
 
 StructureDifference
@@ -188,6 +221,11 @@ AtomicStructureAdapter::diff(StructureAdapterConstPtr other) const
         {
             sd.pop0.push_back(i);
             sd.add1.push_back(i);
+            if (differsInUisoOnly(*ai0, *ai1))  sd.displaced.push_back(i);
+            if (differsInOccupancyOnly(*ai0, *ai1))
+            {
+                sd.reoccupied.push_back(i);
+            }
         }
     }
     for (int i = nboth; ai0 != astru0.matoms.end(); ++i, ++ai0)
@@ -198,11 +236,15 @@ AtomicStructureAdapter::diff(StructureAdapterConstPtr other) const
     {
         sd.add1.push_back(i);
     }
-    if (sd.allowsfastupdate())  return sd;
+    // changes of displacement or occupancy may apply to many sites
+    if (sd.allowsfastupdate() || sd.displacementonly() ||
+            sd.occupancyonly())  return sd;
     // here the structures differ too much when compared side by side.
     // Let's compare assuming no relation in atom site order.
     sd.pop0.clear();
     sd.add1.clear();
+    sd.displaced.clear();
+    sd.reoccupied.clear();
     // let's build sorted vectors of atoms in stru0 and stru1
     sd.diffmethod = StructureDifference::Method::SORTED;
     std::vector<atomindex> satoms0, satoms1;
@@ -99,6 +99,7 @@ class AtomicStructureAdapter : public StructureAdapter
         virtual bool siteAnisotropy(int idx) const;
         virtual const R3::Matrix& siteCartesianUij(int idx) const;
         virtual StructureDifference diff(StructureAdapterConstPtr other) const;
+        virtual MemoryUsage memoryUsage() const;
 
         // methods - own
         iterator insert(int, const Atom&);
@@ -197,8 +197,7 @@ const R3::Matrix& BaseBondGenerator::Ucartesian1() const
 
 double BaseBondGenerator::msd() const
 {
-    static R3::Vector s;
-    s = this->r01();
+    const R3::Vector& s = this->r01();
     double msd0 = meanSquareDisplacement(this->Ucartesian0(), s,
             mstructure->siteAnisotropy(this->site0()));
     double msd1 = meanSquareDisplacement(this->Ucartesian1(), s,
@@ -207,6 +206,16 @@ double BaseBondGenerator::msd() const
     return rv;
 }
 
+R3::Vector BaseBondGenerator::msdGradient() const
+{
+    const R3::Vector& s = this->r01();
+    R3::Vector rv = meanSquareDisplacementGradient(this->Ucartesian0(), s,
+            mstructure->siteAnisotropy(this->site0()));
+    rv += meanSquareDisplacementGradient(this->Ucartesian1(), s,
+            mstructure->siteAnisotropy(this->site1()));
+    return rv;
+}
+
 // Protected Methods ---------------------------------------------------------
 
 bool BaseBondGenerator::iterateSymmetry()
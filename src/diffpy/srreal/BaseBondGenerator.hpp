@@ -45,9 +45,9 @@ class BaseBondGenerator
 
         // configuration
         virtual void selectAnchorSite(int);
-        void selectSiteRange(int first, int last);
-        void selectSites(const SiteIndices&);
-        void selectSites(
+        virtual void selectSiteRange(int first, int last);
+        virtual void selectSites(const SiteIndices&);
+        virtual void selectSites(
                 SiteIndices::const_iterator first,
                 SiteIndices::const_iterator last);
         virtual void setRmin(double);
@@ -65,7 +65,9 @@ class BaseBondGenerator
         const R3::Vector& r01() const;
         virtual const R3::Matrix& Ucartesian0() const;
         virtual const R3::Matrix& Ucartesian1() const;
-        double msd() const;
+        virtual double msd() const;
+        /// gradient of msd() with respect to the bond vector r01
+        R3::Vector msdGradient() const;
 
     protected:
 
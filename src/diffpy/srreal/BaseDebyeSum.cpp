@@ -17,12 +17,17 @@
 *****************************************************************************/
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include <string>
 #include <stdexcept>
 #include <sstream>
 #include <functional>
+#include <unordered_set>
 
 #include <diffpy/srreal/BaseDebyeSum.hpp>
+#include <diffpy/srreal/StructureAdapter.hpp>
+#include <diffpy/srreal/SIMDKernels.hpp>
 #include <diffpy/mathutils.hpp>
 #include <diffpy/validators.hpp>
 #include <diffpy/serialization.ipp>
@@ -42,6 +47,39 @@ namespace {
 /// Default cutoff for the Q-decreasing scale of the sine contributions.
 const double DEFAULT_DEBYE_PRECISION = 1e-6;
 
+/// Conversion from the FWHM to sigma of the Debye-Waller Gaussian.
+const double FWHM_TO_SIGMA = 1.0 / (2 * sqrt(2 * M_LN2));
+
+/// Grid points of binned Gaussian peaks per the shortest period of sin(Q r).
+const int PEAK_POINTS_PER_PERIOD = 8;
+
+/// Add sine transform of weights w[b] at distances b * rstep to y[kq]
+/// scaled by sf0[kq] * sf1[kq] for kqlo <= kq < kqhi.
+void _addSineTransform(double* y, const double* sf0, const double* sf1,
+        int kqlo, int kqhi, double qstep, const QuantityType& w, double rstep)
+{
+    if (w.empty())  return;
+    const int nb = w.size();
+    for (int kq = kqlo; kq < kqhi; ++kq)
+    {
+        // rotate exp(i * q * r) along the grid
+        const double qdr = kq * qstep * rstep;
+        const double c1 = cos(qdr);
+        const double s1 = sin(qdr);
+        double c = 1.0;
+        double s = 0.0;
+        double sum = 0.0;
+        for (int b = 0; b < nb; ++b)
+        {
+            sum += w[b] * s;
+            const double cnext = c * c1 - s * s1;
+            s = s * c1 + c * s1;
+            c = cnext;
+        }
+        y[kq] += sf0[kq] * sf1[kq] * sum;
+    }
+}
+
 }   // namespace
 
 // Constructor ---------------------------------------------------------------
@@ -50,7 +88,10 @@ BaseDebyeSum::BaseDebyeSum() :
     mqmin(0.0),
     mqmax(DEFAULT_QGRID_QMAX),
     mqstep(DEFAULT_QGRID_QSTEP),
-    mdebyeprecision(DEFAULT_DEBYE_PRECISION)
+    mdebyeprecision(DEFAULT_DEBYE_PRECISION),
+    mpositiongradients(false),
+    mdistancebinning(false),
+    mmixedprecision(false)
 {
     mstructure_cache.totaloccupancy = 0.0;
     // default configuration
@@ -72,23 +113,164 @@ eventticker::EventTicker& BaseDebyeSum::ticker() const
     return mticker;
 }
 
+
+string BaseDebyeSum::getParallelData() const
+{
+    ostringstream storage(ios::binary);
+    diffpy::serialization::oarchive oa(storage, ios::binary);
+    oa << this->value() << mgradients.positions << mgradients.parameters;
+    return storage.str();
+}
+
+
+MemoryUsage BaseDebyeSum::memoryUsage() const
+{
+    MemoryUsage rv = this->PairQuantity::memoryUsage();
+    size_t nbytes = byteSize(mstructure_cache.sftypeatkq) +
+        byteSize(mstructure_cache.sfaverageatkq);
+    vector<QuantityType>::const_iterator sfi;
+    sfi = mstructure_cache.sftypeatkq.begin();
+    for (; sfi != mstructure_cache.sftypeatkq.end(); ++sfi)
+    {
+        nbytes += byteSize(*sfi);
+    }
+    rv.add("sftypeatkq", nbytes);
+    nbytes = byteSize(mstructure_cache.sftypeatkqf);
+    for (const vector<float>& sff : mstructure_cache.sftypeatkqf)
+    {
+        nbytes += byteSize(sff);
+    }
+    rv.add("sftypeatkq", nbytes);
+    rv.add("floatsums", mfloatsums.memoryUsage());
+    rv.add("typeofsite", byteSize(mstructure_cache.typeofsite));
+    rv.add("stash", byteSize(mdbsumstash));
+    rv.add("stash", byteSize(mgradientstash.positions));
+    rv.add("stash", byteSize(mgradientstash.parameters));
+    rv.add("gradients", byteSize(mgradients.positions));
+    rv.add("gradients", byteSize(mgradients.parameters));
+    size_t nhbytes = byteSize(mhistograms.peaks) +
+        byteSize(mhistograms.deltas);
+    for (size_t idx = 0; idx < mhistograms.peaks.size(); ++idx)
+    {
+        nhbytes += byteSize(mhistograms.peaks[idx]) +
+            byteSize(mhistograms.deltas[idx]);
+    }
+    rv.add("histograms", nhbytes);
+    return rv;
+}
+
+
+MemoryUsage BaseDebyeSum::estimateMemoryUsage(StructureAdapterPtr stru) const
+{
+    MemoryUsage rv = this->PairQuantity::estimateMemoryUsage(stru);
+    if (!stru)  stru = emptyStructureAdapter();
+    const int cntsites = stru->countSites();
+    unordered_set<string> atomtypes;
+    for (int i = 0; i < cntsites; ++i)
+    {
+        atomtypes.insert(stru->siteAtomType(i));
+    }
+    const size_t ntypes = atomtypes.size();
+    const size_t nqbytes = pdfutils_qmaxSteps(this) * sizeof(double);
+    size_t ngrad = this->getParameterGradients().size();
+    if (this->getPositionGradients())  ngrad += R3::Ndim * cntsites;
+    rv.add("value", nqbytes);
+    rv.add("gradients", ngrad * nqbytes);
+    if (this->getEvaluatorType() != BASIC)
+    {
+        rv.add("stash", (1 + ngrad) * nqbytes);
+    }
+    // arrays per each atom type and the average scattering factors
+    rv.add("sftypeatkq", (ntypes + 1) * nqbytes +
+            ntypes * sizeof(QuantityType));
+    rv.add("typeofsite", cntsites * sizeof(int));
+    return rv;
+}
+
 // results
 
 QuantityType BaseDebyeSum::getF() const
 {
-    QuantityType rv = this->value();
-    const double& totocc = mstructure_cache.totaloccupancy;
-    const int npts = pdfutils_qmaxSteps(this);
-    for (int kq = pdfutils_qminSteps(this); kq < npts; ++kq)
+    return this->normalizedF(mvalue.data());
+}
+
+// derivatives with respect to structure parameters
+
+void BaseDebyeSum::setPositionGradients(bool flag)
+{
+    if (mpositiongradients == flag)  return;
+    mpositiongradients = flag;
+    mticker.click();
+    QuantityType().swap(mgradients.positions);
+}
+
+
+bool BaseDebyeSum::getPositionGradients() const
+{
+    return mpositiongradients;
+}
+
+
+void BaseDebyeSum::setParameterGradients(const vector<string>& names)
+{
+    if (mparametergradients == names)  return;
+    ParameterGradients::checkNames(names);
+    mparametergradients = names;
+    mticker.click();
+    QuantityType().swap(mgradients.parameters);
+}
+
+
+const vector<string>& BaseDebyeSum::getParameterGradients() const
+{
+    return mparametergradients;
+}
+
+
+vector<QuantityType> BaseDebyeSum::getFPositionJacobian() const
+{
+    const size_t npts = mvalue.size();
+    const size_t nrows = R3::Ndim * this->countSites();
+    if (!mpositiongradients || mgradients.positions.size() != nrows * npts)
     {
-        double sfavg = this->sfAverageAtkQ(kq);
-        double fscale = (sfavg * totocc) == 0 ? 0.0 :
-            1.0 / (sfavg * sfavg * totocc);
-        rv[kq] *= fscale;
+        const char* emsg = "Position gradients were not evaluated.  "
+            "Call setPositionGradients(true) and evaluate the sum.";
+        throw logic_error(emsg);
+    }
+    vector<QuantityType> rv;
+    rv.reserve(nrows);
+    const double* row = mgradients.positions.data();
+    for (size_t k = 0; k < nrows; ++k, row += npts)
+    {
+        rv.push_back(this->normalizedF(row));
     }
     return rv;
 }
 
+
+QuantityType BaseDebyeSum::getFDerivative(const string& name) const
+{
+    const vector<string>& names = mparametergradients;
+    vector<string>::const_iterator nm =
+        find(names.begin(), names.end(), name);
+    if (nm == names.end())
+    {
+        string emsg = "Parameter '" + name +
+            "' is not included in getParameterGradients().";
+        throw invalid_argument(emsg);
+    }
+    const size_t npts = mvalue.size();
+    if (mgradients.parameters.size() != names.size() * npts)
+    {
+        const char* emsg = "Parameter gradients were not evaluated.  "
+            "Call setParameterGradients() and evaluate the sum.";
+        throw logic_error(emsg);
+    }
+    const double* row =
+        mgradients.parameters.data() + (nm - names.begin()) * npts;
+    return this->normalizedF(row);
+}
+
 // Q-range methods
 
 QuantityType BaseDebyeSum::getQgrid() const
@@ -152,6 +334,34 @@ const double& BaseDebyeSum::getDebyePrecision() const
     return mdebyeprecision;
 }
 
+// summation over histograms of pair distances
+
+void BaseDebyeSum::setDistanceBinning(bool flag)
+{
+    if (mdistancebinning != flag)  mticker.click();
+    mdistancebinning = flag;
+}
+
+
+bool BaseDebyeSum::getDistanceBinning() const
+{
+    return mdistancebinning;
+}
+
+// single precision summation
+
+void BaseDebyeSum::setMixedPrecision(bool flag)
+{
+    if (mmixedprecision != flag)  mticker.click();
+    mmixedprecision = flag;
+}
+
+
+bool BaseDebyeSum::getMixedPrecision() const
+{
+    return mmixedprecision;
+}
+
 // Protected Methods ---------------------------------------------------------
 
 // PairQuantity overloads
@@ -160,6 +370,15 @@ void BaseDebyeSum::resetValue()
 {
     this->cacheStructureData();
     this->resizeValue(pdfutils_qmaxSteps(this));
+    const int nqpts = mvalue.size();
+    const int npos = !mpositiongradients ? 0 :
+        R3::Ndim * this->countSites() * nqpts;
+    mgradients.positions.assign(npos, 0.0);
+    mparametercache.resolve(mparametergradients,
+            mstructure, *(this->getPeakWidthModel()));
+    mgradients.parameters.assign(mparametercache.size() * nqpts, 0.0);
+    this->resetHistograms();
+    mfloatsums.clear();
     this->PairQuantity::resetValue();
 }
 
@@ -171,27 +390,93 @@ void BaseDebyeSum::addPairContribution(const BaseBondGenerator& bnds,
     if (eps_eq(0.0, dist))  return;
     // calculate sigma parameter for the Debye-Waller dampign Gaussian
     const double fwhm = this->getPeakWidthModel()->calculate(bnds);
-    const double fwhmtosigma = 1.0 / (2 * sqrt(2 * M_LN2));
-    const double dwsigma = fwhmtosigma * fwhm;
+    const double dwsigma = FWHM_TO_SIGMA * fwhm;
     const int nqpts = pdfutils_qmaxSteps(this);
     const int smscale = summationscale * bnds.multiplicity();
     const double& sineprec = this->getDebyePrecision();
-    for (int kq = pdfutils_qminSteps(this); kq < nqpts; ++kq)
+    if (!mhistograms.peaks.empty() && this->binPairTerm(
+                bnds.site0(), bnds.site1(), dist, fwhm, smscale))
+    {
+        return;
+    }
+    const int kqlo = pdfutils_qminSteps(this);
+    assert(nqpts <= int(mvalue.size()));
+    if (mmixedprecision)
+    {
+        const vector<float>& sf0 = this->sfSiteArrayFloat(bnds.site0());
+        const vector<float>& sf1 = this->sfSiteArrayFloat(bnds.site1());
+        assert(nqpts <= int(sf0.size()) && nqpts <= int(sf1.size()));
+        float* y = mfloatsums.accumulate(mvalue, min(kqlo, nqpts), nqpts);
+        simdkernels::addDebyeSine(y, sf0.data(), sf1.data(),
+                kqlo, nqpts, this->getQstep(), dist,
+                dwsigma, double(smscale) / dist, sineprec);
+    }
+    else
+    {
+        const QuantityType& sf0 = this->sfSiteArray(bnds.site0());
+        const QuantityType& sf1 = this->sfSiteArray(bnds.site1());
+        assert(nqpts <= int(sf0.size()) && nqpts <= int(sf1.size()));
+        simdkernels::addDebyeSine(mvalue.data(), sf0.data(), sf1.data(),
+                kqlo, nqpts, this->getQstep(), dist,
+                dwsigma, double(smscale) / dist, sineprec);
+    }
+    if (mpositiongradients || !mparametercache.empty())
+    {
+        this->addPairGradients(bnds, fwhm, smscale);
+    }
+}
+
+
+void BaseDebyeSum::executeParallelMerge(const string& pdata)
+{
+    istringstream storage(pdata, ios::binary);
+    diffpy::serialization::iarchive ia(storage, ios::binary);
+    QuantityType pvalue, ppositions, pparameters;
+    ia >> pvalue >> ppositions >> pparameters;
+    if (pvalue.size() != mvalue.size() ||
+            ppositions.size() != mgradients.positions.size() ||
+            pparameters.size() != mgradients.parameters.size())
     {
-        const double q = kq * this->getQstep();
-        const double dwscale = exp(-0.5 * pow(dwsigma * q, 2));
-        const double sinescale = smscale * dwscale *
-            this->sfSiteAtkQ(bnds.site0(), kq) *
-            this->sfSiteAtkQ(bnds.site1(), kq) / dist;
-        if (eps_eq(0.0, sinescale, sineprec))   break;
-        mvalue[kq] += sinescale * sin(q * dist);
+        throw invalid_argument("Merged data array must have the same size.");
     }
+    transform(mvalue.begin(), mvalue.end(), pvalue.begin(),
+            mvalue.begin(), plus<double>());
+    transform(mgradients.positions.begin(), mgradients.positions.end(),
+            ppositions.begin(), mgradients.positions.begin(), plus<double>());
+    transform(mgradients.parameters.begin(), mgradients.parameters.end(),
+            pparameters.begin(), mgradients.parameters.begin(),
+            plus<double>());
+}
+
+
+vector<QuantityType*> BaseDebyeSum::getParallelSumArrays()
+{
+    vector<QuantityType*> rv = {
+        &mvalue, &mgradients.positions, &mgradients.parameters};
+    return rv;
+}
+
+
+void BaseDebyeSum::finishValue()
+{
+    this->flushHistograms();
+    mfloatsums.flush(mvalue);
+}
+
+
+bool BaseDebyeSum::requiresFixedSiteIndex() const
+{
+    return mpositiongradients;
 }
 
 
 void BaseDebyeSum::stashPartialValue()
 {
+    // atom types may be indexed differently in the next structure
+    this->flushHistograms();
+    mfloatsums.flush(mvalue);
     mdbsumstash = this->value();
+    mgradientstash = mgradients;
 }
 
 
@@ -200,6 +485,13 @@ void BaseDebyeSum::restorePartialValue()
     assert(mdbsumstash.size() == mvalue.size());
     mvalue.swap(mdbsumstash);
     mdbsumstash.clear();
+    // the Q-grid and the number of sites are the same
+    assert(mgradientstash.positions.size() == mgradients.positions.size());
+    assert(mgradientstash.parameters.size() == mgradients.parameters.size());
+    mgradients.positions.swap(mgradientstash.positions);
+    mgradients.parameters.swap(mgradientstash.parameters);
+    mgradientstash.positions.clear();
+    mgradientstash.parameters.clear();
 }
 
 
@@ -208,14 +500,45 @@ double BaseDebyeSum::sfSiteAtQ(int siteidx, const double& q) const
     return 1.0;
 }
 
+
+QuantityType BaseDebyeSum::normalizedF(const double* dbsum) const
+{
+    QuantityType rv(dbsum, dbsum + mvalue.size());
+    const double& totocc = mstructure_cache.totaloccupancy;
+    const int npts = pdfutils_qmaxSteps(this);
+    for (int kq = pdfutils_qminSteps(this); kq < npts; ++kq)
+    {
+        double sfavg = this->sfAverageAtkQ(kq);
+        double fscale = (sfavg * totocc) == 0 ? 0.0 :
+            1.0 / (sfavg * sfavg * totocc);
+        rv[kq] *= fscale;
+    }
+    return rv;
+}
+
 // Private Methods -----------------------------------------------------------
 
-double BaseDebyeSum::sfSiteAtkQ(int siteidx, int kq) const
+const QuantityType& BaseDebyeSum::sfSiteArray(int siteidx) const
 {
     assert(0 <= siteidx && siteidx < int(mstructure_cache.typeofsite.size()));
     int typeidx = mstructure_cache.typeofsite[siteidx];
     assert(typeidx < int(mstructure_cache.sftypeatkq.size()));
-    const QuantityType& sfarray = mstructure_cache.sftypeatkq[typeidx];
+    return mstructure_cache.sftypeatkq[typeidx];
+}
+
+
+const vector<float>& BaseDebyeSum::sfSiteArrayFloat(int siteidx) const
+{
+    assert(0 <= siteidx && siteidx < int(mstructure_cache.typeofsite.size()));
+    int typeidx = mstructure_cache.typeofsite[siteidx];
+    assert(typeidx < int(mstructure_cache.sftypeatkqf.size()));
+    return mstructure_cache.sftypeatkqf[typeidx];
+}
+
+
+double BaseDebyeSum::sfSiteAtkQ(int siteidx, int kq) const
+{
+    const QuantityType& sfarray = this->sfSiteArray(siteidx);
     assert(0 <= kq && kq < int(sfarray.size()));
     return sfarray[kq];
 }
@@ -262,6 +585,15 @@ void BaseDebyeSum::cacheStructureData()
     }
     assert(cntsites == int(mstructure_cache.typeofsite.size()));
     assert(atomtypeidx.size() == mstructure_cache.sftypeatkq.size());
+    mstructure_cache.sftypeatkqf.clear();
+    if (mmixedprecision)
+    {
+        for (const QuantityType& sfarray : mstructure_cache.sftypeatkq)
+        {
+            mstructure_cache.sftypeatkqf.emplace_back(
+                    sfarray.begin(), sfarray.end());
+        }
+    }
     // totaloccupancy
     mstructure_cache.totaloccupancy = mstructure->totalOccupancy();
     // sfaverageatkq
@@ -290,6 +622,154 @@ void BaseDebyeSum::cacheStructureData()
             bind(multiplies<double>(), tosc, _1));
 }
 
+
+void BaseDebyeSum::addPairGradients(const BaseBondGenerator& bnds,
+        double fwhm, double pairscale)
+{
+    const int i0 = bnds.site0();
+    const int i1 = bnds.site1();
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    // periodic images of the same site do not depend on its position
+    const bool positions = mpositiongradients && (i0 != i1);
+    // derivatives of the peak width with respect to each parameter
+    const int nparams = mparametercache.size();
+    thread_local vector<double> dwparams;
+    dwparams.resize(nparams);
+    const bool parameters = nparams &&
+        mparametercache.widthDerivatives(pwm, bnds, dwparams.data());
+    if (!positions && !parameters)  return;
+    const double& dist = bnds.distance();
+    const R3::Vector u = bnds.r01() / dist;
+    // gradient of the peak width with respect to the bond vector
+    R3::Vector dwpos = R3::zerovector;
+    if (positions)
+    {
+        dwpos = pwm.derivativeMSD(bnds) * bnds.msdGradient();
+        dwpos += pwm.derivativeDistance(bnds) * u;
+    }
+    const double dwsigma = FWHM_TO_SIGMA * fwhm;
+    const int nqpts = pdfutils_qmaxSteps(this);
+    const double& qstep = this->getQstep();
+    const double& sineprec = this->getDebyePrecision();
+    const QuantityType& sf0 = this->sfSiteArray(i0);
+    const QuantityType& sf1 = this->sfSiteArray(i1);
+    double* g0 = !positions ? NULL :
+        (mgradients.positions.data() + R3::Ndim * i0 * nqpts);
+    double* g1 = !positions ? NULL :
+        (mgradients.positions.data() + R3::Ndim * i1 * nqpts);
+    double* gp = mgradients.parameters.data();
+    for (int kq = pdfutils_qminSteps(this); kq < nqpts; ++kq)
+    {
+        // the term is a * sin(Q * dist) with the same cutoff
+        // as in simdkernels::addDebyeSine
+        const double q = kq * qstep;
+        const double a = pairscale / dist * sf0[kq] * sf1[kq] *
+            exp(-0.5 * (dwsigma * q) * (dwsigma * q));
+        if (fabs(a) <= sineprec)  break;
+        const double sinqr = sin(q * dist);
+        const double ydist = a * (q * cos(q * dist) - sinqr / dist);
+        const double yfwhm = -a * sinqr * dwsigma * q * q * FWHM_TO_SIGMA;
+        for (int k = 0; positions && k < R3::Ndim; ++k)
+        {
+            double gk = ydist * u[k] + yfwhm * dwpos[k];
+            g1[k * nqpts + kq] += gk;
+            g0[k * nqpts + kq] -= gk;
+        }
+        for (int p = 0; parameters && p < nparams; ++p)
+        {
+            gp[p * nqpts + kq] += yfwhm * dwparams[p];
+        }
+    }
+}
+
+
+void BaseDebyeSum::resetHistograms()
+{
+    using diffpy::mathutils::DOUBLE_EPS;
+    const bool binning = mdistancebinning &&
+        !mpositiongradients && mparametercache.empty();
+    const int ntypes = mstructure_cache.sftypeatkq.size();
+    const int npairtypes = binning ? (ntypes * (ntypes + 1) / 2) : 0;
+    mhistograms.peaks.assign(npairtypes, QuantityType());
+    mhistograms.deltas.assign(npairtypes, QuantityType());
+    if (!npairtypes)  return;
+    const double qhi = max(1, pdfutils_qmaxSteps(this) - 1) * this->getQstep();
+    const double prec = max(DOUBLE_EPS, min(0.5, this->getDebyePrecision()));
+    // Gaussian peaks are cut at the relative amplitude prec.  Aliases of
+    // a peak sampled at peakstep are below prec for sigma >= minsigma.
+    mhistograms.nsigma = sqrt(-2 * log(prec));
+    mhistograms.peakstep = 2 * M_PI / (PEAK_POINTS_PER_PERIOD * qhi);
+    mhistograms.minsigma = mhistograms.nsigma /
+        (2 * M_PI / mhistograms.peakstep - qhi);
+    // linear interpolation of sin(Q r) has error below (Q * dr)**2 / 8
+    mhistograms.deltastep = sqrt(8 * prec) / qhi;
+}
+
+
+bool BaseDebyeSum::binPairTerm(int i0, int i1, double dist, double fwhm,
+        double pairscale)
+{
+    int tp0 = mstructure_cache.typeofsite[i0];
+    int tp1 = mstructure_cache.typeofsite[i1];
+    if (tp0 > tp1)  swap(tp0, tp1);
+    const int idx = tp1 * (tp1 + 1) / 2 + tp0;
+    assert(idx < int(mhistograms.peaks.size()));
+    if (fwhm == 0.0)
+    {
+        QuantityType& hdelta = mhistograms.deltas[idx];
+        const double x = dist / mhistograms.deltastep;
+        const int i = int(x);
+        const double t = x - i;
+        if (int(hdelta.size()) < i + 2)  hdelta.resize(i + 2, 0.0);
+        const double w = pairscale / dist;
+        hdelta[i] += w * (1 - t);
+        hdelta[i + 1] += w * t;
+        return true;
+    }
+    // sharp peaks would be aliased and peaks must not extend below r = 0
+    const double dwsigma = FWHM_TO_SIGMA * fwhm;
+    const double xbound = mhistograms.nsigma * dwsigma;
+    if (dwsigma < mhistograms.minsigma || dist < xbound)  return false;
+    QuantityType& hpeaks = mhistograms.peaks[idx];
+    const double& dr = mhistograms.peakstep;
+    const int ilo = int(ceil((dist - xbound) / dr));
+    const int ihi = int(floor((dist + xbound) / dr)) + 1;
+    if (int(hpeaks.size()) < ihi)  hpeaks.resize(ihi, 0.0);
+    // the profile is scaled by r / dist and is divided by r later
+    simdkernels::addGaussianRDF(hpeaks.data(), ilo, ihi, 0, dr,
+            dist, fwhm, pairscale);
+    return true;
+}
+
+
+void BaseDebyeSum::flushHistograms()
+{
+    if (mhistograms.peaks.empty())  return;
+    const int ntypes = mstructure_cache.sftypeatkq.size();
+    const int kqlo = pdfutils_qminSteps(this);
+    const int nqpts = pdfutils_qmaxSteps(this);
+    const double& qstep = this->getQstep();
+    assert(nqpts <= int(mvalue.size()));
+    int idx = 0;
+    for (int tp1 = 0; tp1 < ntypes; ++tp1)
+    {
+        for (int tp0 = 0; tp0 <= tp1; ++tp0, ++idx)
+        {
+            const double* sf0 = mstructure_cache.sftypeatkq[tp0].data();
+            const double* sf1 = mstructure_cache.sftypeatkq[tp1].data();
+            // peak density times peakstep / r is the weight of sin(Q r)
+            QuantityType& hpeaks = mhistograms.peaks[idx];
+            for (size_t b = 1; b < hpeaks.size(); ++b)  hpeaks[b] /= b;
+            _addSineTransform(mvalue.data(), sf0, sf1, kqlo, nqpts, qstep,
+                    hpeaks, mhistograms.peakstep);
+            _addSineTransform(mvalue.data(), sf0, sf1, kqlo, nqpts, qstep,
+                    mhistograms.deltas[idx], mhistograms.deltastep);
+            hpeaks.clear();
+            mhistograms.deltas[idx].clear();
+        }
+    }
+}
+
 }   // namespace srreal
 }   // namespace diffpy
 
@@ -19,9 +19,14 @@
 #ifndef BASEDEBYESUM_HPP_INCLUDED
 #define BASEDEBYESUM_HPP_INCLUDED
 
+#include <string>
+#include <vector>
+
 #include <diffpy/srreal/PairQuantity.hpp>
 #include <diffpy/srreal/PeakWidthModel.hpp>
+#include <diffpy/srreal/ParameterGradients.hpp>
 #include <diffpy/srreal/PDFUtils.hpp>
+#include <diffpy/srreal/SinglePrecisionSums.hpp>
 
 namespace diffpy {
 namespace srreal {
@@ -37,11 +42,29 @@ class BaseDebyeSum :
 
         // PairQuantity overloads
         virtual eventticker::EventTicker& ticker() const;
+        virtual std::string getParallelData() const;
+        virtual MemoryUsage memoryUsage() const;
+        virtual MemoryUsage estimateMemoryUsage(StructureAdapterPtr) const;
 
         // results
         /// F values on a full Q-grid starting at 0
         QuantityType getF() const;
 
+        // derivatives with respect to structure parameters
+        /// accumulate derivatives of F with respect to Cartesian
+        /// coordinates of every site.  Disabled by default.
+        void setPositionGradients(bool);
+        bool getPositionGradients() const;
+        /// accumulate derivatives of F with respect to the named peak width
+        /// or displacement parameters as described in ParameterGradients
+        void setParameterGradients(const std::vector<std::string>& names);
+        const std::vector<std::string>& getParameterGradients() const;
+        /// derivatives of getF() with respect to Cartesian coordinates,
+        /// where row 3 * i + k is for the k-th coordinate of site i
+        std::vector<QuantityType> getFPositionJacobian() const;
+        /// derivative of getF() with respect to the named parameter
+        QuantityType getFDerivative(const std::string& name) const;
+
         // Q-range methods
         /// Full Q-grid starting at 0
         QuantityType getQgrid() const;
@@ -59,25 +82,61 @@ class BaseDebyeSum :
         /// return relative cutoff value for Debye sum contribution
         const double& getDebyePrecision() const;
 
+        // Summation over histograms of pair distances
+        /// accumulate pair terms as Gaussian peaks on a grid of distances
+        /// and evaluate F from their sine transform.  The error of each
+        /// pair term stays below its amplitude times debyeprecision.
+        /// Disabled by default and ignored when gradients are enabled.
+        void setDistanceBinning(bool);
+        bool getDistanceBinning() const;
+
+        // Single precision summation
+        /// evaluate exactly summed pair terms in single precision and add
+        /// them to float partial sums that are added to the double value
+        /// in short blocks.  Relative error is about 1e-6.  Derivatives
+        /// stay in double precision.  Disabled by default.
+        void setMixedPrecision(bool);
+        bool getMixedPrecision() const;
+
     protected:
 
         // PairQuantity overloads
         virtual void resetValue();
         virtual void addPairContribution(const BaseBondGenerator&, int);
+        virtual void executeParallelMerge(const std::string& pdata);
+        virtual std::vector<QuantityType*> getParallelSumArrays();
+        virtual void finishValue();
         // support for PQEvaluatorOptimized
+        virtual bool requiresFixedSiteIndex() const;
         virtual void stashPartialValue();
         virtual void restorePartialValue();
 
         // own methods
         virtual double sfSiteAtQ(int, const double& Q) const;
+        /// F values from an array of Debye sums on the value Q-grid
+        QuantityType normalizedF(const double* dbsum) const;
 
     private:
 
         // methods
         /// cache structure factors data for a quick access during summation
+        const QuantityType& sfSiteArray(int siteidx) const;
+        const std::vector<float>& sfSiteArrayFloat(int siteidx) const;
         double sfSiteAtkQ(int siteidx, int kq) const;
         double sfAverageAtkQ(int kq) const;
         void cacheStructureData();
+        /// add derivatives of a pair term to the enabled gradients
+        void addPairGradients(const BaseBondGenerator&,
+                double fwhm, double pairscale);
+        /// prepare empty distance histograms when binning is in use
+        void resetHistograms();
+        /// add pair term to the histogram of its atom types, return false
+        /// when it has to be summed exactly
+        bool binPairTerm(int i0, int i1, double dist, double fwhm,
+                double pairscale);
+        /// add sine transform of the distance histograms to the value
+        /// and clear them
+        void flushHistograms();
 
         // data
         // configuration
@@ -85,13 +144,44 @@ class BaseDebyeSum :
         double mqmax;
         double mqstep;
         double mdebyeprecision;
+        bool mpositiongradients;
+        std::vector<std::string> mparametergradients;
+        bool mdistancebinning;
+        bool mmixedprecision;
         struct {
             std::vector<int> typeofsite;
             std::vector<QuantityType> sftypeatkq;
+            // single precision copy of sftypeatkq for mmixedprecision
+            std::vector< std::vector<float> > sftypeatkqf;
             QuantityType sfaverageatkq;
             double totaloccupancy;
         } mstructure_cache;
         QuantityType mdbsumstash;
+        // pending pair terms for each pair of atom types tp0 <= tp1 at
+        // index tp1 * (tp1 + 1) / 2 + tp0.  Pairs with Debye-Waller
+        // damping are Gaussian peaks on a grid of peakstep, undamped
+        // pairs are split between points of the finer deltastep grid.
+        struct {
+            double peakstep;
+            double deltastep;
+            double minsigma;
+            double nsigma;
+            std::vector<QuantityType> peaks;
+            std::vector<QuantityType> deltas;
+        } mhistograms;
+        // derivatives of the Debye sums, where positions has a row of
+        // the value size for each Cartesian coordinate and parameters
+        // a row for each entry in mparametergradients
+        struct GradientArrays {
+            QuantityType positions;
+            QuantityType parameters;
+        };
+        GradientArrays mgradients;
+        GradientArrays mgradientstash;
+        // pending single precision pair terms
+        SinglePrecisionSums mfloatsums;
+        // gradient parameters resolved for the current structure
+        ParameterGradients mparametercache;
 
         // serialization
         friend class boost::serialization::access;
@@ -109,6 +199,16 @@ class BaseDebyeSum :
             ar & mstructure_cache.sftypeatkq;
             ar & mstructure_cache.sfaverageatkq;
             ar & mstructure_cache.totaloccupancy;
+            if (version >= 1) {
+                ar & mpositiongradients;
+                ar & mparametergradients;
+            }
+            if (version >= 2) {
+                ar & mdistancebinning;
+            }
+            if (version >= 3) {
+                ar & mmixedprecision;
+            }
         }
 
 };  // class BaseDebyeSum
@@ -118,6 +218,7 @@ class BaseDebyeSum :
 
 // Serialization -------------------------------------------------------------
 
+BOOST_CLASS_VERSION(diffpy::srreal::BaseDebyeSum, 3)
 BOOST_CLASS_EXPORT_KEY(diffpy::srreal::BaseDebyeSum)
 
 #endif  // BASEDEBYESUM_HPP_INCLUDED
@@ -194,6 +194,33 @@ string BondCalculator::getParallelData() const
     return storage.str();
 }
 
+
+MemoryUsage BondCalculator::memoryUsage() const
+{
+    MemoryUsage rv = this->PairQuantity::memoryUsage();
+    size_t nbytes = byteSize(mbonds) + byteSize(mpopbonds) +
+        byteSize(maddbonds);
+    rv.add("bonds", nbytes);
+    rv.add("stash", byteSize(mstashedvalue.bonds) +
+            byteSize(mstashedvalue.popbonds));
+    return rv;
+}
+
+
+MemoryUsage BondCalculator::estimateMemoryUsage(StructureAdapterPtr stru) const
+{
+    MemoryUsage rv = this->PairQuantity::estimateMemoryUsage(stru);
+    if (!stru)  stru = emptyStructureAdapter();
+    // bonds are collected from every site to all its neighbors
+    const double nbonds = stru->countSites() *
+        estimateNeighborCount(stru, this->getRmin(), this->getRmax());
+    rv.add("value", size_t(nbonds * sizeof(double)));
+    const size_t nbytes = size_t(nbonds * sizeof(BondEntry));
+    rv.add("bonds", nbytes);
+    if (this->getEvaluatorType() != BASIC)  rv.add("stash", nbytes);
+    return rv;
+}
+
 // Protected Methods ---------------------------------------------------------
 
 void BondCalculator::resetValue()
@@ -211,9 +238,8 @@ void BondCalculator::addPairContribution(
         int summationscale)
 {
     assert(summationscale == +1 || summationscale == -1);
-    static R3::Vector ru01;
     const R3::Vector& r01 = bnds.r01();
-    ru01 = r01 / bnds.distance();
+    const R3::Vector ru01 = r01 / bnds.distance();
     if (!(this->checkConeFilters(ru01)))  return;
     BondDataStorage& bes = (summationscale > 0) ? maddbonds : mpopbonds;
     bes.push_back(BondOp::entryFrom(bnds));
@@ -231,6 +257,13 @@ void BondCalculator::executeParallelMerge(const std::string& pdata)
 }
 
 
+vector<QuantityType*> BondCalculator::getParallelSumArrays()
+{
+    // bond lists are merged together from the parallel data
+    return vector<QuantityType*>();
+}
+
+
 void BondCalculator::finishValue()
 {
     // filter-out entries marked for removal
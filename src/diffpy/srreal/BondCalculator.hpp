@@ -44,6 +44,8 @@ class BondCalculator : public PairQuantity
 
         // PairQuantity overloads
         virtual std::string getParallelData() const;
+        virtual MemoryUsage memoryUsage() const;
+        virtual MemoryUsage estimateMemoryUsage(StructureAdapterPtr) const;
 
     protected:
 
@@ -51,6 +53,7 @@ class BondCalculator : public PairQuantity
         virtual void resetValue();
         virtual void addPairContribution(const BaseBondGenerator&, int);
         virtual void executeParallelMerge(const std::string& pdata);
+        virtual std::vector<QuantityType*> getParallelSumArrays();
         virtual void finishValue();
 
         // support for PQEvaluatorOptimized
@@ -0,0 +1,317 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class BraggStructureFactorCalculator -- total scattering structure
+*     function of a periodic crystal from a sum over Bragg reflections
+*
+*****************************************************************************/
+
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+
+#include <diffpy/serialization.ipp>
+#include <diffpy/srreal/BraggStructureFactorCalculator.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/PointsInSphere.hpp>
+#include <diffpy/srreal/PDFUtils.hpp>
+#include <diffpy/mathutils.hpp>
+#include <diffpy/validators.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+using namespace diffpy::validators;
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// Atom in the unit cell with an index of its atom type.
+struct CellAtom
+{
+    R3::Vector xyz;
+    R3::Matrix uij;
+    double occupancy;
+    int typeidx;
+};
+
+
+/// Return true for the first reflection from a Friedel pair.
+bool _isFriedelLeader(const int* hkl)
+{
+    if (hkl[0] != 0)  return hkl[0] > 0;
+    if (hkl[1] != 0)  return hkl[1] > 0;
+    return hkl[2] > 0;
+}
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+BraggStructureFactorCalculator::BraggStructureFactorCalculator() :
+    mqmin(0.0),
+    mqmax(DEFAULT_QGRID_QMAX),
+    mqstep(DEFAULT_QGRID_QSTEP),
+    // peaks span a few points of the default Q-grid
+    mqdamp(DEFAULT_QGRID_QSTEP),
+    mreflectioncount(0)
+{
+    this->setScatteringFactorTableByType("xray");
+    // attributes
+    this->registerDoubleAttribute("qmin", this,
+            &BraggStructureFactorCalculator::getQmin,
+            &BraggStructureFactorCalculator::setQmin);
+    this->registerDoubleAttribute("qmax", this,
+            &BraggStructureFactorCalculator::getQmax,
+            &BraggStructureFactorCalculator::setQmax);
+    this->registerDoubleAttribute("qstep", this,
+            &BraggStructureFactorCalculator::getQstep,
+            &BraggStructureFactorCalculator::setQstep);
+    this->registerDoubleAttribute("qdamp", this,
+            &BraggStructureFactorCalculator::getQdamp,
+            &BraggStructureFactorCalculator::setQdamp);
+}
+
+// Public Methods ------------------------------------------------------------
+
+const QuantityType&
+BraggStructureFactorCalculator::eval(StructureAdapterPtr stru)
+{
+    const PeriodicStructureAdapter* pstru =
+        dynamic_cast<const PeriodicStructureAdapter*>(stru.get());
+    if (!pstru)
+    {
+        const char* emsg = "Bragg sum requires periodic structure.";
+        throw invalid_argument(emsg);
+    }
+    const CrystalStructureAdapter* cstru =
+        dynamic_cast<const CrystalStructureAdapter*>(pstru);
+    // all atoms in the unit cell
+    vector<CellAtom> atoms;
+    vector<string> atomtypes;
+    unordered_map<string, int> atomtypeidx;
+    for (int i = 0; i < pstru->countSites(); ++i)
+    {
+        const Atom& a0 = (*pstru)[i];
+        if (!atomtypeidx.count(a0.atomtype))
+        {
+            atomtypeidx.insert(make_pair(a0.atomtype, int(atomtypes.size())));
+            atomtypes.push_back(a0.atomtype);
+        }
+        const int tpidx = atomtypeidx[a0.atomtype];
+        const AtomicStructureAdapter::AtomVector eqatoms = cstru ?
+            cstru->getEquivalentAtoms(i) :
+            AtomicStructureAdapter::AtomVector(1, a0);
+        AtomicStructureAdapter::AtomVector::const_iterator ai;
+        for (ai = eqatoms.begin(); ai != eqatoms.end(); ++ai)
+        {
+            CellAtom ca = {ai->xyz_cartn, ai->uij_cartn,
+                ai->occupancy, tpidx};
+            atoms.push_back(ca);
+        }
+    }
+    const Lattice& L = pstru->getLattice();
+    const double totocc = pstru->totalOccupancy();
+    const ScatteringFactorTable& sftable = *(this->getScatteringFactorTable());
+    const int ntypes = atomtypes.size();
+    const int nqpts = pdfutils_qmaxSteps(this);
+    const int kqlo = pdfutils_qminSteps(this);
+    const double& dq = this->getQstep();
+    mvalue.assign(nqpts, 0.0);
+    mreflectioncount = 0;
+    if (atoms.empty() || totocc == 0.0 || kqlo >= nqpts)  return mvalue;
+    // Bragg peaks are Gaussians in Q that are cut at DEFAULT_PEAKPRECISION
+    const double sigma = this->getQdamp();
+    const double qbound = sigma * sqrt(-2 * log(DEFAULT_PEAKPRECISION));
+    const double qlo = max(0.0, kqlo * dq - qbound);
+    const double qhi = (nqpts - 1) * dq + qbound;
+    // powder average of the Bragg term for the distinct atom pairs,
+    // normalized later per atom by the average scattering factor
+    const double braggscale = 2 * M_PI * M_PI / (L.volume() * totocc);
+    vector<double> sf(ntypes);
+    ReflectionsInQminQmax refl(qlo, qhi, L);
+    for (refl.rewind(); !refl.finished(); refl.next())
+    {
+        // Friedel pairs have the same intensity, add them together
+        if (!_isFriedelLeader(refl.hkl()))  continue;
+        mreflectioncount += 2;
+        R3::Vector G;
+        for (int k = 0; k < R3::Ndim; ++k)
+        {
+            G[k] = 2 * M_PI * (L.recbase()(k, 0) * refl.h() +
+                    L.recbase()(k, 1) * refl.k() +
+                    L.recbase()(k, 2) * refl.l());
+        }
+        const double q = R3::norm(G);
+        for (int tp = 0; tp < ntypes; ++tp)
+        {
+            sf[tp] = sftable.lookup(atomtypes[tp], q);
+        }
+        double re = 0.0;
+        double im = 0.0;
+        vector<CellAtom>::const_iterator ca = atoms.begin();
+        for (; ca != atoms.end(); ++ca)
+        {
+            const double dw = exp(-0.5 * R3::dot(G,
+                        R3::mxvecproduct(ca->uij, G)));
+            const double amplitude = ca->occupancy * sf[ca->typeidx] * dw;
+            const double phase = R3::dot(G, ca->xyz);
+            re += amplitude * cos(phase);
+            im += amplitude * sin(phase);
+        }
+        // the 1/q factor makes the Gaussian broadening equivalent to
+        // the Q-resolution envelope of the PDF
+        const double peakscale = 2 * braggscale * (re * re + im * im) / q;
+        const int ilo = max(kqlo, int(ceil((q - qbound) / dq)));
+        const int ihi = min(nqpts, int(floor((q + qbound) / dq)) + 1);
+        const double gnorm = 1.0 / (sqrt(2 * M_PI) * sigma);
+        for (int kq = ilo; kq < ihi; ++kq)
+        {
+            const double x = (kq * dq - q) / sigma;
+            mvalue[kq] += peakscale * gnorm * exp(-0.5 * x * x);
+        }
+    }
+    // remove the self-pair terms and normalize per atom
+    for (int kq = kqlo; kq < nqpts; ++kq)
+    {
+        const double q = kq * dq;
+        for (int tp = 0; tp < ntypes; ++tp)
+        {
+            sf[tp] = sftable.lookup(atomtypes[tp], q);
+        }
+        double sfsum = 0.0;
+        double selfsum = 0.0;
+        vector<CellAtom>::const_iterator ca = atoms.begin();
+        for (; ca != atoms.end(); ++ca)
+        {
+            const double f = ca->occupancy * sf[ca->typeidx];
+            // powder average of the Debye-Waller factor is approximated
+            // with the equivalent isotropic displacement
+            const double ueq =
+                (ca->uij(0, 0) + ca->uij(1, 1) + ca->uij(2, 2)) / 3;
+            sfsum += f;
+            selfsum += f * f * exp(-q * q * ueq);
+        }
+        const double sfavg = sfsum / totocc;
+        mvalue[kq] -= q * selfsum / totocc;
+        mvalue[kq] = (sfavg == 0.0) ? 0.0 : (mvalue[kq] / (sfavg * sfavg));
+    }
+    return mvalue;
+}
+
+
+const QuantityType& BraggStructureFactorCalculator::value() const
+{
+    return mvalue;
+}
+
+
+int BraggStructureFactorCalculator::countReflections() const
+{
+    return mreflectioncount;
+}
+
+// results
+
+QuantityType BraggStructureFactorCalculator::getF() const
+{
+    return mvalue;
+}
+
+
+QuantityType BraggStructureFactorCalculator::getS() const
+{
+    QuantityType rv(mvalue.size(), 0.0);
+    const double& dq = this->getQstep();
+    const int kqlo = max(1, pdfutils_qminSteps(this));
+    for (int kq = kqlo; kq < int(rv.size()); ++kq)
+    {
+        rv[kq] = 1.0 + mvalue[kq] / (kq * dq);
+    }
+    return rv;
+}
+
+// Q-range methods
+
+QuantityType BraggStructureFactorCalculator::getQgrid() const
+{
+    return pdfutils_getQgrid(this);
+}
+
+// Q-range configuration
+
+void BraggStructureFactorCalculator::setQmin(double qmin)
+{
+    ensureNonNegative("Qmin", qmin);
+    mqmin = qmin;
+}
+
+
+const double& BraggStructureFactorCalculator::getQmin() const
+{
+    return mqmin;
+}
+
+
+void BraggStructureFactorCalculator::setQmax(double qmax)
+{
+    ensureNonNegative("Qmax", qmax);
+    mqmax = qmax;
+}
+
+
+const double& BraggStructureFactorCalculator::getQmax() const
+{
+    return mqmax;
+}
+
+
+void BraggStructureFactorCalculator::setQstep(double qstep)
+{
+    ensureEpsilonPositive("Qstep", qstep);
+    mqstep = qstep;
+}
+
+
+const double& BraggStructureFactorCalculator::getQstep() const
+{
+    return mqstep;
+}
+
+// peak broadening
+
+void BraggStructureFactorCalculator::setQdamp(double qdamp)
+{
+    ensureEpsilonPositive("qdamp", qdamp);
+    mqdamp = qdamp;
+}
+
+
+const double& BraggStructureFactorCalculator::getQdamp() const
+{
+    return mqdamp;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+DIFFPY_INSTANTIATE_SERIALIZATION(diffpy::srreal::BraggStructureFactorCalculator)
+
+// End of file
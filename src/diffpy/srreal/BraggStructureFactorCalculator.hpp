@@ -0,0 +1,109 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class BraggStructureFactorCalculator -- total scattering structure
+*     function of a periodic crystal from a sum over Bragg reflections
+*
+* The powder averaged intensities of reflections are broadened by a Gaussian
+* of standard deviation qdamp.  The reduced structure function
+* F(Q) = Q (S(Q) - 1) includes only the distinct atom pairs and uses the
+* same normalization as the Debye sum in DebyePDFCalculator, therefore its
+* sine Fourier transform matches the PDFCalculator result for the same
+* qdamp.  The work scales with the number of reflections and the atoms
+* in the unit cell instead of the number of atom pairs.
+*
+*****************************************************************************/
+
+#ifndef BRAGGSTRUCTUREFACTORCALCULATOR_HPP_INCLUDED
+#define BRAGGSTRUCTUREFACTORCALCULATOR_HPP_INCLUDED
+
+#include <diffpy/Attributes.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
+#include <diffpy/srreal/ScatteringFactorTable.hpp>
+#include <diffpy/srreal/forwardtypes.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class BraggStructureFactorCalculator :
+    public diffpy::Attributes,
+    public ScatteringFactorTableOwner
+{
+    public:
+
+        // constructor
+        BraggStructureFactorCalculator();
+
+        // methods
+        /// sum the reflections of a periodic structure.
+        /// Throw invalid_argument for non-periodic structures.
+        const QuantityType& eval(StructureAdapterPtr);
+        /// F values from the last evaluation on a Q-grid starting at 0
+        const QuantityType& value() const;
+        /// number of reflections in the last evaluation
+        int countReflections() const;
+
+        // results
+        /// reduced structure function F(Q) = Q (S(Q) - 1)
+        QuantityType getF() const;
+        /// total scattering structure function S(Q), zero below Qmin
+        QuantityType getS() const;
+
+        // Q-range methods
+        /// Full Q-grid starting at 0
+        QuantityType getQgrid() const;
+        // Q-range configuration
+        void setQmin(double);
+        const double& getQmin() const;
+        void setQmax(double);
+        const double& getQmax() const;
+        void setQstep(double);
+        const double& getQstep() const;
+
+        // peak broadening
+        /// standard deviation of the Gaussian Bragg peaks in Q
+        void setQdamp(double);
+        const double& getQdamp() const;
+
+    private:
+
+        // data
+        double mqmin;
+        double mqmax;
+        double mqstep;
+        double mqdamp;
+        QuantityType mvalue;
+        int mreflectioncount;
+
+        // serialization
+        friend class boost::serialization::access;
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            using boost::serialization::base_object;
+            ar & base_object<ScatteringFactorTableOwner>(*this);
+            ar & mqmin;
+            ar & mqmax;
+            ar & mqstep;
+            ar & mqdamp;
+            ar & mvalue;
+            ar & mreflectioncount;
+        }
+
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // BRAGGSTRUCTUREFACTORCALCULATOR_HPP_INCLUDED
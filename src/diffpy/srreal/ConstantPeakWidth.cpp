@@ -107,6 +107,33 @@ double ConstantPeakWidth::maxWidth(
     return this->getWidth();
 }
 
+
+double ConstantPeakWidth::derivativeDistance(
+        const BaseBondGenerator& bnds) const
+{
+    return 0.0;
+}
+
+
+double ConstantPeakWidth::derivativeMSD(const BaseBondGenerator& bnds) const
+{
+    return 0.0;
+}
+
+
+double ConstantPeakWidth::derivativeAttr(
+        const string& name, const BaseBondGenerator& bnds) const
+{
+    if (name == "width")  return 1.0;
+    // fwhm = C * sqrt(2 * uiso) so that dfwhm / duiso = C**2 / fwhm
+    const double w = fabs(this->getWidth());
+    const double dwdu = (w == 0.0) ? 0.0 :
+        GAUSS_SIGMA_TO_FWHM * GAUSS_SIGMA_TO_FWHM / w;
+    if (name == "uisowidth")  return dwdu;
+    if (name == "bisowidth")  return dwdu / UtoB;
+    return this->PeakWidthModel::derivativeAttr(name, bnds);
+}
+
 // data access
 
 const double& ConstantPeakWidth::getWidth() const
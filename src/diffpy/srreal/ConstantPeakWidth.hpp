@@ -39,6 +39,10 @@ class ConstantPeakWidth : public PeakWidthModel
         virtual double calculate(const BaseBondGenerator&) const;
         virtual double maxWidth(StructureAdapterPtr,
                 double rmin, double rmax) const;
+        virtual double derivativeDistance(const BaseBondGenerator&) const;
+        virtual double derivativeMSD(const BaseBondGenerator&) const;
+        virtual double derivativeAttr(const std::string& name,
+                const BaseBondGenerator&) const;
 
         // data access
         const double& getWidth() const;
@@ -71,6 +71,23 @@ double CroppedGaussianProfile::operator()(double x, double fwhm) const
 }
 
 
+double CroppedGaussianProfile::derivativeX(double x, double fwhm) const
+{
+    // ignore the moving crop boundary where the profile is nearly zero
+    double rv = (fabs(x) >= mhalfboundrel * fwhm) ? 0.0 :
+        mscale * this->GaussianProfile::derivativeX(x, fwhm);
+    return rv;
+}
+
+
+double CroppedGaussianProfile::derivativeFWHM(double x, double fwhm) const
+{
+    double rv = (fabs(x) >= mhalfboundrel * fwhm) ? 0.0 :
+        mscale * this->GaussianProfile::derivativeFWHM(x, fwhm);
+    return rv;
+}
+
+
 void CroppedGaussianProfile::setPrecision(double eps)
 {
     this->GaussianProfile::setPrecision(eps);
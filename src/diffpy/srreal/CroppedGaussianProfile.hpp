@@ -38,6 +38,8 @@ class CroppedGaussianProfile : public GaussianProfile
         // methods
         const std::string& type() const;
         double operator()(double x, double fwhm) const;
+        double derivativeX(double x, double fwhm) const;
+        double derivativeFWHM(double x, double fwhm) const;
         void setPrecision(double eps);
 
     private:
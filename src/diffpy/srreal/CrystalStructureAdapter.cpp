@@ -94,6 +94,23 @@ CrystalStructureAdapter::diff(StructureAdapterConstPtr other) const
 }
 
 
+MemoryUsage CrystalStructureAdapter::memoryUsage() const
+{
+    MemoryUsage rv = this->PeriodicStructureAdapter::memoryUsage();
+    rv.add("symops", byteSize(msymops));
+    size_t nbytes = byteSize(msymatoms);
+    vector<AtomVector>::const_iterator sai = msymatoms.begin();
+    for (; sai != msymatoms.end(); ++sai)
+    {
+        nbytes += byteSize(*sai);
+        AtomVector::const_iterator ai = sai->begin();
+        for (; ai != sai->end(); ++ai)  nbytes += byteSize(ai->atomtype);
+    }
+    rv.add("symatoms", nbytes);
+    return rv;
+}
+
+
 void CrystalStructureAdapter::setSymmetryPrecision(double eps)
 {
     using namespace diffpy::validators;
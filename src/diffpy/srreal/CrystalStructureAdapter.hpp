@@ -78,6 +78,7 @@ class CrystalStructureAdapter : public PeriodicStructureAdapter
         virtual BaseBondGeneratorPtr createBondGenerator() const;
         virtual int siteMultiplicity(int idx) const;
         virtual StructureDifference diff(StructureAdapterConstPtr other) const;
+        virtual MemoryUsage memoryUsage() const;
 
         // methods - own
         void setSymmetryPrecision(double eps);
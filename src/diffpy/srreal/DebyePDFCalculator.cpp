@@ -17,6 +17,8 @@
 *****************************************************************************/
 
 #include <cassert>
+#include <cmath>
+#include <algorithm>
 #include <valarray>
 #include <stdexcept>
 
@@ -93,6 +95,24 @@ eventticker::EventTicker& DebyePDFCalculator::ticker() const
     return tic;
 }
 
+
+MemoryUsage
+DebyePDFCalculator::estimateMemoryUsage(StructureAdapterPtr stru) const
+{
+    MemoryUsage rv = this->BaseDebyeSum::estimateMemoryUsage(stru);
+    // zero-padded F(Q) and the FFT work arrays from getPDFAtQmin
+    const int nq = pdfutils_qmaxSteps(this);
+    const double qstep = this->getQstep();
+    const int nfromdr = (qstep > 0) ?
+        int(ceil(M_PI / this->getRstep() / qstep)) : 0;
+    const int nfpad = max(nq, nfromdr);
+    const size_t npad = (nfpad > 0) ?
+        (size_t(1) << int(ceil(log2(nfpad)))) : 0;
+    const int nr = max(0, pdfutils_rmaxSteps(this) - pdfutils_rminSteps(this));
+    rv.add("transient", (nfpad + 5 * npad + 3 * nr) * sizeof(double));
+    return rv;
+}
+
 // results
 
 QuantityType DebyePDFCalculator::getPDF() const
@@ -120,6 +140,65 @@ QuantityType DebyePDFCalculator::getRDFperR() const
     return this->getPDFAtQmin(0.0);
 }
 
+
+vector<QuantityType> DebyePDFCalculator::getPDFPositionJacobian() const
+{
+    vector<QuantityType> rv = this->getFPositionJacobian();
+    QuantityType rgrid = this->getRgrid();
+    vector<QuantityType>::iterator row = rv.begin();
+    for (; row != rv.end(); ++row)
+    {
+        QuantityType pdf0 = this->pdfFromF(*row, this->getQmin());
+        *row = this->applyEnvelopes(rgrid, pdf0);
+    }
+    return rv;
+}
+
+
+QuantityType DebyePDFCalculator::getPDFDerivative(const string& name) const
+{
+    QuantityType rgrid = this->getRgrid();
+    QuantityType pdf0 =
+        this->pdfFromF(this->getFDerivative(name), this->getQmin());
+    QuantityType pdf1 = this->applyEnvelopes(rgrid, pdf0);
+    return pdf1;
+}
+
+// comparison with observed data
+
+void DebyePDFCalculator::setObservedPDF(
+        const QuantityType& gobs, const QuantityType& weights)
+{
+    mresidual.setObserved(gobs, weights);
+}
+
+
+const QuantityType& DebyePDFCalculator::getObservedPDF() const
+{
+    return mresidual.getObserved();
+}
+
+
+QuantityType DebyePDFCalculator::getResidual() const
+{
+    this->updateResidual();
+    return mresidual.residual();
+}
+
+
+double DebyePDFCalculator::getChiSquared() const
+{
+    this->updateResidual();
+    return mresidual.chiSquared();
+}
+
+
+double DebyePDFCalculator::getRw() const
+{
+    this->updateResidual();
+    return mresidual.rw();
+}
+
 // Q-range configuration
 
 void DebyePDFCalculator::setQmin(double qmin)
@@ -290,9 +369,14 @@ double DebyePDFCalculator::sfSiteAtQ(int siteidx, const double& Q) const
 // Private Methods -----------------------------------------------------------
 
 QuantityType DebyePDFCalculator::getPDFAtQmin(double qmin) const
+{
+    return this->pdfFromF(this->getF(), qmin);
+}
+
+
+QuantityType DebyePDFCalculator::pdfFromF(QuantityType fpad, double qmin) const
 {
     // build a zero padded F vector that gives dr <= rstep
-    QuantityType fpad = this->getF();
     // zero all F values below qmin
     int nqmin = pdfutils_qminSteps(qmin, this->getQstep());
     if (nqmin > int(fpad.size()))  nqmin = fpad.size();
@@ -392,6 +476,17 @@ void DebyePDFCalculator::cacheRlimitsData() const
     mrlimits_are_cached = true;
 }
 
+
+void DebyePDFCalculator::updateResidual() const
+{
+    if (mresidual.empty())
+    {
+        const char* emsg = "Observed PDF is not set.  Call setObservedPDF().";
+        throw logic_error(emsg);
+    }
+    mresidual.update(this->getPDF());
+}
+
 }   // namespace srreal
 }   // namespace diffpy
 
@@ -51,6 +51,7 @@
 #include <diffpy/srreal/BaseDebyeSum.hpp>
 #include <diffpy/srreal/ScatteringFactorTable.hpp>
 #include <diffpy/srreal/PDFEnvelope.hpp>
+#include <diffpy/srreal/FitResidual.hpp>
 
 namespace diffpy {
 namespace srreal {
@@ -67,12 +68,32 @@ class DebyePDFCalculator :
 
         // PairQuantity overloads
         virtual eventticker::EventTicker& ticker() const;
+        virtual MemoryUsage estimateMemoryUsage(StructureAdapterPtr) const;
 
         // results
         /// PDF on the specified r-grid
         QuantityType getPDF() const;
         QuantityType getRDF() const;
         QuantityType getRDFperR() const;
+        /// derivatives of getPDF() with respect to Cartesian coordinates,
+        /// where row 3 * i + k is for the k-th coordinate of site i
+        std::vector<QuantityType> getPDFPositionJacobian() const;
+        /// derivative of getPDF() with respect to the named parameter
+        QuantityType getPDFDerivative(const std::string& name) const;
+
+        // comparison with observed data
+        /// set observed PDF on the getRgrid() points and its weights,
+        /// unit weights when empty.  Empty gobs disables the comparison.
+        void setObservedPDF(const QuantityType& gobs,
+                const QuantityType& weights=QuantityType());
+        const QuantityType& getObservedPDF() const;
+        /// weighted residual sqrt(w) * (Gcalc - Gobs)
+        QuantityType getResidual() const;
+        /// sum of w * (Gcalc - Gobs)**2.  The Q-space sums change at all
+        /// r-points, therefore this compares the complete PDF.
+        double getChiSquared() const;
+        /// agreement factor sqrt(chi2 / sum(w * Gobs**2))
+        double getRw() const;
 
         // Q-range configuration
         void setQmin(double);
@@ -111,6 +132,8 @@ class DebyePDFCalculator :
 
         // methods
         QuantityType getPDFAtQmin(double qmin) const;
+        /// PDF from F values with Q below qmin set to zero
+        QuantityType pdfFromF(QuantityType fpad, double qmin) const;
         void updateQstep();
         /// complete lower bound extension of the calculated grid
         double rcalclo() const;
@@ -121,6 +144,8 @@ class DebyePDFCalculator :
         /// r-range extension to account for tails from out-of-range peaks
         double extFromPeakTails() const;
         void cacheRlimitsData() const;
+        /// compare the current PDF with the observed data
+        void updateResidual() const;
 
         // data
         double mqminpdf;
@@ -130,6 +155,7 @@ class DebyePDFCalculator :
         mutable int mrcalclosteps;
         mutable int mrcalchisteps;
         mutable bool mrlimits_are_cached;
+        mutable FitResidual mresidual;
 
         // serialization
         friend class boost::serialization::access;
@@ -68,6 +68,24 @@ double DebyeWallerPeakWidth::maxWidth(StructureAdapterPtr stru,
     return rv;
 }
 
+
+double DebyeWallerPeakWidth::derivativeDistance(
+        const BaseBondGenerator& bnds) const
+{
+    return 0.0;
+}
+
+
+double DebyeWallerPeakWidth::derivativeMSD(
+        const BaseBondGenerator& bnds) const
+{
+    using diffpy::mathutils::GAUSS_SIGMA_TO_FWHM;
+    double msdval = bnds.msd();
+    double rv = (msdval <= 0.0) ? 0.0 :
+        GAUSS_SIGMA_TO_FWHM / (2 * sqrt(msdval));
+    return rv;
+}
+
 // Registration --------------------------------------------------------------
 
 bool reg_DebyeWallerPeakWidth = DebyeWallerPeakWidth().registerThisType();
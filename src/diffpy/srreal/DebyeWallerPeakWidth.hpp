@@ -39,6 +39,8 @@ class DebyeWallerPeakWidth : public PeakWidthModel
         virtual double calculate(const BaseBondGenerator&) const;
         virtual double maxWidth(StructureAdapterPtr,
                 double rmin, double rmax) const;
+        virtual double derivativeDistance(const BaseBondGenerator&) const;
+        virtual double derivativeMSD(const BaseBondGenerator&) const;
 
     private:
 
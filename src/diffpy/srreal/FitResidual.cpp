@@ -0,0 +1,179 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class FitResidual -- comparison of calculated values with observed data.
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <stdexcept>
+
+#include <diffpy/srreal/FitResidual.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+// relative decrease of chi-square in one window update, which may leave
+// too few significant digits after cancellation in the incremental sum
+const double CANCELLATION_RATIO = 1e-6;
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+FitResidual::FitResidual() :
+    mchisquared(0.0),
+    mwyobs2(0.0),
+    mwindowupdates(0)
+{ }
+
+// Public Methods ------------------------------------------------------------
+
+void FitResidual::setObserved(
+        const QuantityType& yobs, const QuantityType& weights)
+{
+    if (!weights.empty() && weights.size() != yobs.size())
+    {
+        const char* emsg = "Weights must have the same size as observed data.";
+        throw invalid_argument(emsg);
+    }
+    for (double w : weights)
+    {
+        if (w >= 0.0)  continue;
+        throw invalid_argument("Weights must be non-negative.");
+    }
+    myobs = yobs;
+    mweights = weights.empty() ? QuantityType(yobs.size(), 1.0) : weights;
+    mycalc.clear();
+    mchisquared = 0.0;
+    mwindowupdates = 0;
+    mwyobs2 = 0.0;
+    for (size_t i = 0; i < myobs.size(); ++i)
+    {
+        mwyobs2 += mweights[i] * myobs[i] * myobs[i];
+    }
+}
+
+
+const QuantityType& FitResidual::getObserved() const
+{
+    return myobs;
+}
+
+
+const QuantityType& FitResidual::getWeights() const
+{
+    return mweights;
+}
+
+
+bool FitResidual::empty() const
+{
+    return myobs.empty();
+}
+
+
+void FitResidual::update(const QuantityType& ycalc)
+{
+    if (ycalc.size() != myobs.size())
+    {
+        const char* emsg = "Observed data must have the same size "
+            "as the calculated values.";
+        throw invalid_argument(emsg);
+    }
+    mycalc = ycalc;
+    this->sumChiSquared();
+}
+
+
+void FitResidual::updateWindow(int lo, const QuantityType& ycalc)
+{
+    if (lo < 0 || lo + ycalc.size() > mycalc.size())
+    {
+        throw out_of_range("Window exceeds the calculated values.");
+    }
+    // only the changed terms are recomputed
+    double dchisq = 0.0;
+    for (size_t k = 0; k < ycalc.size(); ++k)
+    {
+        const size_t i = lo + k;
+        const double dy0 = mycalc[i] - myobs[i];
+        const double dy1 = ycalc[k] - myobs[i];
+        dchisq += mweights[i] * (dy1 * dy1 - dy0 * dy0);
+        mycalc[i] = ycalc[k];
+    }
+    const double chisq0 = mchisquared;
+    mchisquared += dchisq;
+    // sum again to discard rounding errors of the incremental updates
+    ++mwindowupdates;
+    if (mwindowupdates >= FULL_UPDATE_INTERVAL ||
+            mchisquared <= CANCELLATION_RATIO * chisq0)
+    {
+        this->sumChiSquared();
+    }
+}
+
+
+bool FitResidual::hasCalculated() const
+{
+    return !myobs.empty() && mycalc.size() == myobs.size();
+}
+
+
+QuantityType FitResidual::residual() const
+{
+    QuantityType rv(mycalc.size());
+    for (size_t i = 0; i < rv.size(); ++i)
+    {
+        rv[i] = sqrt(mweights[i]) * (mycalc[i] - myobs[i]);
+    }
+    return rv;
+}
+
+
+double FitResidual::chiSquared() const
+{
+    return mchisquared;
+}
+
+
+double FitResidual::rw() const
+{
+    double rv = (mwyobs2 == 0.0) ? 0.0 : sqrt(mchisquared / mwyobs2);
+    return rv;
+}
+
+// Private Methods -----------------------------------------------------------
+
+void FitResidual::sumChiSquared()
+{
+    mchisquared = 0.0;
+    for (size_t i = 0; i < myobs.size(); ++i)
+    {
+        const double dy = mycalc[i] - myobs[i];
+        mchisquared += mweights[i] * dy * dy;
+    }
+    mwindowupdates = 0;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,80 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class FitResidual -- comparison of calculated values with observed data.
+*     Keeps a copy of the calculated array so that chi-square can be
+*     updated from a changed window of points.
+*
+* The chi-square is the sum of w * (ycalc - yobs)**2 and the agreement
+* factor Rw = sqrt(chi2 / sum(w * yobs**2)).  Window updates change the
+* sum incrementally.  It is summed again in full after FULL_UPDATE_INTERVAL
+* window updates or after cancellations that may lose its precision.
+*
+*****************************************************************************/
+
+#ifndef FITRESIDUAL_HPP_INCLUDED
+#define FITRESIDUAL_HPP_INCLUDED
+
+#include <diffpy/srreal/QuantityType.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class FitResidual
+{
+    public:
+
+        // constants
+        static const int FULL_UPDATE_INTERVAL = 64;
+
+        // constructor
+        FitResidual();
+
+        // methods
+        /// set observed values and their weights, unit weights when empty
+        void setObserved(const QuantityType& yobs,
+                const QuantityType& weights=QuantityType());
+        const QuantityType& getObserved() const;
+        const QuantityType& getWeights() const;
+        /// true when no observed data are set
+        bool empty() const;
+        /// compare complete array of calculated values
+        void update(const QuantityType& ycalc);
+        /// replace calculated values starting at index lo
+        void updateWindow(int lo, const QuantityType& ycalc);
+        /// true when calculated values were compared
+        bool hasCalculated() const;
+        /// weighted residual sqrt(w) * (ycalc - yobs)
+        QuantityType residual() const;
+        double chiSquared() const;
+        double rw() const;
+
+    private:
+
+        // data
+        QuantityType myobs;
+        QuantityType mweights;
+        QuantityType mycalc;
+        double mchisquared;
+        double mwyobs2;
+        int mwindowupdates;
+
+        // methods
+        void sumChiSquared();
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // FITRESIDUAL_HPP_INCLUDED
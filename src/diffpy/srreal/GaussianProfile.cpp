@@ -83,6 +83,25 @@ double GaussianProfile::xboundhi(double fwhm) const
 }
 
 
+double GaussianProfile::derivativeX(double x, double fwhm) const
+{
+    if (fwhm <= 0)  return 0.0;
+    double rv = -8 * M_LN2 * x / (fwhm * fwhm) *
+        this->GaussianProfile::operator()(x, fwhm);
+    return rv;
+}
+
+
+double GaussianProfile::derivativeFWHM(double x, double fwhm) const
+{
+    if (fwhm <= 0)  return 0.0;
+    double xrel = x / fwhm;
+    double rv = (8 * M_LN2 * xrel * xrel - 1) / fwhm *
+        this->GaussianProfile::operator()(x, fwhm);
+    return rv;
+}
+
+
 void GaussianProfile::setPrecision(double eps)
 {
     // correct any settings below DOUBLE_EPS
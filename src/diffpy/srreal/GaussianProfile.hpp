@@ -39,6 +39,8 @@ class GaussianProfile : public PeakProfile
         double operator()(double x, double fwhm) const;
         double xboundlo(double fwhm) const;
         double xboundhi(double fwhm) const;
+        double derivativeX(double x, double fwhm) const;
+        double derivativeFWHM(double x, double fwhm) const;
         void setPrecision(double eps);
 
     protected:
@@ -89,6 +89,51 @@ double JeongPeakWidth::maxWidth(StructureAdapterPtr stru,
     return rv;
 }
 
+
+double JeongPeakWidth::derivativeDistance(const BaseBondGenerator& bnds) const
+{
+    double r = bnds.distance();
+    double corr = this->msdSharpeningRatio(r);
+    if (corr <= 0)  return 0.0;
+    double dcorr = this->getDelta1() / pow(r, 2) +
+        2 * this->getDelta2() / pow(r, 3) +
+        2 * pow(this->getQbroad(), 2) * r;
+    double rv = dcorr / (2 * sqrt(corr)) *
+        this->DebyeWallerPeakWidth::calculate(bnds) +
+        2 * pow(this->getQbroad_seperable(), 2) * r;
+    return rv;
+}
+
+
+double JeongPeakWidth::derivativeAttr(
+        const string& name, const BaseBondGenerator& bnds) const
+{
+    double r = bnds.distance();
+    if (name == "qbroad_seperable")
+    {
+        return 2 * this->getQbroad_seperable() * r * r;
+    }
+    // derivatives of the sharpening ratio
+    double dcorr;
+    if (name == "delta1")  dcorr = -1 / r;
+    else if (name == "delta2")  dcorr = -1 / (r * r);
+    else if (name == "qbroad")  dcorr = 2 * this->getQbroad() * r * r;
+    else  return this->DebyeWallerPeakWidth::derivativeAttr(name, bnds);
+    double corr = this->msdSharpeningRatio(r);
+    double rv = (corr <= 0) ? 0.0 : dcorr / (2 * sqrt(corr)) *
+        this->DebyeWallerPeakWidth::calculate(bnds);
+    return rv;
+}
+
+
+double JeongPeakWidth::derivativeMSD(const BaseBondGenerator& bnds) const
+{
+    double corr = this->msdSharpeningRatio(bnds.distance());
+    double rv = (corr <= 0) ? 0.0 :
+        sqrt(corr) * this->DebyeWallerPeakWidth::derivativeMSD(bnds);
+    return rv;
+}
+
 const double& JeongPeakWidth::getDelta1() const
 {
     return mdelta1;
@@ -41,6 +41,10 @@ class JeongPeakWidth : public DebyeWallerPeakWidth
         virtual double calculate(const BaseBondGenerator&) const;
         virtual double maxWidth(StructureAdapterPtr,
                 double rmin, double rmax) const;
+        virtual double derivativeDistance(const BaseBondGenerator&) const;
+        virtual double derivativeMSD(const BaseBondGenerator&) const;
+        virtual double derivativeAttr(const std::string& name,
+                const BaseBondGenerator&) const;
 
         // data access
         const double& getDelta1() const;
@@ -186,21 +186,21 @@ double Lattice::volume() const
 
 const R3::Vector& Lattice::cartesian(const R3::Vector& lv) const
 {
-    static R3::Vector res;
+    thread_local R3::Vector res;
     res = R3::mxvecproduct(lv, mbase);
     return res;
 }
 
 const R3::Vector& Lattice::fractional(const R3::Vector& cv) const
 {
-    static R3::Vector res;
+    thread_local R3::Vector res;
     res = R3::mxvecproduct(cv, mrecbase);
     return res;
 }
 
 const R3::Vector& Lattice::ucvCartesian(const R3::Vector& cv) const
 {
-    static R3::Vector res;
+    thread_local R3::Vector res;
     res = cartesian(ucvFractional(fractional(cv)));
     return res;
 }
@@ -208,7 +208,7 @@ const R3::Vector& Lattice::ucvCartesian(const R3::Vector& cv) const
 const R3::Vector& Lattice::ucvFractional(const R3::Vector& lv) const
 {
     using mathutils::eps_eq;
-    static R3::Vector res;
+    thread_local R3::Vector res;
     res = lv - floor(lv);
     if (eps_eq(res[0], 1.0))  res[0] = 0.0;
     if (eps_eq(res[1], 1.0))  res[1] = 0.0;
@@ -218,7 +218,7 @@ const R3::Vector& Lattice::ucvFractional(const R3::Vector& lv) const
 
 const R3::Matrix& Lattice::cartesianMatrix(const R3::Matrix& Ml) const
 {
-    static R3::Matrix res0, res1;
+    thread_local R3::Matrix res0, res1;
     res0 = prod(Ml, mnormbase);
     res1 = prod(R3::trans(mnormbase), res0);
     return res1;
@@ -226,7 +226,7 @@ const R3::Matrix& Lattice::cartesianMatrix(const R3::Matrix& Ml) const
 
 const R3::Matrix& Lattice::fractionalMatrix(const R3::Matrix& Mc) const
 {
-    static R3::Matrix res0, res1;
+    thread_local R3::Matrix res0, res1;
     res0 = prod(Mc, mrecnormbase);
     res1 = prod(R3::trans(mrecnormbase), res0);
     return res1;
@@ -235,7 +235,7 @@ const R3::Matrix& Lattice::fractionalMatrix(const R3::Matrix& Mc) const
 
 const R3::Vector& Lattice::ucMaxDiagonal() const
 {
-    static list<R3::Vector> ucdiagonals;
+    thread_local list<R3::Vector> ucdiagonals;
     if (ucdiagonals.empty())
     {
         ucdiagonals.push_back(R3::Vector(+1, +1, +1));
@@ -489,7 +489,7 @@ double Lattice::norm(const V& u) const
 template <class V>
 double Lattice::distance(const V& u, const V& v) const
 {
-    static R3::Vector duv;
+    R3::Vector duv;
     duv[0] = u[0] - v[0];
     duv[1] = u[1] - v[1];
     duv[2] = u[2] - v[2];
@@ -517,7 +517,7 @@ double Lattice::anglerad(const V& u, const V& v) const
 template <class V>
 const R3::Vector& Lattice::cartesian(const V& lv) const
 {
-    static R3::Vector lvcopy;
+    R3::Vector lvcopy;
     lvcopy[0] = lv[0];
     lvcopy[1] = lv[1];
     lvcopy[2] = lv[2];
@@ -528,7 +528,7 @@ const R3::Vector& Lattice::cartesian(const V& lv) const
 template <class V>
 const R3::Vector& Lattice::fractional(const V& cv) const
 {
-    static R3::Vector cvcopy;
+    R3::Vector cvcopy;
     cvcopy[0] = cv[0];
     cvcopy[1] = cv[1];
     cvcopy[2] = cv[2];
@@ -539,7 +539,7 @@ const R3::Vector& Lattice::fractional(const V& cv) const
 template <class V>
 const R3::Vector& Lattice::ucvCartesian(const V& cv) const
 {
-    static R3::Vector cvcopy;
+    R3::Vector cvcopy;
     cvcopy[0] = cv[0];
     cvcopy[1] = cv[1];
     cvcopy[2] = cv[2];
@@ -550,7 +550,7 @@ const R3::Vector& Lattice::ucvCartesian(const V& cv) const
 template <class V>
 const R3::Vector& Lattice::ucvFractional(const V& cv) const
 {
-    static R3::Vector cvcopy;
+    R3::Vector cvcopy;
     cvcopy[0] = cv[0];
     cvcopy[1] = cv[1];
     cvcopy[2] = cv[2];
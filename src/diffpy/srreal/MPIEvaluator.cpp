@@ -0,0 +1,300 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class MPIEvaluator -- evaluation of PairQuantity calculators distributed
+*     over the processes of an MPI communicator
+*
+*****************************************************************************/
+
+#include <cassert>
+#include <stdexcept>
+#include <numeric>
+
+#include <diffpy/serialization.hpp>
+#include <diffpy/srreal/MPIEvaluator.hpp>
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+enum { SERIALIZED, ATOMS };
+
+// coordinates, occupancy, anisotropy flag and 6 Uij components per atom
+const int ATOM_CHUNK_SIZE = 11;
+
+
+const R3::Matrix& _latticeBase(const StructureAdapter& stru)
+{
+    const PeriodicStructureAdapter* pstru =
+        dynamic_cast<const PeriodicStructureAdapter*>(&stru);
+    return pstru ? pstru->getLattice().base() : R3::zeromatrix();
+}
+
+
+void _packAtoms(vector<double>& data, const AtomicStructureAdapter& stru)
+{
+    data.clear();
+    data.reserve(ATOM_CHUNK_SIZE * stru.size());
+    AtomicStructureAdapter::const_iterator ai = stru.begin();
+    for (; ai != stru.end(); ++ai)
+    {
+        const R3::Vector& xyz = ai->xyz_cartn;
+        const R3::Matrix& U = ai->uij_cartn;
+        data.insert(data.end(), xyz.begin(), xyz.end());
+        data.push_back(ai->occupancy);
+        data.push_back(ai->anisotropy);
+        const double uij[6] = {
+            U(0, 0), U(1, 1), U(2, 2), U(0, 1), U(0, 2), U(1, 2)};
+        data.insert(data.end(), uij, uij + 6);
+    }
+}
+
+
+void _unpackAtoms(AtomicStructureAdapter& stru, const vector<double>& data)
+{
+    assert(data.size() == ATOM_CHUNK_SIZE * stru.size());
+    vector<double>::const_iterator di = data.begin();
+    AtomicStructureAdapter::iterator ai = stru.begin();
+    for (; ai != stru.end(); ++ai, di += ATOM_CHUNK_SIZE)
+    {
+        copy(di, di + 3, ai->xyz_cartn.begin());
+        ai->occupancy = di[3];
+        ai->anisotropy = bool(di[4]);
+        R3::Matrix& U = ai->uij_cartn;
+        U(0, 0) = di[5];  U(1, 1) = di[6];  U(2, 2) = di[7];
+        U(0, 1) = U(1, 0) = di[8];
+        U(0, 2) = U(2, 0) = di[9];
+        U(1, 2) = U(2, 1) = di[10];
+    }
+}
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+MPIEvaluator::MPIEvaluator(MPI_Comm comm, int root) :
+    mcomm(comm),
+    mroot(root),
+    mfullbroadcasts(0),
+    mstructure(emptyStructureAdapter()),
+    mlasttype(NULL),
+    mlastlatticebase(R3::zeromatrix())
+{
+    MPI_Comm_rank(mcomm, &mrank);
+    MPI_Comm_size(mcomm, &msize);
+    if (mroot < 0 || mroot >= msize)
+    {
+        const char* emsg = "Root must be a process rank in the communicator.";
+        throw invalid_argument(emsg);
+    }
+}
+
+// Public Methods ------------------------------------------------------------
+
+const QuantityType&
+MPIEvaluator::eval(PairQuantity& pq, StructureAdapterPtr stru)
+{
+    StructureAdapterPtr pstru = this->broadcastStructure(stru);
+    if (msize == 1)  return pq.eval(pstru);
+    // Evaluator data of a process do not match the merged value, therefore
+    // fast updates are disabled before and after the distributed run.
+    pq.mticker.click();
+    pq.setupParallelRun(mrank, msize);
+    vector<QuantityType*> sumarrays;
+    try
+    {
+        pq.eval(pstru);
+        sumarrays = pq.getParallelSumArrays();
+    }
+    catch (...)
+    {
+        pq.setupParallelRun(0, 1);
+        throw;
+    }
+    // merging requires calculator in the serial configuration
+    pq.setupParallelRun(0, 1);
+    if (sumarrays.empty())  this->gatherParallelData(pq);
+    else  this->reduceParallelSums(pq, sumarrays);
+    pq.mticker.click();
+    return pq.value();
+}
+
+
+StructureAdapterPtr MPIEvaluator::broadcastStructure(StructureAdapterPtr stru)
+{
+    // header holds the broadcast method and the length of data
+    int header[2] = {SERIALIZED, 0};
+    string sdata;
+    vector<double> adata;
+    if (this->isRoot())
+    {
+        mstructure = stru.get() ? stru : emptyStructureAdapter();
+        if (this->canUpdateAtoms(*mstructure))
+        {
+            header[0] = ATOMS;
+            _packAtoms(adata,
+                    static_cast<const AtomicStructureAdapter&>(*mstructure));
+            header[1] = adata.size();
+        }
+        else
+        {
+            sdata = diffpy::serialization_tostring(mstructure);
+            header[1] = sdata.size();
+            this->recordStructure(*mstructure);
+        }
+    }
+    MPI_Bcast(header, 2, MPI_INT, mroot, mcomm);
+    if (header[0] == ATOMS)
+    {
+        adata.resize(header[1]);
+        MPI_Bcast(adata.data(), header[1], MPI_DOUBLE, mroot, mcomm);
+        if (!this->isRoot())
+        {
+            _unpackAtoms(static_cast<AtomicStructureAdapter&>(*mstructure),
+                    adata);
+        }
+        return mstructure;
+    }
+    sdata.resize(header[1]);
+    MPI_Bcast(&sdata[0], header[1], MPI_CHAR, mroot, mcomm);
+    if (!this->isRoot())
+    {
+        diffpy::serialization_fromstring(mstructure, sdata);
+    }
+    ++mfullbroadcasts;
+    return mstructure;
+}
+
+
+MPI_Comm MPIEvaluator::getCommunicator() const
+{
+    return mcomm;
+}
+
+
+int MPIEvaluator::getRoot() const
+{
+    return mroot;
+}
+
+
+int MPIEvaluator::rank() const
+{
+    return mrank;
+}
+
+
+int MPIEvaluator::size() const
+{
+    return msize;
+}
+
+
+bool MPIEvaluator::isRoot() const
+{
+    return mrank == mroot;
+}
+
+
+int MPIEvaluator::countFullBroadcasts() const
+{
+    return mfullbroadcasts;
+}
+
+// Private Methods -----------------------------------------------------------
+
+bool MPIEvaluator::canUpdateAtoms(const StructureAdapter& stru) const
+{
+    // exact types only, derived classes may keep other data
+    const type_info& tp = typeid(stru);
+    if (!mlasttype || tp != *mlasttype)  return false;
+    if (tp != typeid(AtomicStructureAdapter) &&
+            tp != typeid(PeriodicStructureAdapter))
+    {
+        return false;
+    }
+    const int cntsites = stru.countSites();
+    if (cntsites != int(mlastatomtypes.size()))  return false;
+    for (int i = 0; i < cntsites; ++i)
+    {
+        if (stru.siteAtomType(i) != mlastatomtypes[i])  return false;
+    }
+    return _latticeBase(stru) == mlastlatticebase;
+}
+
+
+void MPIEvaluator::recordStructure(const StructureAdapter& stru)
+{
+    mlasttype = &typeid(stru);
+    const int cntsites = stru.countSites();
+    mlastatomtypes.resize(cntsites);
+    for (int i = 0; i < cntsites; ++i)
+    {
+        mlastatomtypes[i] = stru.siteAtomType(i);
+    }
+    mlastlatticebase = _latticeBase(stru);
+}
+
+
+void MPIEvaluator::reduceParallelSums(PairQuantity& pq,
+        const vector<QuantityType*>& sumarrays) const
+{
+    // all processes must have the same array sizes
+    const int n = sumarrays.size();
+    vector<long> szlo(n), szhi(n);
+    for (int i = 0; i < n; ++i)  szlo[i] = szhi[i] = sumarrays[i]->size();
+    MPI_Allreduce(MPI_IN_PLACE, szlo.data(), n, MPI_LONG, MPI_MIN, mcomm);
+    MPI_Allreduce(MPI_IN_PLACE, szhi.data(), n, MPI_LONG, MPI_MAX, mcomm);
+    if (szlo != szhi)
+    {
+        throw invalid_argument("Merged data array must have the same size.");
+    }
+    for (QuantityType* a : sumarrays)
+    {
+        if (a->empty())  continue;
+        MPI_Allreduce(MPI_IN_PLACE, a->data(), a->size(),
+                MPI_DOUBLE, MPI_SUM, mcomm);
+    }
+    pq.mmergedvaluescount = msize;
+    pq.finishValue();
+}
+
+
+void MPIEvaluator::gatherParallelData(PairQuantity& pq) const
+{
+    const string pdata = pq.getParallelData();
+    int count = pdata.size();
+    vector<int> counts(msize), offsets(msize, 0);
+    MPI_Allgather(&count, 1, MPI_INT, counts.data(), 1, MPI_INT, mcomm);
+    partial_sum(counts.begin(), counts.end() - 1, offsets.begin() + 1);
+    string buffer(offsets.back() + counts.back(), '\0');
+    MPI_Allgatherv(pdata.data(), count, MPI_CHAR, &buffer[0],
+            counts.data(), offsets.data(), MPI_CHAR, mcomm);
+    pq.resetValue();
+    for (int i = 0; i < msize; ++i)
+    {
+        pq.mergeParallelData(buffer.substr(offsets[i], counts[i]), msize);
+    }
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
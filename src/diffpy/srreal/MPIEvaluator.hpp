@@ -0,0 +1,95 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class MPIEvaluator -- evaluation of PairQuantity calculators distributed
+*     over the processes of an MPI communicator
+*
+* All processes call eval collectively with identically configured
+* calculators.  The structure of the root process is broadcast to the
+* others and each process sums pairs of its share of anchor sites.  Partial
+* results that are added together are then reduced in place, partial bond
+* lists are gathered and merged.  Every process ends with the complete
+* result in its calculator.
+*
+* Structures are broadcast in serialized form when they change in kind,
+* site count, atom types or lattice.  Otherwise AtomicStructureAdapter and
+* PeriodicStructureAdapter send only the site coordinates, occupancies and
+* displacement parameters, which update the copy in other processes.
+*
+* The partial sums of a process cannot be updated for structure changes,
+* therefore distributed evaluation always sums over all pairs.  This class
+* is only available in builds with MPI support, see DIFFPY_HAS_MPI.
+*
+*****************************************************************************/
+
+#ifndef MPIEVALUATOR_HPP_INCLUDED
+#define MPIEVALUATOR_HPP_INCLUDED
+
+#include <typeinfo>
+#include <mpi.h>
+
+#include <diffpy/srreal/PairQuantity.hpp>
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class MPIEvaluator
+{
+    public:
+
+        // constructor
+        explicit MPIEvaluator(MPI_Comm comm=MPI_COMM_WORLD, int root=0);
+
+        // methods
+        /// evaluate calculator for the root structure in all processes.
+        /// The structure argument is ignored in non-root processes.
+        const QuantityType& eval(PairQuantity&, StructureAdapterPtr);
+        /// copy of the root structure in every process.  The root process
+        /// returns its own argument.
+        StructureAdapterPtr broadcastStructure(StructureAdapterPtr);
+        MPI_Comm getCommunicator() const;
+        int getRoot() const;
+        int rank() const;
+        int size() const;
+        bool isRoot() const;
+        /// number of broadcasts that sent serialized structures
+        int countFullBroadcasts() const;
+
+    private:
+
+        // data
+        MPI_Comm mcomm;
+        int mroot;
+        int mrank;
+        int msize;
+        int mfullbroadcasts;
+        StructureAdapterPtr mstructure;
+        // last serialized structure as known in the root process
+        const std::type_info* mlasttype;
+        std::vector<std::string> mlastatomtypes;
+        R3::Matrix mlastlatticebase;
+
+        // methods
+        bool canUpdateAtoms(const StructureAdapter&) const;
+        void recordStructure(const StructureAdapter&);
+        void reduceParallelSums(PairQuantity&,
+                const std::vector<QuantityType*>&) const;
+        void gatherParallelData(PairQuantity&) const;
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // MPIEVALUATOR_HPP_INCLUDED
@@ -0,0 +1,63 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class MemoryUsage -- heap memory held by calculators and structure
+*     adapters split per named component
+*
+*****************************************************************************/
+
+#include <diffpy/srreal/MemoryUsage.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Public Methods ------------------------------------------------------------
+
+void MemoryUsage::add(const string& component, size_t nbytes)
+{
+    mcomponents[component] += nbytes;
+}
+
+
+void MemoryUsage::add(const MemoryUsage& other, const string& prefix)
+{
+    ComponentsStorage::const_iterator ii = other.mcomponents.begin();
+    for (; ii != other.mcomponents.end(); ++ii)
+    {
+        this->add(prefix + ii->first, ii->second);
+    }
+}
+
+
+size_t MemoryUsage::component(const string& component) const
+{
+    ComponentsStorage::const_iterator ii = mcomponents.find(component);
+    return (ii != mcomponents.end()) ? ii->second : 0;
+}
+
+
+size_t MemoryUsage::total() const
+{
+    size_t rv = 0;
+    ComponentsStorage::const_iterator ii = mcomponents.begin();
+    for (; ii != mcomponents.end(); ++ii)  rv += ii->second;
+    return rv;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
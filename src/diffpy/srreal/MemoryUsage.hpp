@@ -0,0 +1,114 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class MemoryUsage -- heap memory held by calculators and structure
+*     adapters split per named component
+*
+* The byteSize helpers approximate the heap memory of standard containers
+* from their capacity.  They do not account for allocator overhead, so that
+* the reported values are lower bounds of the actual memory use.
+*
+*****************************************************************************/
+
+#ifndef MEMORYUSAGE_HPP_INCLUDED
+#define MEMORYUSAGE_HPP_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_set>
+#include <unordered_map>
+
+namespace diffpy {
+namespace srreal {
+
+class MemoryUsage
+{
+    public:
+
+        typedef std::map<std::string, size_t> ComponentsStorage;
+
+        // methods
+        /// add nbytes to the named component
+        void add(const std::string& component, size_t nbytes);
+        /// add all components of other with names prefixed by prefix
+        void add(const MemoryUsage& other, const std::string& prefix="");
+        /// bytes used by the named component or 0 if not present
+        size_t component(const std::string& component) const;
+        /// total bytes used by all components
+        size_t total() const;
+        const ComponentsStorage& components() const  { return mcomponents; }
+
+    private:
+
+        // data
+        ComponentsStorage mcomponents;
+
+};
+
+// Heap memory of standard containers ----------------------------------------
+
+inline
+size_t byteSize(const std::string& s)
+{
+    // short strings are stored within the object
+    const char* lo = reinterpret_cast<const char*>(&s);
+    const char* hi = lo + sizeof(std::string);
+    const bool inplace = (lo <= s.data() && s.data() < hi);
+    size_t rv = inplace ? 0 : (s.capacity() + 1);
+    return rv;
+}
+
+
+template <class T, class A>
+size_t byteSize(const std::vector<T, A>& v)
+{
+    return v.capacity() * sizeof(T);
+}
+
+
+template <class T, class A>
+size_t byteSize(const std::list<T, A>& lst)
+{
+    return lst.size() * (sizeof(T) + 2 * sizeof(void*));
+}
+
+
+template <class H>
+size_t hashedContainerByteSize(const H& h)
+{
+    const size_t nodesize = sizeof(typename H::value_type) +
+        sizeof(void*) + sizeof(size_t);
+    return h.size() * nodesize + h.bucket_count() * sizeof(void*);
+}
+
+
+template <class K, class H, class P, class A>
+size_t byteSize(const std::unordered_set<K, H, P, A>& s)
+{
+    return hashedContainerByteSize(s);
+}
+
+
+template <class K, class T, class H, class P, class A>
+size_t byteSize(const std::unordered_map<K, T, H, P, A>& m)
+{
+    return hashedContainerByteSize(m);
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // MEMORYUSAGE_HPP_INCLUDED
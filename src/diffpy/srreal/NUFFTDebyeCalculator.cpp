@@ -0,0 +1,397 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class NUFFTDebyeCalculator -- orientationally averaged scattering of
+*     a finite particle from non-uniform fast Fourier transforms
+*
+*****************************************************************************/
+
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include <unordered_map>
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_fft_complex.h>
+
+#include <diffpy/serialization.ipp>
+#include <diffpy/srreal/NUFFTDebyeCalculator.hpp>
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
+#include <diffpy/srreal/PDFUtils.hpp>
+#include <diffpy/mathutils.hpp>
+#include <diffpy/validators.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+using namespace diffpy::validators;
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// Default relative accuracy, the same as for the Debye sums.
+const double DEFAULT_NUFFT_PRECISION = 1e-6;
+
+/// Atom of the particle with an index of its atom type.
+struct ParticleAtom
+{
+    R3::Vector xyz;
+    double uiso;
+    double occupancy;
+    int typeidx;
+};
+
+
+/// Gaussian assigned to the gridding axis for an atom.
+struct GaussianSpread
+{
+    double halfwidth;
+    double halfinvvar;
+    double norm;
+    double ratiostep;
+};
+
+
+/// smallest power of 2 that is not below x
+int _powerOfTwoAtLeast(double x)
+{
+    int rv = 1;
+    while (rv < x)  rv *= 2;
+    return rv;
+}
+
+
+/// Nodes and weights of the n-point Gauss-Legendre quadrature on [-1, 1].
+void _gaussLegendre(int n, vector<double>& x, vector<double>& w)
+{
+    x.resize(n);
+    w.resize(n);
+    for (int i = 0; i < (n + 1) / 2; ++i)
+    {
+        // Newton iterations from the asymptotic estimate of the root
+        double z = cos(M_PI * (i + 0.75) / (n + 0.5));
+        double dp = 1.0;
+        for (int iter = 0; iter < 100; ++iter)
+        {
+            double p0 = 1.0;
+            double p1 = z;
+            for (int l = 2; l <= n; ++l)
+            {
+                const double p2 = ((2 * l - 1) * z * p1 - (l - 1) * p0) / l;
+                p0 = p1;
+                p1 = p2;
+            }
+            dp = n * (z * p1 - p0) / (z * z - 1);
+            const double dz = p1 / dp;
+            z -= dz;
+            if (fabs(dz) < 1e-15)  break;
+        }
+        x[i] = z;
+        x[n - 1 - i] = -z;
+        w[i] = w[n - 1 - i] = 2 / ((1 - z * z) * dp * dp);
+    }
+}
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+NUFFTDebyeCalculator::NUFFTDebyeCalculator() :
+    mqmin(0.0),
+    mqmax(DEFAULT_QGRID_QMAX),
+    mqstep(DEFAULT_QGRID_QSTEP),
+    mdebyeprecision(DEFAULT_NUFFT_PRECISION),
+    mdirectioncount(0)
+{
+    this->setScatteringFactorTableByType("xray");
+    // attributes
+    this->registerDoubleAttribute("qmin", this,
+            &NUFFTDebyeCalculator::getQmin,
+            &NUFFTDebyeCalculator::setQmin);
+    this->registerDoubleAttribute("qmax", this,
+            &NUFFTDebyeCalculator::getQmax,
+            &NUFFTDebyeCalculator::setQmax);
+    this->registerDoubleAttribute("qstep", this,
+            &NUFFTDebyeCalculator::getQstep,
+            &NUFFTDebyeCalculator::setQstep);
+    this->registerDoubleAttribute("debyeprecision", this,
+            &NUFFTDebyeCalculator::getDebyePrecision,
+            &NUFFTDebyeCalculator::setDebyePrecision);
+}
+
+// Public Methods ------------------------------------------------------------
+
+const QuantityType& NUFFTDebyeCalculator::eval(StructureAdapterPtr stru)
+{
+    using diffpy::mathutils::DOUBLE_EPS;
+    if (dynamic_cast<const PeriodicStructureAdapter*>(stru.get()))
+    {
+        const char* emsg = "NUFFT sum requires finite structure.";
+        throw invalid_argument(emsg);
+    }
+    const int nqpts = pdfutils_qmaxSteps(this);
+    const int kqlo = pdfutils_qminSteps(this);
+    const double& dq = this->getQstep();
+    mvalue.assign(nqpts, 0.0);
+    mdirectioncount = 0;
+    // collect the atoms and their types
+    vector<ParticleAtom> atoms;
+    vector<string> atomtypes;
+    unordered_map<string, int> atomtypeidx;
+    const int cntsites = stru ? stru->countSites() : 0;
+    double totocc = 0.0;
+    R3::Vector center = R3::zerovector;
+    for (int i = 0; i < cntsites; ++i)
+    {
+        const string& smbl = stru->siteAtomType(i);
+        if (!atomtypeidx.count(smbl))
+        {
+            atomtypeidx.insert(make_pair(smbl, int(atomtypes.size())));
+            atomtypes.push_back(smbl);
+        }
+        const R3::Matrix& U = stru->siteCartesianUij(i);
+        ParticleAtom pa = {stru->siteCartesianPosition(i),
+            (U(0, 0) + U(1, 1) + U(2, 2)) / 3,
+            stru->siteOccupancy(i), atomtypeidx[smbl]};
+        atoms.push_back(pa);
+        totocc += pa.occupancy;
+        center += pa.xyz;
+    }
+    if (atoms.empty() || totocc == 0.0 || kqlo >= nqpts || nqpts < 2)
+    {
+        return mvalue;
+    }
+    center /= double(atoms.size());
+    double rmax = 0.0;
+    vector<ParticleAtom>::iterator pa;
+    for (pa = atoms.begin(); pa != atoms.end(); ++pa)
+    {
+        pa->xyz -= center;
+        rmax = max(rmax, R3::norm(pa->xyz));
+    }
+    // scattering factors of the atom types
+    const ScatteringFactorTable& sftable = *(this->getScatteringFactorTable());
+    const int ntypes = atomtypes.size();
+    vector<QuantityType> sftype(ntypes, QuantityType(nqpts, 0.0));
+    for (int tp = 0; tp < ntypes; ++tp)
+    {
+        for (int kq = kqlo; kq < nqpts; ++kq)
+        {
+            sftype[tp][kq] = sftable.lookup(atomtypes[tp], kq * dq);
+        }
+    }
+    const double qmax = (nqpts - 1) * dq;
+    const double prec = max(DOUBLE_EPS, min(0.5, this->getDebyePrecision()));
+    const double lnprec = -log(prec);
+    // directions from the product of Gauss-Legendre rule in cos(theta)
+    // and of uniform azimuths.  The rule is exact for spherical harmonics
+    // up to the degree lmax, which is above the order where the expansion
+    // of sin(Q r) / (Q r) drops below prec for pair distances r.
+    const double qd = qmax * 2 * rmax;
+    const int lmax = int(ceil(qd + 1.8 * cbrt(qd) * pow(lnprec, 2.0 / 3))) + 1;
+    int nmu = lmax / 2 + 1;
+    nmu += nmu % 2;
+    const int nphi = lmax + 1;
+    vector<double> mu, wmu;
+    _gaussLegendre(nmu, mu, wmu);
+    // Gaussian gridding with at least 2 times oversampling of the band
+    // [-Qmax, Qmax].  The variance tau keeps aliased terms below prec and
+    // the peak tails are cut where they drop below prec.  The grid period
+    // 2 pi / dq puts the Q-grid points on the FFT modes.
+    const int nfft = _powerOfTwoAtLeast(4 * nqpts);
+    const double h = 2 * M_PI / (nfft * dq);
+    const double oversampling = nfft * dq / (2 * qmax);
+    const double tau = lnprec /
+        (2 * oversampling * (oversampling - 1) * qmax * qmax);
+    const double tailfactor = 2 * (lnprec + 0.5 * tau * qmax * qmax);
+    // atoms are normalized Gaussians of the variance tau + uiso, which
+    // includes the Debye-Waller damping
+    vector<GaussianSpread> spreads(atoms.size());
+    for (size_t j = 0; j < atoms.size(); ++j)
+    {
+        const double v = tau + atoms[j].uiso;
+        GaussianSpread& gs = spreads[j];
+        gs.halfwidth = sqrt(tailfactor * v);
+        gs.halfinvvar = 0.5 / v;
+        gs.norm = atoms[j].occupancy / sqrt(2 * M_PI * v);
+        gs.ratiostep = exp(-h * h / v);
+    }
+    vector<double> grids(2 * nfft * ntypes);
+    QuantityType intensity(nqpts, 0.0);
+    for (int a = 0; a < nmu / 2; ++a)
+    {
+        // antipodal directions have the same intensity
+        const double sintheta = sqrt(1 - mu[a] * mu[a]);
+        const double wdir = 2 * wmu[a] * 2 * M_PI / nphi;
+        for (int b = 0; b < nphi; ++b, ++mdirectioncount)
+        {
+            const double phi = 2 * M_PI * b / nphi;
+            const R3::Vector dir(sintheta * cos(phi),
+                    sintheta * sin(phi), mu[a]);
+            fill(grids.begin(), grids.end(), 0.0);
+            for (size_t j = 0; j < atoms.size(); ++j)
+            {
+                const GaussianSpread& gs = spreads[j];
+                const double p = R3::dot(dir, atoms[j].xyz);
+                const int mlo = int(ceil((p - gs.halfwidth) / h));
+                const int mhi = int(floor((p + gs.halfwidth) / h));
+                const double d0 = mlo * h - p;
+                double g = gs.norm * exp(-d0 * d0 * gs.halfinvvar);
+                double gratio = exp(-(2 * d0 + h) * h * gs.halfinvvar);
+                double* grid = grids.data() + 2 * nfft * atoms[j].typeidx;
+                int mw = mlo % nfft;
+                if (mw < 0)  mw += nfft;
+                for (int m = mlo; m <= mhi; ++m)
+                {
+                    grid[2 * mw] += g;
+                    g *= gratio;
+                    gratio *= gs.ratiostep;
+                    if (++mw == nfft)  mw = 0;
+                }
+            }
+            for (int tp = 0; tp < ntypes; ++tp)
+            {
+                double* grid = grids.data() + 2 * nfft * tp;
+                int status = gsl_fft_complex_radix2_forward(grid, 1, nfft);
+                if (status != GSL_SUCCESS)
+                {
+                    const char* emsg = "Fourier Transformation failed.";
+                    throw invalid_argument(emsg);
+                }
+            }
+            for (int kq = kqlo; kq < nqpts; ++kq)
+            {
+                double re = 0.0;
+                double im = 0.0;
+                for (int tp = 0; tp < ntypes; ++tp)
+                {
+                    const double* grid = grids.data() + 2 * nfft * tp;
+                    re += sftype[tp][kq] * grid[2 * kq];
+                    im += sftype[tp][kq] * grid[2 * kq + 1];
+                }
+                intensity[kq] += wdir * (re * re + im * im);
+            }
+        }
+    }
+    // remove the gridding Gaussian and the self-scattering terms
+    for (int kq = kqlo; kq < nqpts; ++kq)
+    {
+        const double q = kq * dq;
+        const double deconv = h * exp(0.5 * tau * q * q);
+        double sfsum = 0.0;
+        double selfsum = 0.0;
+        for (pa = atoms.begin(); pa != atoms.end(); ++pa)
+        {
+            const double f = pa->occupancy * sftype[pa->typeidx][kq];
+            sfsum += f;
+            selfsum += f * f * exp(-q * q * pa->uiso);
+        }
+        const double sfavg = sfsum / totocc;
+        const double iavg = deconv * deconv * intensity[kq] / (4 * M_PI);
+        mvalue[kq] = (sfavg == 0.0) ? 0.0 :
+            (q * (iavg - selfsum) / (sfavg * sfavg * totocc));
+    }
+    return mvalue;
+}
+
+
+const QuantityType& NUFFTDebyeCalculator::value() const
+{
+    return mvalue;
+}
+
+
+int NUFFTDebyeCalculator::countDirections() const
+{
+    return mdirectioncount;
+}
+
+// results
+
+QuantityType NUFFTDebyeCalculator::getF() const
+{
+    return mvalue;
+}
+
+// Q-range methods
+
+QuantityType NUFFTDebyeCalculator::getQgrid() const
+{
+    return pdfutils_getQgrid(this);
+}
+
+// Q-range configuration
+
+void NUFFTDebyeCalculator::setQmin(double qmin)
+{
+    ensureNonNegative("Qmin", qmin);
+    mqmin = qmin;
+}
+
+
+const double& NUFFTDebyeCalculator::getQmin() const
+{
+    return mqmin;
+}
+
+
+void NUFFTDebyeCalculator::setQmax(double qmax)
+{
+    ensureNonNegative("Qmax", qmax);
+    mqmax = qmax;
+}
+
+
+const double& NUFFTDebyeCalculator::getQmax() const
+{
+    return mqmax;
+}
+
+
+void NUFFTDebyeCalculator::setQstep(double qstep)
+{
+    ensureEpsilonPositive("Qstep", qstep);
+    mqstep = qstep;
+}
+
+
+const double& NUFFTDebyeCalculator::getQstep() const
+{
+    return mqstep;
+}
+
+// accuracy
+
+void NUFFTDebyeCalculator::setDebyePrecision(double precision)
+{
+    mdebyeprecision = precision;
+}
+
+
+const double& NUFFTDebyeCalculator::getDebyePrecision() const
+{
+    return mdebyeprecision;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+DIFFPY_INSTANTIATE_SERIALIZATION(diffpy::srreal::NUFFTDebyeCalculator)
+
+// End of file
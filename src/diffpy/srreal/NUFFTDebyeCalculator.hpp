@@ -0,0 +1,116 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class NUFFTDebyeCalculator -- orientationally averaged scattering of
+*     a finite particle from non-uniform fast Fourier transforms
+*
+* The scattering amplitude is evaluated along directions of a spherical
+* quadrature.  For each direction the atom positions are projected on its
+* axis and the amplitudes at all points of the Q-grid are obtained from
+* a 1D non-uniform FFT with Gaussian gridding.  The squared amplitudes are
+* averaged over the directions and the self-scattering terms are removed.
+* F(Q) has the same normalization as the Debye sum in DebyePDFCalculator.
+* The quadrature is exact for pair distances within the particle, hence
+* the result agrees with the Debye sum to the debyeprecision.
+*
+* Atoms are damped with Debye-Waller factors of their equivalent isotropic
+* displacements, which matches the default "jeong" peak width model of
+* DebyePDFCalculator without correlation corrections.  The work scales
+* with the number of atoms times (Qmax * D)**2 directions, where D is the
+* particle diameter.  This is cheaper than pair sums for large particles
+* at small Qmax.
+*
+*****************************************************************************/
+
+#ifndef NUFFTDEBYECALCULATOR_HPP_INCLUDED
+#define NUFFTDEBYECALCULATOR_HPP_INCLUDED
+
+#include <diffpy/Attributes.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
+#include <diffpy/srreal/ScatteringFactorTable.hpp>
+#include <diffpy/srreal/forwardtypes.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class NUFFTDebyeCalculator :
+    public diffpy::Attributes,
+    public ScatteringFactorTableOwner
+{
+    public:
+
+        // constructor
+        NUFFTDebyeCalculator();
+
+        // methods
+        /// average the scattering of a finite structure over directions.
+        /// Throw invalid_argument for periodic structures.
+        const QuantityType& eval(StructureAdapterPtr);
+        /// F values from the last evaluation on a Q-grid starting at 0
+        const QuantityType& value() const;
+        /// number of quadrature directions in the last evaluation
+        int countDirections() const;
+
+        // results
+        /// reduced structure function F(Q) = Q (S(Q) - 1)
+        QuantityType getF() const;
+
+        // Q-range methods
+        /// Full Q-grid starting at 0
+        QuantityType getQgrid() const;
+        // Q-range configuration
+        void setQmin(double);
+        const double& getQmin() const;
+        void setQmax(double);
+        const double& getQmax() const;
+        void setQstep(double);
+        const double& getQstep() const;
+
+        // accuracy
+        /// relative accuracy of the direction average and of the
+        /// Fourier transforms
+        void setDebyePrecision(double);
+        const double& getDebyePrecision() const;
+
+    private:
+
+        // data
+        double mqmin;
+        double mqmax;
+        double mqstep;
+        double mdebyeprecision;
+        QuantityType mvalue;
+        int mdirectioncount;
+
+        // serialization
+        friend class boost::serialization::access;
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            using boost::serialization::base_object;
+            ar & base_object<ScatteringFactorTableOwner>(*this);
+            ar & mqmin;
+            ar & mqmax;
+            ar & mqstep;
+            ar & mdebyeprecision;
+            ar & mvalue;
+            ar & mdirectioncount;
+        }
+
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // NUFFTDEBYECALCULATOR_HPP_INCLUDED
@@ -0,0 +1,374 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class NeighborListStructureAdapter -- StructureAdapter proxy that
+*     generates bonds of another StructureAdapter from a Verlet neighbor
+*     list, which is kept for subsequent frames of a trajectory.
+*
+* class NeighborListBondGenerator -- bond generator
+*
+*****************************************************************************/
+
+#include <stdexcept>
+#include <algorithm>
+
+#include <diffpy/serialization.ipp>
+#include <diffpy/validators.hpp>
+#include <diffpy/srreal/NeighborListStructureAdapter.hpp>
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
+#include <diffpy/srreal/MemoryUsage.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+using namespace diffpy::validators;
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// lattice vectors of a periodic structure or zero matrix otherwise
+const R3::Matrix& _latticeBase(const StructureAdapter& stru)
+{
+    const PeriodicStructureAdapter* pstru =
+        dynamic_cast<const PeriodicStructureAdapter*>(&stru);
+    return pstru ? pstru->getLattice().base() : R3::zeromatrix();
+}
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class NeighborListStructureAdapter
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructors --------------------------------------------------------------
+
+NeighborListStructureAdapter::NeighborListStructureAdapter() :
+    msrcstructure(emptyStructureAdapter()),
+    mskin(DEFAULT_NEIGHBORLIST_SKIN),
+    mbuildcount(0),
+    mlatticebase(R3::zeromatrix())
+{
+    this->invalidateNeighborList();
+}
+
+
+NeighborListStructureAdapter::NeighborListStructureAdapter(
+        StructureAdapterPtr srcstructure, double skin) :
+    msrcstructure(emptyStructureAdapter()),
+    mskin(DEFAULT_NEIGHBORLIST_SKIN),
+    mbuildcount(0),
+    mlatticebase(R3::zeromatrix())
+{
+    this->setSkin(skin);
+    this->invalidateNeighborList();
+    this->setFrame(srcstructure);
+}
+
+// Public Methods ------------------------------------------------------------
+
+StructureAdapterPtr NeighborListStructureAdapter::clone() const
+{
+    NeighborListStructureAdapterPtr rv(new NeighborListStructureAdapter);
+    rv->mskin = mskin;
+    rv->setFrame(msrcstructure->clone());
+    return rv;
+}
+
+
+BaseBondGeneratorPtr NeighborListStructureAdapter::createBondGenerator() const
+{
+    BaseBondGeneratorPtr bnds(
+            new NeighborListBondGenerator(shared_from_this()));
+    return bnds;
+}
+
+
+int NeighborListStructureAdapter::countSites() const
+{
+    return msrcstructure->countSites();
+}
+
+
+double NeighborListStructureAdapter::numberDensity() const
+{
+    return msrcstructure->numberDensity();
+}
+
+
+const string& NeighborListStructureAdapter::siteAtomType(int idx) const
+{
+    return msrcstructure->siteAtomType(idx);
+}
+
+
+const R3::Vector& NeighborListStructureAdapter::siteCartesianPosition(
+        int idx) const
+{
+    return msrcstructure->siteCartesianPosition(idx);
+}
+
+
+double NeighborListStructureAdapter::siteOccupancy(int idx) const
+{
+    return msrcstructure->siteOccupancy(idx);
+}
+
+
+bool NeighborListStructureAdapter::siteAnisotropy(int idx) const
+{
+    return msrcstructure->siteAnisotropy(idx);
+}
+
+
+const R3::Matrix&
+NeighborListStructureAdapter::siteCartesianUij(int idx) const
+{
+    return msrcstructure->siteCartesianUij(idx);
+}
+
+
+void NeighborListStructureAdapter::customPQConfig(PairQuantity* pq) const
+{
+    msrcstructure->customPQConfig(pq);
+}
+
+
+MemoryUsage NeighborListStructureAdapter::memoryUsage() const
+{
+    MemoryUsage rv = msrcstructure->memoryUsage();
+    rv.add("neighborlist", byteSize(mnbfirst) + byteSize(mnbsites) +
+            byteSize(mnbshifts) + byteSize(mreference));
+    return rv;
+}
+
+
+void NeighborListStructureAdapter::setFrame(StructureAdapterPtr frame)
+{
+    StructureAdapterPtr stru = frame.get() ? frame : emptyStructureAdapter();
+    const int cntsites = stru->countSites();
+    for (int i = 0; i < cntsites; ++i)
+    {
+        if (stru->siteMultiplicity(i) == 1)  continue;
+        const char* emsg = "Neighbor list requires structure "
+            "without symmetry expansion.";
+        throw invalid_argument(emsg);
+    }
+    msrcstructure = stru;
+    if (cntsites != int(mreference.size()) ||
+            _latticeBase(*stru) != mlatticebase)
+    {
+        this->invalidateNeighborList();
+        return;
+    }
+    // displacements are relative to the last build, not to the last frame
+    mmaxdisplacement = 0.0;
+    for (int i = 0; i < cntsites; ++i)
+    {
+        const R3::Vector& xyz = stru->siteCartesianPosition(i);
+        const double d = R3::distance(xyz, mreference[i]);
+        mmaxdisplacement = max(mmaxdisplacement, d);
+    }
+}
+
+
+StructureAdapterPtr NeighborListStructureAdapter::getSourceStructure()
+{
+    return msrcstructure;
+}
+
+
+StructureAdapterConstPtr
+NeighborListStructureAdapter::getSourceStructure() const
+{
+    return msrcstructure;
+}
+
+
+void NeighborListStructureAdapter::setSkin(double skin)
+{
+    ensureNonNegative("skin", skin);
+    if (skin != mskin)  this->invalidateNeighborList();
+    mskin = skin;
+}
+
+
+const double& NeighborListStructureAdapter::getSkin() const
+{
+    return mskin;
+}
+
+
+int NeighborListStructureAdapter::countNeighborListBuilds() const
+{
+    return mbuildcount;
+}
+
+
+const double& NeighborListStructureAdapter::getMaxDisplacement() const
+{
+    return mmaxdisplacement;
+}
+
+// Private Methods -----------------------------------------------------------
+
+void NeighborListStructureAdapter::invalidateNeighborList()
+{
+    mmaxdisplacement = 0.0;
+    mcutoff = -1.0;
+    mreference.clear();
+    mnbfirst.clear();
+    mnbsites.clear();
+    mnbshifts.clear();
+}
+
+
+void NeighborListStructureAdapter::updateNeighborList(double rmax) const
+{
+    // pairs within rmax cannot come from outside of the list cutoff
+    // unless their sites moved closer by more than 2 * mmaxdisplacement
+    if (rmax + 2 * mmaxdisplacement <= mcutoff)  return;
+    const double cutoff = rmax + mskin;
+    const int cntsites = msrcstructure->countSites();
+    mreference.resize(cntsites);
+    for (int i = 0; i < cntsites; ++i)
+    {
+        mreference[i] = msrcstructure->siteCartesianPosition(i);
+    }
+    mlatticebase = _latticeBase(*msrcstructure);
+    mnbfirst.assign(1, 0);
+    mnbsites.clear();
+    mnbshifts.clear();
+    BaseBondGeneratorPtr bnds = msrcstructure->createBondGenerator();
+    bnds->setRmin(0.0);
+    bnds->setRmax(cutoff);
+    for (int i0 = 0; i0 < cntsites; ++i0)
+    {
+        bnds->selectAnchorSite(i0);
+        bnds->selectSiteRange(0, cntsites);
+        for (bnds->rewind(); !bnds->finished(); bnds->next())
+        {
+            // periodic image offset relative to the unwrapped positions
+            const int i1 = bnds->site1();
+            R3::Vector shift = bnds->r01();
+            shift -= mreference[i1];
+            shift += mreference[i0];
+            mnbsites.push_back(i1);
+            mnbshifts.push_back(shift);
+        }
+        mnbfirst.push_back(mnbsites.size());
+    }
+    mcutoff = cutoff;
+    mmaxdisplacement = 0.0;
+    ++mbuildcount;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class NeighborListBondGenerator
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+NeighborListBondGenerator::NeighborListBondGenerator(
+        StructureAdapterConstPtr adpt) : BaseBondGenerator(adpt)
+{
+    mnlstructure =
+        dynamic_cast<const NeighborListStructureAdapter*>(adpt.get());
+    assert(mnlstructure);
+    mrangefirst = 0;
+    mrangelast = adpt->countSites();
+    mrangeselected = true;
+}
+
+// Public Methods ------------------------------------------------------------
+
+void NeighborListBondGenerator::rewind()
+{
+    const NeighborListStructureAdapter& nl = *mnlstructure;
+    nl.updateNeighborList(this->getRmax());
+    // iterate over the list entries of the anchor site
+    mneighborsites.clear();
+    mneighborentries.clear();
+    const int anchor = this->site0();
+    for (int e = nl.mnbfirst[anchor]; e < nl.mnbfirst[anchor + 1]; ++e)
+    {
+        const int i1 = nl.mnbsites[e];
+        if (!this->isRequestedSite(i1))  continue;
+        mneighborsites.push_back(i1);
+        mneighborentries.push_back(e);
+    }
+    msite_first = mneighborsites.begin();
+    msite_last = mneighborsites.end();
+    this->BaseBondGenerator::rewind();
+}
+
+
+void NeighborListBondGenerator::selectSiteRange(int first, int last)
+{
+    this->BaseBondGenerator::selectSiteRange(first, last);
+    mrangefirst = first;
+    mrangelast = last;
+    mrangeselected = true;
+}
+
+
+void NeighborListBondGenerator::selectSites(const SiteIndices& selection)
+{
+    this->BaseBondGenerator::selectSites(selection);
+    msortedselection.assign(msite_first, msite_last);
+    sort(msortedselection.begin(), msortedselection.end());
+    mrangeselected = false;
+}
+
+
+void NeighborListBondGenerator::selectSites(
+        SiteIndices::const_iterator first,
+        SiteIndices::const_iterator last)
+{
+    this->BaseBondGenerator::selectSites(first, last);
+    msortedselection.assign(first, last);
+    sort(msortedselection.begin(), msortedselection.end());
+    mrangeselected = false;
+}
+
+// Protected Methods ---------------------------------------------------------
+
+void NeighborListBondGenerator::rewindSymmetry()
+{
+    const int e = mneighborentries[msite_current - msite_first];
+    mr1 = mstructure->siteCartesianPosition(this->site1());
+    mr1 += mnlstructure->mnbshifts[e];
+    this->updateDistance();
+}
+
+// Private Methods -----------------------------------------------------------
+
+bool NeighborListBondGenerator::isRequestedSite(int idx) const
+{
+    if (mrangeselected)  return (mrangefirst <= idx && idx < mrangelast);
+    return binary_search(
+            msortedselection.begin(), msortedselection.end(), idx);
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+DIFFPY_INSTANTIATE_SERIALIZATION(diffpy::srreal::NeighborListStructureAdapter)
+BOOST_CLASS_EXPORT_IMPLEMENT(diffpy::srreal::NeighborListStructureAdapter)
+
+// End of file
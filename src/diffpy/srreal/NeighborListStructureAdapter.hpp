@@ -0,0 +1,175 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class NeighborListStructureAdapter -- StructureAdapter proxy that
+*     generates bonds of another StructureAdapter from a Verlet neighbor
+*     list, which is kept for subsequent frames of a trajectory.
+*
+* class NeighborListBondGenerator -- bond generator
+*
+* The neighbor list holds all pairs within rmax + skin together with
+* their periodic image offsets.  setFrame accepts the next configuration,
+* which may be the same adapter object with atoms moved in place.  The
+* list is reused until some atom moved by more than skin / 2 from its
+* position at the last build, the number of sites changed or the lattice
+* of a PeriodicStructureAdapter frame changed.  The source structure must
+* not have symmetry expansion, i.e., all its sites have multiplicity 1.
+*
+*****************************************************************************/
+
+#ifndef NEIGHBORLISTSTRUCTUREADAPTER_HPP_INCLUDED
+#define NEIGHBORLISTSTRUCTUREADAPTER_HPP_INCLUDED
+
+#include <boost/serialization/vector.hpp>
+
+#include <diffpy/srreal/StructureAdapter.hpp>
+#include <diffpy/srreal/BaseBondGenerator.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+/// default margin of the neighbor list for displacements between frames
+const double DEFAULT_NEIGHBORLIST_SKIN = 1.0;
+
+class NeighborListStructureAdapter : public StructureAdapter
+{
+    friend class NeighborListBondGenerator;
+
+    public:
+
+        // constructors
+        NeighborListStructureAdapter();
+        NeighborListStructureAdapter(StructureAdapterPtr, double skin);
+
+        // methods - overloaded
+        virtual StructureAdapterPtr clone() const;
+        virtual BaseBondGeneratorPtr createBondGenerator() const;
+        virtual int countSites() const;
+        virtual double numberDensity() const;
+        virtual const std::string& siteAtomType(int idx) const;
+        virtual const R3::Vector& siteCartesianPosition(int idx) const;
+        // reusing base-class StructureAdapter::siteMultiplicity()
+        virtual double siteOccupancy(int idx) const;
+        virtual bool siteAnisotropy(int idx) const;
+        virtual const R3::Matrix& siteCartesianUij(int idx) const;
+        virtual void customPQConfig(PairQuantity* pq) const;
+        virtual MemoryUsage memoryUsage() const;
+
+        // methods - own
+        /// use the next configuration of the trajectory
+        void setFrame(StructureAdapterPtr);
+        StructureAdapterPtr getSourceStructure();
+        StructureAdapterConstPtr getSourceStructure() const;
+        /// margin of the neighbor list for atom displacements
+        void setSkin(double);
+        const double& getSkin() const;
+        /// number of neighbor list constructions since the adapter creation
+        int countNeighborListBuilds() const;
+        /// largest displacement of a site from the last neighbor list build
+        const double& getMaxDisplacement() const;
+
+    private:
+
+        // data
+        StructureAdapterPtr msrcstructure;
+        double mskin;
+        // neighbor list, which is updated from the const bond generators
+        mutable double mmaxdisplacement;
+        mutable double mcutoff;
+        mutable int mbuildcount;
+        /// site positions and lattice vectors at the last build
+        mutable std::vector<R3::Vector> mreference;
+        mutable R3::Matrix mlatticebase;
+        /// neighbors of site i are entries mnbfirst[i] to mnbfirst[i + 1]
+        mutable std::vector<int> mnbfirst;
+        mutable SiteIndices mnbsites;
+        /// offsets of the neighbor images from the neighbor site positions
+        mutable std::vector<R3::Vector> mnbshifts;
+
+        // methods
+        void invalidateNeighborList();
+        void updateNeighborList(double rmax) const;
+
+        // serialization
+        friend class boost::serialization::access;
+        template<class Archive>
+            void serialize(Archive& ar, const unsigned int version)
+        {
+            ar & boost::serialization::base_object<StructureAdapter>(*this);
+            ar & msrcstructure;
+            ar & mskin;
+            ar & mmaxdisplacement;
+            ar & mcutoff;
+            ar & mbuildcount;
+            ar & mreference;
+            ar & mlatticebase;
+            ar & mnbfirst;
+            ar & mnbsites;
+            ar & mnbshifts;
+        }
+
+};
+
+typedef boost::shared_ptr<NeighborListStructureAdapter>
+    NeighborListStructureAdapterPtr;
+
+
+class NeighborListBondGenerator : public BaseBondGenerator
+{
+    public:
+
+        // constructors
+        NeighborListBondGenerator(StructureAdapterConstPtr);
+
+        // methods
+        // loop control
+        virtual void rewind();
+
+        // configuration
+        virtual void selectSiteRange(int first, int last);
+        virtual void selectSites(const SiteIndices&);
+        virtual void selectSites(
+                SiteIndices::const_iterator first,
+                SiteIndices::const_iterator last);
+
+    protected:
+
+        // methods
+        virtual void rewindSymmetry();
+
+    private:
+
+        // data
+        const NeighborListStructureAdapter* mnlstructure;
+        /// requested site range or sorted site selection
+        int mrangefirst;
+        int mrangelast;
+        bool mrangeselected;
+        SiteIndices msortedselection;
+        /// neighbors of the anchor site within the requested sites
+        SiteIndices mneighborsites;
+        std::vector<int> mneighborentries;
+
+        // methods
+        bool isRequestedSite(int) const;
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// Serialization -------------------------------------------------------------
+
+BOOST_CLASS_EXPORT_KEY(diffpy::srreal::NeighborListStructureAdapter)
+
+#endif  // NEIGHBORLISTSTRUCTUREADAPTER_HPP_INCLUDED
@@ -134,6 +134,12 @@ NoMetaStructureAdapter::diff(StructureAdapterConstPtr other) const
 }
 
 
+MemoryUsage NoMetaStructureAdapter::memoryUsage() const
+{
+    return msrcstructure->memoryUsage();
+}
+
+
 StructureAdapterPtr
 NoMetaStructureAdapter::getSourceStructure()
 {
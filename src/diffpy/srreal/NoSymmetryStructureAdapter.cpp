@@ -131,6 +131,12 @@ NoSymmetryStructureAdapter::diff(StructureAdapterConstPtr other) const
 }
 
 
+MemoryUsage NoSymmetryStructureAdapter::memoryUsage() const
+{
+    return msrcstructure->memoryUsage();
+}
+
+
 StructureAdapterPtr
 NoSymmetryStructureAdapter::getSourceStructure()
 {
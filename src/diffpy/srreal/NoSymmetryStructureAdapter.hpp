@@ -53,6 +53,7 @@ class NoSymmetryStructureAdapter : public StructureAdapter
         virtual const R3::Matrix& siteCartesianUij(int idx) const;
         virtual void customPQConfig(PairQuantity* pq) const;
         virtual StructureDifference diff(StructureAdapterConstPtr) const;
+        virtual MemoryUsage memoryUsage() const;
 
         // methods - own
         StructureAdapterPtr getSourceStructure();
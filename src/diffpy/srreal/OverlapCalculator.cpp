@@ -410,6 +410,43 @@ double OverlapCalculator::getRmaxUsed() const
     return rv;
 }
 
+// PairQuantity overloads
+
+MemoryUsage OverlapCalculator::memoryUsage() const
+{
+    MemoryUsage rv = this->PairQuantity::memoryUsage();
+    rv.add("siteradii", byteSize(mstructure_cache.siteradii));
+    size_t nbytes = byteSize(mneighborids);
+    NeighborIdsStorage::const_iterator nb = mneighborids.begin();
+    for (; nb != mneighborids.end(); ++nb)  nbytes += byteSize(nb->second);
+    rv.add("neighborids", nbytes);
+    return rv;
+}
+
+
+MemoryUsage
+OverlapCalculator::estimateMemoryUsage(StructureAdapterPtr stru) const
+{
+    MemoryUsage rv = this->PairQuantity::estimateMemoryUsage(stru);
+    if (!stru)  stru = emptyStructureAdapter();
+    const int cntsites = stru->countSites();
+    const AtomRadiiTablePtr& table = this->getAtomRadiiTable();
+    double maxradius = 0.0;
+    for (int i = 0; i < cntsites; ++i)
+    {
+        maxradius = max(maxradius, table->lookup(stru->siteAtomType(i)));
+    }
+    const double rmaxused = min(this->getRmax(), 2 * maxradius);
+    // the value array stores a chunk of data for every neighbor pair
+    const double npairs = cntsites *
+        estimateNeighborCount(stru, this->getRmin(), rmaxused);
+    rv.add("value", size_t(npairs * CHUNK_SIZE * sizeof(double)));
+    rv.add("siteradii", cntsites * sizeof(double));
+    // neighbor lists are only built when requested
+    rv.add("neighborids", size_t(npairs * (sizeof(int) + 2 * sizeof(void*))));
+    return rv;
+}
+
 // Protected Methods ---------------------------------------------------------
 
 void OverlapCalculator::resetValue()
@@ -455,6 +492,12 @@ void OverlapCalculator::executeParallelMerge(const std::string& pdata)
     mvalue.insert(mvalue.end(), pvalue.begin(), pvalue.end());
 }
 
+vector<QuantityType*> OverlapCalculator::getParallelSumArrays()
+{
+    // parallel values are concatenated rather than added
+    return vector<QuantityType*>();
+}
+
 // Private Methods -----------------------------------------------------------
 
 int OverlapCalculator::count() const
@@ -491,7 +534,7 @@ const double& OverlapCalculator::subvalue(int offset, int index) const
 
 const R3::Vector& OverlapCalculator::subdirection(int index) const
 {
-    static R3::Vector rv;
+    thread_local R3::Vector rv;
     rv[0] = this->subvalue(DIRECTION0_OFFSET, index);
     rv[1] = this->subvalue(DIRECTION1_OFFSET, index);
     rv[2] = this->subvalue(DIRECTION2_OFFSET, index);
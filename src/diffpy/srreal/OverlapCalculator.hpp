@@ -82,6 +82,10 @@ class OverlapCalculator : public PairQuantity
         /// effective rmax value, usually a double of the maximum atom radius.
         double getRmaxUsed() const;
 
+        // PairQuantity overloads
+        virtual MemoryUsage memoryUsage() const;
+        virtual MemoryUsage estimateMemoryUsage(StructureAdapterPtr) const;
+
 
     protected:
 
@@ -90,6 +94,7 @@ class OverlapCalculator : public PairQuantity
         virtual void configureBondGenerator(BaseBondGenerator&) const;
         virtual void addPairContribution(const BaseBondGenerator&, int);
         virtual void executeParallelMerge(const std::string&);
+        virtual std::vector<QuantityType*> getParallelSumArrays();
 
     private:
 
@@ -19,13 +19,26 @@
 #include <stdexcept>
 #include <sstream>
 #include <cmath>
+#include <algorithm>
+#include <functional>
 #include <cassert>
+#include <climits>
+#include <typeinfo>
+#include <thread>
+#include <exception>
 
 #include <diffpy/serialization.ipp>
 #include <diffpy/srreal/PDFCalculator.hpp>
 #include <diffpy/srreal/StructureAdapter.hpp>
+#include <diffpy/srreal/StructureDifference.hpp>
 #include <diffpy/srreal/R3linalg.hpp>
 #include <diffpy/srreal/PDFUtils.hpp>
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
+#include <diffpy/srreal/ScatteringDensityGrid.hpp>
+#include <diffpy/srreal/GaussianProfile.hpp>
+#include <diffpy/srreal/ConstantPeakWidth.hpp>
+#include <diffpy/srreal/JeongPeakWidth.hpp>
+#include <diffpy/srreal/SIMDKernels.hpp>
 #include <diffpy/mathutils.hpp>
 #include <diffpy/validators.hpp>
 
@@ -52,6 +65,123 @@ bool _initialQstepUpdate(const PDFC* pc)
     return rv;
 }
 
+
+/// Copy array src to dst shifted left by leftshift points.
+void _copyShifted(const double* src, int nsrc,
+        double* dst, int ndst, int leftshift)
+{
+    if (leftshift >= 0)
+    {
+        const int n = min(leftshift, nsrc);
+        src += n;
+        nsrc -= n;
+    }
+    else
+    {
+        const int n = min(-leftshift, ndst);
+        dst += n;
+        ndst -= n;
+    }
+    copy(src, src + min(nsrc, ndst), dst);
+}
+
+
+/// Add array src scaled by sc to dst shifted left by leftshift points.
+void _addShifted(const double* src, int nsrc, double sc,
+        double* dst, int ndst, int leftshift)
+{
+    if (leftshift >= 0)
+    {
+        const int n = min(leftshift, nsrc);
+        src += n;
+        nsrc -= n;
+    }
+    else
+    {
+        const int n = min(-leftshift, ndst);
+        dst += n;
+        ndst -= n;
+    }
+    for (int i = 0; i < min(nsrc, ndst); ++i)  dst[i] += sc * src[i];
+}
+
+
+/// Copy rows of nsrc points from src to rows of ndst points in dst.
+void _copyShiftedRows(const QuantityType& src, int nsrc,
+        QuantityType& dst, int ndst, int leftshift)
+{
+    if (!nsrc || !ndst)  return;
+    const int nrows = min(src.size() / nsrc, dst.size() / ndst);
+    for (int k = 0; k < nrows; ++k)
+    {
+        _copyShifted(src.data() + k * nsrc, nsrc,
+                dst.data() + k * ndst, ndst, leftshift);
+    }
+}
+
+
+/// Bond generator that presents a single bond from the PDFCalculator
+/// bond table to the peak width models.
+class CachedBondGenerator : public BaseBondGenerator
+{
+    public:
+
+        // constructor
+        CachedBondGenerator(StructureAdapterConstPtr stru) :
+            BaseBondGenerator(stru), msite1(1, 0), mmsd(0.0)
+        { }
+
+        // methods
+        void setBond(int i0, int i1, double dist, double msdval)
+        {
+            msite_anchor = i0;
+            msite1[0] = i1;
+            msite_current = msite1.begin();
+            mdistance = dist;
+            mmsd = msdval;
+        }
+
+        virtual double msd() const
+        {
+            return mmsd;
+        }
+
+    private:
+
+        // data
+        SiteIndices msite1;
+        double mmsd;
+};
+
+
+/// Assign double attributes from the name-value map.
+void _setDoubleAttrs(diffpy::Attributes& obj,
+        const PDFCalculator::AttributeSettings& attrs)
+{
+    PDFCalculator::AttributeSettings::const_iterator kv = attrs.begin();
+    for (; kv != attrs.end(); ++kv)  obj.setDoubleAttr(kv->first, kv->second);
+}
+
+
+/// True for the plain Gaussian profile added by the vectorized kernels.
+bool _usesGaussianKernel(const PeakProfile& pkf)
+{
+    return typeid(pkf) == typeid(GaussianProfile) && !pkf.getTabulated();
+}
+
+
+/// Peak shape and calculated grid for one setting of a parameter sweep.
+struct SweepGrid
+{
+    PeakWidthModelPtr pwm;
+    PeakProfilePtr pkf;
+    double rlo;
+    double rhi;
+    int rlosteps;
+    int npts;
+    QuantityType rdf;
+};
+
 }   // namespace
 
 // Constructor ---------------------------------------------------------------
@@ -60,8 +190,28 @@ PDFCalculator::PDFCalculator() :
     mqmin(0.0),
     mqmax(DOUBLE_MAX),
     mrstep(DEFAULT_PDFCALCULATOR_RSTEP),
-    mmaxextension(DEFAULT_PDFCALCULATOR_MAXEXTENSION)
+    mmaxextension(DEFAULT_PDFCALCULATOR_MAXEXTENSION),
+    mbondcaching(false),
+    moccupancypartials(false),
+    mpositiongradients(false),
+    mfftgridstep(0.0),
+    mfftsplitdistance(DEFAULT_PDFCALCULATOR_FFTSPLITDISTANCE),
+    mmixedprecision(false)
 {
+    mresidual.dirtylo = 0;
+    mresidual.dirtyhi = INT_MAX;
+    mresidual.stashlo = 0;
+    mresidual.stashhi = INT_MAX;
+    mbondcache.recording = false;
+    mbondcache.valid = false;
+    mbondcache.replaying = false;
+    mbondcache.rmin = 0.0;
+    mbondcache.rmax = 0.0;
+    mpartials.recording = false;
+    mpartials.valid = false;
+    mfftgrid.hlosteps = 0;
+    mfftgrid.rmin = 0.0;
+    mfftgrid.rmax = 0.0;
     // default configuration
     mrmax = DEFAULT_PDFCALCULATOR_RMAX;
     this->setPeakWidthModelByType("jeong");
@@ -96,6 +246,11 @@ PDFCalculator::PDFCalculator() :
             &PDFCalculator::getExtendedRmin);
     this->registerDoubleAttribute("extendedrmax", this,
             &PDFCalculator::getExtendedRmax);
+    this->registerDoubleAttribute("fftgridstep", this,
+            &PDFCalculator::getFFTGridStep, &PDFCalculator::setFFTGridStep);
+    this->registerDoubleAttribute("fftsplitdistance", this,
+            &PDFCalculator::getFFTSplitDistance,
+            &PDFCalculator::setFFTSplitDistance);
 }
 
 // Public Methods ------------------------------------------------------------
@@ -106,13 +261,91 @@ eventticker::EventTicker& PDFCalculator::ticker() const
 {
     eventticker::EventTicker& tic = this->PairQuantity::ticker();
     assert(&mticker == &tic);
+    // clicks after the last merge come from own configuration changes
+    if (mmergedticker < tic)  mconfigticker = tic;
     tic.updateFrom(this->PeakWidthModelOwner::ticker());
     tic.updateFrom(this->ScatteringFactorTableOwner::ticker());
     const PeakProfilePtr& pkpf = this->getPeakProfile();
     if (pkpf)  tic.updateFrom(pkpf->ticker());
+    mmergedticker = tic;
     return tic;
 }
 
+
+string PDFCalculator::getParallelData() const
+{
+    ostringstream storage(ios::binary);
+    diffpy::serialization::oarchive oa(storage, ios::binary);
+    oa << this->value() << mgradients.positions << mgradients.parameters;
+    return storage.str();
+}
+
+
+MemoryUsage PDFCalculator::memoryUsage() const
+{
+    MemoryUsage rv = this->PairQuantity::memoryUsage();
+    rv.add("sfsite", byteSize(mstructure_cache.sfsite));
+    rv.add("stash", byteSize(mstashedvalue.value));
+    rv.add("stash", byteSize(mstashedvalue.positions));
+    rv.add("stash", byteSize(mstashedvalue.parameters));
+    rv.add("bondcache", byteSize(mbondcache.bonds));
+    rv.add("partials", byteSize(mpartials.values));
+    rv.add("gradients", byteSize(mgradients.positions));
+    rv.add("gradients", byteSize(mgradients.parameters));
+    if (mfftgrid.grid)  rv.add("fftgrid", mfftgrid.grid->memoryUsage());
+    rv.add("fftgrid", byteSize(mfftgrid.histogram));
+    rv.add("floatsums", mfloatsums.memoryUsage());
+    return rv;
+}
+
+
+MemoryUsage PDFCalculator::estimateMemoryUsage(StructureAdapterPtr stru) const
+{
+    MemoryUsage rv = this->PairQuantity::estimateMemoryUsage(stru);
+    if (!stru)  stru = emptyStructureAdapter();
+    // upper bound of the calculated r-grid for the maximum extension
+    const double& dr = this->getRstep();
+    const double& ext = this->getMaxExtension();
+    const int nlo = max(0, pdfutils_rminSteps(this->getRmin() - ext, dr));
+    const int nhi = pdfutils_rmaxSteps(this->getRmax() + ext, dr);
+    const size_t npts = max(0, nhi - nlo);
+    size_t nrows = 1 + this->getParameterGradients().size();
+    if (this->getPositionGradients())  nrows += R3::Ndim * stru->countSites();
+    rv.add("value", npts * sizeof(double));
+    rv.add("gradients", (nrows - 1) * npts * sizeof(double));
+    if (this->getEvaluatorType() != BASIC)
+    {
+        rv.add("stash", nrows * npts * sizeof(double));
+    }
+    rv.add("sfsite", stru->countSites() * sizeof(double));
+    if (this->getBondCaching())
+    {
+        // the table holds each pair once for the half summation
+        const double nbonds = 0.5 * stru->countSites() * estimateNeighborCount(
+                stru, max(0.0, this->getRmin() - ext), this->getRmax() + ext);
+        rv.add("bondcache", size_t(nbonds) * sizeof(CachedBond));
+    }
+    if (this->getOccupancyPartials())
+    {
+        const size_t n = stru->countSites();
+        rv.add("partials", n * (n + 1) / 2 * npts * sizeof(double));
+    }
+    const PeriodicStructureAdapter* pstru =
+        dynamic_cast<const PeriodicStructureAdapter*>(stru.get());
+    if (mfftgridstep > 0.0 && pstru)
+    {
+        // complex grid values and the distance histogram
+        const size_t ngrid = ScatteringDensityGrid::countPoints(
+                pstru->getLattice(), mfftgridstep);
+        rv.add("fftgrid", (2 * ngrid + npts) * sizeof(double));
+    }
+    // getPDF holds the zero-padded F(Q) while fftftog uses a complex
+    // work array of 4 times the padded length and its results
+    const size_t npad = (nhi > 0) ? (size_t(1) << int(ceil(log2(nhi)))) : 0;
+    rv.add("transient", (6 * npad + 2 * npts) * sizeof(double));
+    return rv;
+}
+
 // results
 
 QuantityType PDFCalculator::getPDF() const
@@ -143,96 +376,32 @@ QuantityType PDFCalculator::getF() const
 {
     QuantityType f_ext = this->getExtendedF();
     assert(pdfutils_qmaxSteps(this) <= int(f_ext.size()));
-    QuantityType rv(f_ext.begin(), f_ext.begin() + pdfutils_qmaxSteps(this));
-    return rv;
+    f_ext.resize(pdfutils_qmaxSteps(this));
+    return f_ext;
 }
 
 
 QuantityType PDFCalculator::getExtendedPDF() const
 {
-    QuantityType rgrid_ext = this->getExtendedRgrid();
-    // Skip FFT when qmax is not specified and qmin does not exclude the
-    // the F(Q=Qstep) point (excluding F(0) == 0 makes no difference to G).
-    const bool skipfft =
-        !eps_lt(this->getQmax(), M_PI / this->getRstep()) &&
-        !(1 < pdfutils_qminSteps(this));
-    if (skipfft)
-    {
-        QuantityType rdfpr = this->getExtendedRDFperR();
-        QuantityType rdfprb = this->applyBaseline(rgrid_ext, rdfpr);
-        QuantityType pdf = this->applyEnvelopes(rgrid_ext, rdfprb);
-        return pdf;
-    }
-    // FFT required here
-    // we need a full range PDF to apply termination ripples correctly
-    QuantityType f_ext = this->getExtendedF();
-    // zero all F points at Q < Qmin
-    QuantityType::iterator ii_qmin =
-        f_ext.begin() + min(pdfutils_qminSteps(this), int(f_ext.size()));
-    fill(f_ext.begin(), ii_qmin, 0.0);
-    // zero all F points at Q >= Qmax
-    assert(pdfutils_qmaxSteps(this) <= int(f_ext.size()));
-    QuantityType::iterator ii_qmax = f_ext.begin() + pdfutils_qmaxSteps(this);
-    fill(ii_qmax, f_ext.end(), 0.0);
-    QuantityType pdf1 = fftftog(f_ext, this->getQstep());
-    // cut away the FFT padded points
-    assert(this->extendedRmaxSteps() <= int(pdf1.size()));
-    pdf1.erase(pdf1.begin() + this->extendedRmaxSteps(), pdf1.end());
-    pdf1.erase(pdf1.begin(), pdf1.begin() + this->extendedRminSteps());
-    QuantityType pdf2 = this->applyEnvelopes(rgrid_ext, pdf1);
-    return pdf2;
+    return this->extendedPDF(mvalue.data(), true);
 }
 
 
 QuantityType PDFCalculator::getExtendedRDF() const
 {
-    QuantityType rdf(this->countExtendedPoints());
-    const double& totocc = mstructure_cache.totaloccupancy;
-    double sfavg = this->sfAverage();
-    double rdf_scale = (totocc * sfavg == 0.0) ? 0.0 :
-        1.0 / (totocc * sfavg * sfavg);
-    QuantityType::iterator iirdf = rdf.begin();
-    QuantityType::const_iterator iival, iival_last;
-    iival = this->value().begin() +
-        this->extendedRminSteps() - this->rcalcloSteps();
-    iival_last = this->value().begin() +
-        this->extendedRmaxSteps() - this->rcalcloSteps();
-    assert(iival >= this->value().begin());
-    assert(iival_last <= this->value().end());
-    assert(rdf.size() == size_t(iival_last - iival));
-    for (; iirdf != rdf.end(); ++iival, ++iirdf)
-    {
-        *iirdf = *iival * rdf_scale;
-    }
-    return rdf;
+    return this->extendedRDF(mvalue.data());
 }
 
 
 QuantityType PDFCalculator::getExtendedRDFperR() const
 {
-    QuantityType rdf_ext = this->getExtendedRDF();
-    QuantityType rgrid_ext = this->getExtendedRgrid();
-    assert(rdf_ext.size() == rgrid_ext.size());
-    QuantityType::const_iterator ri = rgrid_ext.begin();
-    QuantityType::iterator rdfi = rdf_ext.begin();
-    for (; ri != rgrid_ext.end(); ++ri, ++rdfi)
-    {
-        *rdfi = eps_gt(*ri, 0) ? (*rdfi / *ri) : 0.0;
-    }
-    return rdf_ext;
+    return this->extendedRDFperR(mvalue.data());
 }
 
 
 QuantityType PDFCalculator::getExtendedF() const
 {
-    QuantityType rdfperr_ext = this->getExtendedRDFperR();
-    QuantityType rgrid_ext = this->getExtendedRgrid();
-    QuantityType rdfperr_ext1 = this->applyBaseline(rgrid_ext, rdfperr_ext);
-    const double rmin_ext = this->getExtendedRmin();
-    QuantityType rv = fftgtof(rdfperr_ext1, this->getRstep(), rmin_ext);
-    assert(rv.empty() || eps_eq(M_PI,
-                this->getQstep() * rv.size() * this->getRstep()));
-    return rv;
+    return this->extendedF(mvalue.data(), true);
 }
 
 
@@ -250,6 +419,447 @@ QuantityType PDFCalculator::getExtendedRgrid() const
     return rv;
 }
 
+// derivatives with respect to site positions
+
+void PDFCalculator::setPositionGradients(bool flag)
+{
+    if (mpositiongradients == flag)  return;
+    mpositiongradients = flag;
+    mticker.click();
+    QuantityType().swap(mgradients.positions);
+}
+
+
+bool PDFCalculator::getPositionGradients() const
+{
+    return mpositiongradients;
+}
+
+
+vector<QuantityType> PDFCalculator::getPDFPositionJacobian() const
+{
+    const int npts = this->countCalcPoints();
+    const size_t nrows = R3::Ndim * this->countSites();
+    if (!mpositiongradients || mgradients.positions.size() != nrows * npts)
+    {
+        const char* emsg = "Position gradients were not evaluated.  "
+            "Call setPositionGradients(true) and evaluate the PDF.";
+        throw logic_error(emsg);
+    }
+    vector<QuantityType> rv;
+    rv.reserve(nrows);
+    const double* row = mgradients.positions.data();
+    for (size_t k = 0; k < nrows; ++k, row += npts)
+    {
+        // the baseline does not depend on site positions
+        rv.push_back(this->extendedPDF(row, false));
+        this->cutRipplePoints(rv.back());
+    }
+    return rv;
+}
+
+// derivatives with respect to width and displacement parameters
+
+void PDFCalculator::setParameterGradients(const vector<string>& names)
+{
+    if (mparametergradients == names)  return;
+    ParameterGradients::checkNames(names);
+    mparametergradients = names;
+    mticker.click();
+    QuantityType().swap(mgradients.parameters);
+}
+
+
+const vector<string>& PDFCalculator::getParameterGradients() const
+{
+    return mparametergradients;
+}
+
+
+QuantityType PDFCalculator::getPDFDerivative(const string& name) const
+{
+    const vector<string>& names = mparametergradients;
+    vector<string>::const_iterator nm =
+        find(names.begin(), names.end(), name);
+    if (nm == names.end())
+    {
+        string emsg = "Parameter '" + name +
+            "' is not included in getParameterGradients().";
+        throw invalid_argument(emsg);
+    }
+    const size_t npts = this->countCalcPoints();
+    if (mgradients.parameters.size() != names.size() * npts)
+    {
+        const char* emsg = "Parameter gradients were not evaluated.  "
+            "Call setParameterGradients() and evaluate the PDF.";
+        throw logic_error(emsg);
+    }
+    const double* row =
+        mgradients.parameters.data() + (nm - names.begin()) * npts;
+    // baseline does not depend on peak widths
+    QuantityType rv = this->extendedPDF(row, false);
+    this->cutRipplePoints(rv);
+    return rv;
+}
+
+// comparison with observed data
+
+void PDFCalculator::setObservedPDF(
+        const QuantityType& gobs, const QuantityType& weights)
+{
+    mresidual.fit.setObserved(gobs, weights);
+    mresidual.signature.clear();
+}
+
+
+const QuantityType& PDFCalculator::getObservedPDF() const
+{
+    return mresidual.fit.getObserved();
+}
+
+
+QuantityType PDFCalculator::getResidual() const
+{
+    this->updateResidual();
+    return mresidual.fit.residual();
+}
+
+
+double PDFCalculator::getChiSquared() const
+{
+    this->updateResidual();
+    return mresidual.fit.chiSquared();
+}
+
+
+double PDFCalculator::getRw() const
+{
+    this->updateResidual();
+    return mresidual.fit.rw();
+}
+
+// parameter sweeps
+
+vector<QuantityType> PDFCalculator::sweepPDF(StructureAdapterPtr stru,
+        const vector<AttributeSettings>& settings, int ncpu)
+{
+    if (ncpu < 1)
+    {
+        const char* emsg = "Number of CPU ncpu must be at least 1.";
+        throw invalid_argument(emsg);
+    }
+    if (mfftgridstep > 0.0)
+    {
+        const char* emsg = "Parameter sweep does not support the FFT grid.";
+        throw invalid_argument(emsg);
+    }
+    vector<QuantityType> rv;
+    if (settings.empty())  return rv;
+    // original values of all swept attributes.  This also verifies
+    // the attribute names.
+    AttributeSettings original;
+    vector<AttributeSettings>::const_iterator st = settings.begin();
+    for (; st != settings.end(); ++st)
+    {
+        AttributeSettings::const_iterator kv = st->begin();
+        for (; kv != st->end(); ++kv)
+        {
+            original[kv->first] = this->getDoubleAttr(kv->first);
+        }
+    }
+    const int nst = settings.size();
+    const double dr = this->getRstep();
+    vector<SweepGrid> grids(nst);
+    try {
+        // collect peak shapes and r-grids for every setting
+        for (int k = 0; k < nst; ++k)
+        {
+            _setDoubleAttrs(*this, settings[k]);
+            if (!eps_eq(dr, this->getRstep()))
+            {
+                const char* emsg = "Parameter sweep cannot change rstep.";
+                throw invalid_argument(emsg);
+            }
+            this->setStructure(stru);
+            SweepGrid& g = grids[k];
+            g.pwm = this->getPeakWidthModel()->clone();
+            g.pkf = this->getPeakProfile()->clone();
+            g.rlo = this->rcalclo();
+            g.rhi = this->rcalchi();
+            g.rlosteps = this->rcalcloSteps();
+            g.npts = this->countCalcPoints();
+            g.rdf.assign(g.npts, 0.0);
+            _setDoubleAttrs(*this, original);
+        }
+        // one pass over the bonds that reach any of the r-grids.  Store
+        // the distance, scale and peak widths for all settings.
+        this->setStructure(stru);
+        double rmin = grids[0].rlo;
+        double rmax = grids[0].rhi;
+        for (int k = 1; k < nst; ++k)
+        {
+            rmin = min(rmin, grids[k].rlo);
+            rmax = max(rmax, grids[k].rhi);
+        }
+        vector<double> distances, peakscales, fwhms;
+        BaseBondGeneratorPtr bnds = mstructure->createBondGenerator();
+        bnds->setRmin(rmin);
+        bnds->setRmax(rmax);
+        const int cntsites = this->countSites();
+        const bool hasmask = this->hasMask();
+        for (int i0 = 0; i0 < cntsites; ++i0)
+        {
+            bnds->selectAnchorSite(i0);
+            bnds->selectSiteRange(0, i0 + 1);
+            for (bnds->rewind(); !bnds->finished(); bnds->next())
+            {
+                const int i1 = bnds->site1();
+                if (hasmask && !this->getPairMask(i0, i1))  continue;
+                const int pairscale =
+                    bnds->multiplicity() * ((i0 == i1) ? 1 : 2);
+                const double sfprod = this->sfSite(i0) * this->sfSite(i1);
+                distances.push_back(bnds->distance());
+                peakscales.push_back(sfprod * pairscale);
+                for (int k = 0; k < nst; ++k)
+                {
+                    fwhms.push_back(grids[k].pwm->calculate(*bnds));
+                }
+            }
+        }
+        // render the peaks of independent settings in parallel
+        const int nbonds = distances.size();
+        const int nthreads = min(ncpu, nst);
+        vector<exception_ptr> errors(nthreads);
+        auto render = [&](int cpuindex) {
+            try {
+                for (int k = cpuindex; k < nst; k += nthreads)
+                {
+                    SweepGrid& g = grids[k];
+                    for (int b = 0; b < nbonds; ++b)
+                    {
+                        const double& dist = distances[b];
+                        if (dist < g.rlo || dist > g.rhi)  continue;
+                        this->addPeak(*g.pkf, g.rdf.data(),
+                                g.rlosteps, g.npts, dist,
+                                fwhms[size_t(b) * nst + k], peakscales[b]);
+                    }
+                }
+            }
+            catch (...) {
+                errors[cpuindex] = current_exception();
+            }
+        };
+        vector<thread> workers;
+        for (int cpuindex = 1; cpuindex < nthreads; ++cpuindex)
+        {
+            workers.push_back(thread(render, cpuindex));
+        }
+        render(0);
+        for (auto&& w : workers)  w.join();
+        for (auto&& e : errors)
+        {
+            if (e)  rethrow_exception(e);
+        }
+        // apply the termination ripples, envelopes and baseline
+        for (int k = 0; k < nst; ++k)
+        {
+            _setDoubleAttrs(*this, settings[k]);
+            this->setStructure(stru);
+            assert(int(mvalue.size()) == grids[k].npts);
+            copy(grids[k].rdf.begin(), grids[k].rdf.end(), mvalue.begin());
+            rv.push_back(this->getPDF());
+            _setDoubleAttrs(*this, original);
+        }
+    }
+    catch (...) {
+        _setDoubleAttrs(*this, original);
+        this->setStructure(stru);
+        throw;
+    }
+    // the calculator value does not correspond to any of the settings
+    this->setStructure(stru);
+    mticker.click();
+    return rv;
+}
+
+// evaluation at arbitrary points
+
+QuantityType PDFCalculator::evalPDFAtPoints(StructureAdapterPtr stru,
+        const QuantityType& rpoints)
+{
+    if (eps_lt(this->getQmax(), M_PI / this->getRstep()) ||
+            1 < pdfutils_qminSteps(this))
+    {
+        const char* emsg = "Evaluation at r-points requires Qmax >= "
+            "pi / rstep and Qmin that does not exclude F(Q=Qstep).";
+        throw invalid_argument(emsg);
+    }
+    if (mfftgridstep > 0.0)
+    {
+        const char* emsg = "Evaluation at r-points does not support "
+            "the FFT grid.";
+        throw invalid_argument(emsg);
+    }
+    if (!is_sorted(rpoints.begin(), rpoints.end()) ||
+            (!rpoints.empty() && rpoints.front() < 0.0))
+    {
+        const char* emsg = "The r-points must be sorted and non-negative.";
+        throw invalid_argument(emsg);
+    }
+    this->setStructure(stru);
+    QuantityType rdf(rpoints.size(), 0.0);
+    const PeakProfile& pkf = *(this->getPeakProfile());
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    PeakProfileTablePtr tbl;
+    if (pkf.getTabulated())  tbl = pkf.table();
+    if (!rpoints.empty())
+    {
+        // bonds that have peaks at the r-points
+        const double rlo = rpoints.front();
+        const double rhi = rpoints.back();
+        const double maxfwhm = pwm.maxWidth(mstructure, rlo, rhi);
+        const double ext =
+            max(fabs(pkf.xboundlo(maxfwhm)), fabs(pkf.xboundhi(maxfwhm)));
+        BaseBondGeneratorPtr bnds = mstructure->createBondGenerator();
+        bnds->setRmin(max(0.0, rlo - ext));
+        bnds->setRmax(rhi + ext);
+        const int cntsites = this->countSites();
+        const bool hasmask = this->hasMask();
+        for (int i0 = 0; i0 < cntsites; ++i0)
+        {
+            bnds->selectAnchorSite(i0);
+            bnds->selectSiteRange(0, i0 + 1);
+            for (bnds->rewind(); !bnds->finished(); bnds->next())
+            {
+                const int i1 = bnds->site1();
+                if (hasmask && !this->getPairMask(i0, i1))  continue;
+                const double& dist = bnds->distance();
+                const double fwhm = pwm.calculate(*bnds);
+                if (fwhm <= 0 || !eps_gt(dist, 0.0))  continue;
+                const int pairscale =
+                    bnds->multiplicity() * ((i0 == i1) ? 1 : 2);
+                const double peakscale =
+                    this->sfSite(i0) * this->sfSite(i1) * pairscale;
+                QuantityType::const_iterator ri = lower_bound(
+                        rpoints.begin(), rpoints.end(),
+                        dist + pkf.xboundlo(fwhm));
+                QuantityType::const_iterator rlast = upper_bound(
+                        ri, rpoints.end(), dist + pkf.xboundhi(fwhm));
+                double* y = rdf.data() + (ri - rpoints.begin());
+                for (; ri != rlast; ++ri, ++y)
+                {
+                    // peak in RDF is normalized by the pair distance
+                    const double x = *ri - dist;
+                    const double yp = tbl ? (*tbl)(x, fwhm) : pkf(x, fwhm);
+                    *y += peakscale * yp * (x / dist + 1);
+                }
+            }
+        }
+    }
+    // convert to PDF as in extendedPDF without the FFT
+    const double rdf_scale = this->rdfScale();
+    QuantityType::const_iterator ri = rpoints.begin();
+    QuantityType::iterator yi = rdf.begin();
+    for (; yi != rdf.end(); ++ri, ++yi)
+    {
+        *yi = eps_gt(*ri, 0) ? (*yi * rdf_scale / *ri) : 0.0;
+    }
+    QuantityType pdf = this->applyBaseline(rpoints, rdf);
+    pdf = this->applyEnvelopes(rpoints, pdf);
+    // the calculator value is not for the r-grid
+    mticker.click();
+    return pdf;
+}
+
+// ensemble averages
+
+const QuantityType& PDFCalculator::evalEnsemble(
+        const vector<StructureAdapterPtr>& ensemble, int ncpu)
+{
+    if (ncpu < 1)
+    {
+        const char* emsg = "Number of CPU ncpu must be at least 1.";
+        throw invalid_argument(emsg);
+    }
+    if (ensemble.empty())
+    {
+        const char* emsg = "Ensemble must contain at least one structure.";
+        throw invalid_argument(emsg);
+    }
+    if (mpositiongradients || !mparametergradients.empty())
+    {
+        const char* emsg = "Ensemble average does not support derivatives.";
+        throw invalid_argument(emsg);
+    }
+    // post-processing uses the r-grid and normalization of the first
+    // structure.  Other configurations are rescaled to its RDF scale.
+    this->setStructure(ensemble[0]);
+    const int nst = ensemble.size();
+    const int nthreads = min(ncpu, nst);
+    const int npts = mvalue.size();
+    const double rdfscale0 = this->rdfScale();
+    // calculator copies for the worker threads without the caches
+    const string pcdata = serialization_tostring(*this);
+    vector<PDFCalculator> workers(nthreads);
+    for (auto&& pc : workers)
+    {
+        serialization_fromstring(pc, pcdata);
+        pc.setEvaluatorType(BASIC);
+        pc.setBondCaching(false);
+        pc.setOccupancyPartials(false);
+    }
+    vector<QuantityType> sums(nthreads, QuantityType(npts, 0.0));
+    vector<double> slopes(nthreads, 0.0);
+    vector<exception_ptr> errors(nthreads);
+    auto accumulate = [&](int cpuindex) {
+        try {
+            PDFCalculator& pc = workers[cpuindex];
+            for (int k = cpuindex; k < nst; k += nthreads)
+            {
+                pc.eval(ensemble[k]);
+                const double sc = (rdfscale0 == 0.0) ? 0.0 :
+                    (pc.rdfScale() / rdfscale0);
+                const int leftshift =
+                    this->rcalcloSteps() - pc.rcalcloSteps();
+                _addShifted(pc.mvalue.data(), pc.mvalue.size(), sc,
+                        sums[cpuindex].data(), npts, leftshift);
+                slopes[cpuindex] += pc.linearBaselineSlope();
+            }
+        }
+        catch (...) {
+            errors[cpuindex] = current_exception();
+        }
+    };
+    vector<thread> threads;
+    for (int cpuindex = 1; cpuindex < nthreads; ++cpuindex)
+    {
+        threads.push_back(thread(accumulate, cpuindex));
+    }
+    accumulate(0);
+    for (auto&& t : threads)  t.join();
+    for (auto&& e : errors)
+    {
+        if (e)  rethrow_exception(e);
+    }
+    // average the raw values and the linear baseline
+    fill(mvalue.begin(), mvalue.end(), 0.0);
+    for (auto&& s : sums)
+    {
+        transform(mvalue.begin(), mvalue.end(), s.begin(),
+                mvalue.begin(), plus<double>());
+    }
+    for (auto&& y : mvalue)  y /= nst;
+    if (this->getBaseline()->type() == "linear")
+    {
+        double slope = 0.0;
+        for (auto&& s : slopes)  slope += s;
+        this->getBaseline()->setDoubleAttr("slope", slope / nst);
+    }
+    // the value does not correspond to any configuration
+    mticker.click();
+    return this->value();
+}
+
 // Q-range methods
 
 QuantityType PDFCalculator::getQgrid() const
@@ -284,7 +894,7 @@ void PDFCalculator::setQmax(double qmax)
 
 const double& PDFCalculator::getQmax() const
 {
-    static double rv;
+    thread_local double rv;
     rv = min(mqmax, M_PI / this->getRstep());
     return rv;
 }
@@ -292,7 +902,7 @@ const double& PDFCalculator::getQmax() const
 
 const double& PDFCalculator::getQstep() const
 {
-    static double rv;
+    thread_local double rv;
     // replicate the zero padding as done in fftgtof
     int Npad1 = this->extendedRmaxSteps();
     int Npad2 = (Npad1 > 0) ? (1 << int(ceil(log2(Npad1)))) : 0;
@@ -400,27 +1010,110 @@ const PeakProfilePtr& PDFCalculator::getPeakProfile() const
     return mpeakprofile;
 }
 
-// PDF baseline methods
+// bond caching
 
-QuantityType PDFCalculator::applyBaseline(
-        const QuantityType& x, const QuantityType& y) const
+void PDFCalculator::setBondCaching(bool flag)
 {
-    assert(x.size() == y.size());
-    QuantityType z = y;
-    const PDFBaseline& baseline = *(this->getBaseline());
-    QuantityType::const_iterator xi = x.begin();
-    QuantityType::iterator zi = z.begin();
-    for (; xi != x.end(); ++xi, ++zi)
-    {
-        *zi += baseline(*xi);
-    }
-    return z;
+    if (mbondcaching == flag)  return;
+    mbondcaching = flag;
+    // force complete evaluation that fills the bond table
+    mticker.click();
+    vector<CachedBond>().swap(mbondcache.bonds);
+    mbondcache.recording = false;
+    mbondcache.valid = false;
 }
 
 
-void PDFCalculator::setBaseline(PDFBaselinePtr baseline)
+bool PDFCalculator::getBondCaching() const
 {
-    ensureNonNull("PDFBaseline", baseline);
+    return mbondcaching;
+}
+
+
+void PDFCalculator::setOccupancyPartials(bool flag)
+{
+    if (moccupancypartials == flag)  return;
+    moccupancypartials = flag;
+    // force complete evaluation that fills the partials
+    mticker.click();
+    vector<double>().swap(mpartials.values);
+    mpartials.recording = false;
+    mpartials.valid = false;
+}
+
+
+bool PDFCalculator::getOccupancyPartials() const
+{
+    return moccupancypartials;
+}
+
+// grid evaluation of distant pairs
+
+void PDFCalculator::setFFTGridStep(double gridstep)
+{
+    ensureNonNegative("fftgridstep", gridstep);
+    if (mfftgridstep == gridstep)  return;
+    mfftgridstep = gridstep;
+    mticker.click();
+}
+
+
+const double& PDFCalculator::getFFTGridStep() const
+{
+    return mfftgridstep;
+}
+
+
+void PDFCalculator::setFFTSplitDistance(double rsplit)
+{
+    ensureNonNegative("fftsplitdistance", rsplit);
+    if (mfftsplitdistance == rsplit)  return;
+    mfftsplitdistance = rsplit;
+    mticker.click();
+}
+
+
+const double& PDFCalculator::getFFTSplitDistance() const
+{
+    return mfftsplitdistance;
+}
+
+// single precision peaks
+
+void PDFCalculator::setMixedPrecision(bool flag)
+{
+    if (mmixedprecision == flag)  return;
+    mmixedprecision = flag;
+    mticker.click();
+}
+
+
+bool PDFCalculator::getMixedPrecision() const
+{
+    return mmixedprecision;
+}
+
+// PDF baseline methods
+
+QuantityType PDFCalculator::applyBaseline(
+        const QuantityType& x, const QuantityType& y) const
+{
+    assert(x.size() == y.size());
+    QuantityType z = y;
+    const PDFBaseline& baseline = *(this->getBaseline());
+    QuantityType::const_iterator xi = x.begin();
+    QuantityType::iterator zi = z.begin();
+    for (; xi != x.end(); ++xi, ++zi)
+    {
+        *zi += baseline(*xi);
+    }
+    return z;
+}
+
+
+void PDFCalculator::setBaseline(PDFBaselinePtr baseline)
+{
+    ensureNonNull("PDFBaseline", baseline);
     mbaseline = baseline;
 }
 
@@ -488,58 +1181,187 @@ void PDFCalculator::resetValue()
     // calcPoints requires that structure and rlimits data are cached.
     this->cacheStructureData();
     this->cacheRlimitsData();
+    // start a new bond table unless it is being replayed
+    if (!mbondcache.replaying)
+    {
+        mbondcache.bonds.clear();
+        mbondcache.valid = false;
+        mpartials.valid = false;
+        // grid evaluation visits only the short pairs
+        const bool usegrid = (mfftgridstep > 0.0);
+        mbondcache.recording = mbondcaching && !usegrid;
+        mpartials.recording = moccupancypartials && !usegrid;
+    }
+    if (mbondcache.recording)
+    {
+        this->ticker();
+        mbondcache.configticker = mconfigticker;
+        // extra margin so that peaks can about double their width
+        // before the table has to be rebuilt
+        const double margin = this->extFromPeakTails();
+        mbondcache.rmin = max(0.0, this->rcalclo() - margin);
+        mbondcache.rmax = this->rcalchi() + margin;
+    }
     // when applicable, configure linear baseline
     if (this->getBaseline()->type() == "linear")
     {
-        double partialpdfscale =
-            (0.0 == mstructure_cache.totaloccupancy) ? 0.0 :
-            mstructure_cache.activeoccupancy / mstructure_cache.totaloccupancy;
-        double pnumdensity = partialpdfscale * mstructure->numberDensity();
         PDFBaseline& bl = *(this->getBaseline());
-        bl.setDoubleAttr("slope", -4 * M_PI * pnumdensity);
+        bl.setDoubleAttr("slope", this->linearBaselineSlope());
     }
+    mfloatsums.clear();
+    mresidual.dirtylo = 0;
+    mresidual.dirtyhi = INT_MAX;
     this->resizeValue(this->countCalcPoints());
+    // partials are allocated with the first pair of a complete evaluation
+    if (mpartials.recording)  mpartials.values.clear();
+    const size_t ngrad = !mpositiongradients ? 0 :
+        R3::Ndim * this->countSites() * this->countCalcPoints();
+    mgradients.positions.assign(ngrad, 0.0);
+    mparametercache.resolve(mparametergradients,
+            mstructure, *(this->getPeakWidthModel()));
+    mgradients.parameters.assign(
+            mparametercache.size() * this->countCalcPoints(), 0.0);
+    this->resetDensityGrid();
     this->PairQuantity::resetValue();
 }
 
 
 void PDFCalculator::configureBondGenerator(BaseBondGenerator& bnds) const
 {
-    bnds.setRmin(this->rcalclo());
-    bnds.setRmax(this->rcalchi());
+    // position derivatives need independent coordinates for each site
+    for (int i = 0; mpositiongradients && i < this->countSites(); ++i)
+    {
+        if (mstructure->siteMultiplicity(i) == 1)  continue;
+        const char* emsg = "Position gradients require structure "
+            "without symmetry expansion.";
+        throw invalid_argument(emsg);
+    }
+    if (mfftgrid.grid)
+    {
+        bnds.setRmin(mfftgrid.rmin);
+        bnds.setRmax(mfftgrid.rmax);
+        return;
+    }
+    const bool wide = mbondcache.recording;
+    bnds.setRmin(wide ? mbondcache.rmin : this->rcalclo());
+    bnds.setRmax(wide ? mbondcache.rmax : this->rcalchi());
 }
 
 
 void PDFCalculator::addPairContribution(const BaseBondGenerator& bnds,
         int summationscale)
 {
+    const int pairscale = bnds.multiplicity() * summationscale;
+    const double& dist = bnds.distance();
+    if (mbondcache.recording)
+    {
+        CachedBond bnd = {dist, bnds.msd(),
+            bnds.site0(), bnds.site1(), pairscale, bnds.r01()};
+        mbondcache.bonds.push_back(bnd);
+        // skip bonds from the extra margin of the table
+        if (dist < this->rcalclo() || dist > this->rcalchi())  return;
+    }
     double sfprod = this->sfSite(bnds.site0()) * this->sfSite(bnds.site1());
-    double peakscale = sfprod * bnds.multiplicity() * summationscale;
+    double peakscale = sfprod * pairscale;
     double fwhm = this->getPeakWidthModel()->calculate(bnds);
-    const PeakProfile& pkf = *(this->getPeakProfile());
-    double dist = bnds.distance();
-    double xlo = dist + pkf.xboundlo(fwhm);
-    double xhi = dist + pkf.xboundhi(fwhm);
-    int i = max(0, this->calcIndex(xlo));
-    int ilast = min(this->countCalcPoints(), this->calcIndex(xhi) + 1);
-    assert(ilast <= int(mvalue.size()));
-    assert(eps_gt(dist, 0.0));
-    for (; i < ilast; ++i)
+    // exact peak replaces the pair contribution to the grid
+    if (mfftgrid.grid)
     {
-        double x = (this->rcalcloSteps() + i) * this->getRstep() - dist;
-        double y = pkf(x, fwhm);
-        // Contributions in G(r) need to be normalized by pair distance,
-        // not by r as done in PDFfit or PDFfit2.  Here we rescale RDF
-        // in such way that division by r will give a correct result.
-        double yrdf = y * (x / dist + 1);
-        mvalue[i] += peakscale * yrdf;
+        mfftgrid.grid->addPairKernel(bnds.r0(), bnds.r1(), -peakscale,
+                mfftgrid.histogram.data(), mfftgrid.hlosteps,
+                mfftgrid.histogram.size(), this->getRstep());
+    }
+    this->addPeak(dist, fwhm, peakscale);
+    if (mpartials.recording)
+    {
+        if (mpartials.values.empty())  this->resizePartials();
+        const int i = min(bnds.site0(), bnds.site1());
+        const int j = max(bnds.site0(), bnds.site1());
+        const size_t row = size_t(j) * (j + 1) / 2 + i;
+        double* pij = mpartials.values.data() + row * this->countCalcPoints();
+        this->addPeak(*(this->getPeakProfile()), pij,
+                this->rcalcloSteps(), this->countCalcPoints(),
+                dist, fwhm, pairscale);
+    }
+    if (mpositiongradients)
+    {
+        this->addPeakPositionGradients(bnds, fwhm, peakscale);
+    }
+    if (!mparametercache.empty())
+    {
+        this->addPeakParameterGradients(bnds, fwhm, peakscale);
     }
 }
 
 
+void PDFCalculator::executeParallelMerge(const string& pdata)
+{
+    istringstream storage(pdata, ios::binary);
+    diffpy::serialization::iarchive ia(storage, ios::binary);
+    QuantityType pvalue, ppositions, pparameters;
+    ia >> pvalue >> ppositions >> pparameters;
+    if (pvalue.size() != mvalue.size() ||
+            ppositions.size() != mgradients.positions.size() ||
+            pparameters.size() != mgradients.parameters.size())
+    {
+        throw invalid_argument("Merged data array must have the same size.");
+    }
+    transform(mvalue.begin(), mvalue.end(), pvalue.begin(),
+            mvalue.begin(), plus<double>());
+    transform(mgradients.positions.begin(), mgradients.positions.end(),
+            ppositions.begin(), mgradients.positions.begin(), plus<double>());
+    transform(mgradients.parameters.begin(), mgradients.parameters.end(),
+            pparameters.begin(), mgradients.parameters.begin(),
+            plus<double>());
+}
+
+
+vector<QuantityType*> PDFCalculator::getParallelSumArrays()
+{
+    vector<QuantityType*> rv = {
+        &mvalue, &mgradients.positions, &mgradients.parameters};
+    return rv;
+}
+
+
+void PDFCalculator::finishValue()
+{
+    mfloatsums.flush(mvalue);
+    // grid results cannot be updated, the next evaluation is complete
+    if (mfftgrid.grid)
+    {
+        this->addDensityGridValue();
+        mticker.click();
+    }
+    // bond table is complete at the end of full evaluation, but not for
+    // a parallel share of pairs or for a merge of parallel results
+    const bool allpairs = !mevaluator->isParallel() && !mmergedvaluescount;
+    if (mbondcache.recording && allpairs)  mbondcache.valid = true;
+    mbondcache.recording = false;
+    // the same applies to the site-pair partials
+    if (mpartials.recording && allpairs)
+    {
+        this->resizePartials();
+        mpartials.valid = true;
+    }
+    mpartials.recording = false;
+}
+
+
+bool PDFCalculator::requiresFixedSiteIndex() const
+{
+    return mpositiongradients;
+}
+
+
 void PDFCalculator::stashPartialValue()
 {
+    mfloatsums.flush(mvalue);
+    mresidual.stashlo = mresidual.dirtylo;
+    mresidual.stashhi = mresidual.dirtyhi;
     mstashedvalue.value = this->value();
+    mstashedvalue.positions = mgradients.positions;
+    mstashedvalue.parameters = mgradients.parameters;
     mstashedvalue.rclosteps = this->rcalcloSteps();
 }
 
@@ -548,16 +1370,81 @@ void PDFCalculator::restorePartialValue()
 {
     assert(!mstashedvalue.value.empty());
     assert(!mvalue.empty());
-    QuantityType::const_iterator si = mstashedvalue.value.begin();
-    QuantityType::const_iterator slast = mstashedvalue.value.end();
-    QuantityType::iterator ti = mvalue.begin();
-    QuantityType::iterator tlast = mvalue.end();
-    int leftshift = this->rcalcloSteps() - mstashedvalue.rclosteps;
-    int sz = mstashedvalue.value.size();
-    if (leftshift >= 0)  si += min(leftshift, sz);
-    else  ti += min(-leftshift, int(mvalue.size()));
-    for (; si != slast && ti != tlast; ++si, ++ti)  *ti = *si;
+    const int leftshift = this->rcalcloSteps() - mstashedvalue.rclosteps;
+    const int sz = mstashedvalue.value.size();
+    const int npts = mvalue.size();
+    _copyShifted(mstashedvalue.value.data(), sz,
+            mvalue.data(), npts, leftshift);
+    // derivatives are stored in rows of the value size
+    _copyShiftedRows(mstashedvalue.positions, sz,
+            mgradients.positions, npts, leftshift);
+    _copyShiftedRows(mstashedvalue.parameters, sz,
+            mgradients.parameters, npts, leftshift);
+    // restored values keep the residual unless the grid has shifted
+    if (leftshift == 0 && sz == npts)
+    {
+        mresidual.dirtylo = mresidual.stashlo;
+        mresidual.dirtyhi = mresidual.stashhi;
+    }
     mstashedvalue.value.clear();
+    mstashedvalue.positions.clear();
+    mstashedvalue.parameters.clear();
+    // fast updates do not pass through all bonds
+    mbondcache.recording = false;
+    mpartials.recording = false;
+}
+
+
+bool PDFCalculator::hasCachedPairs() const
+{
+    // bond table and partials do not support derivatives
+    return (mbondcache.valid || mpartials.valid) && !mpositiongradients;
+}
+
+
+bool PDFCalculator::replayPairContributions(StructureAdapterPtr stru)
+{
+    if (!mbondcache.valid || !this->usesCachedBondWidths())  return false;
+    // cached bonds do not keep bond directions for the Uij derivatives
+    if (mparametercache.usesBondDirections())  return false;
+    if (mconfigticker != mbondcache.configticker)  return false;
+    // partials are not updated for the new peak widths or distances
+    mpartials.valid = false;
+    this->setStructureKeepBonds(stru);
+    // customPQConfig in setStructure may change configuration and
+    // new peak widths may need bonds beyond the cached range
+    this->ticker();
+    if (mconfigticker != mbondcache.configticker)  return false;
+    const double rlo = this->rcalclo();
+    const double rhi = this->rcalchi();
+    if (rlo < mbondcache.rmin || rhi > mbondcache.rmax)  return false;
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    CachedBondGenerator bnds(mstructure);
+    vector<CachedBond>::const_iterator bnd = mbondcache.bonds.begin();
+    for (; bnd != mbondcache.bonds.end(); ++bnd)
+    {
+        if (bnd->distance < rlo || bnd->distance > rhi)  continue;
+        bnds.setBond(bnd->site0, bnd->site1, bnd->distance, bnd->msd);
+        double fwhm = pwm.calculate(bnds);
+        double sfprod = this->sfSite(bnd->site0) * this->sfSite(bnd->site1);
+        this->addPeak(bnd->distance, fwhm, sfprod * bnd->pairscale);
+        if (mparametercache.empty())  continue;
+        this->addPeakParameterGradients(
+                bnds, fwhm, sfprod * bnd->pairscale);
+    }
+    return true;
+}
+
+
+bool PDFCalculator::replayChangedPairs(
+        StructureAdapterPtr stru, const StructureDifference& sd)
+{
+    if (sd.diffmethod == StructureDifference::Method::LATTICE)
+    {
+        return this->replayDeformedPairs(stru, sd);
+    }
+    if (sd.occupancyonly())  return this->replayReoccupiedPairs(stru, sd);
+    return this->replayDisplacedPairs(stru, sd);
 }
 
 // calculation specific
@@ -651,6 +1538,535 @@ int PDFCalculator::calcIndex(double r) const
 }
 
 
+void PDFCalculator::addPeak(double dist, double fwhm, double peakscale)
+{
+    assert(this->countCalcPoints() <= int(mvalue.size()));
+    const PeakProfile& pkf = *(this->getPeakProfile());
+    const double& dr = this->getRstep();
+    const int rlosteps = this->rcalcloSteps();
+    const int npts = this->countCalcPoints();
+    int i = max(0, int(floor((dist + pkf.xboundlo(fwhm)) / dr)) - rlosteps);
+    int ilast = min(npts, int(floor((dist + pkf.xboundhi(fwhm)) / dr)) -
+            rlosteps + 1);
+    if (i >= ilast)  return;
+    // keep the window of changed points for the residual update
+    mresidual.dirtylo = min(mresidual.dirtylo, i);
+    mresidual.dirtyhi = max(mresidual.dirtyhi, ilast);
+    if (mmixedprecision && _usesGaussianKernel(pkf))
+    {
+        if (fwhm <= 0)  return;
+        float* y = mfloatsums.accumulate(mvalue, i, ilast);
+        simdkernels::addGaussianRDF(y, i, ilast,
+                rlosteps, dr, dist, fwhm, peakscale);
+        return;
+    }
+    this->addPeak(pkf, mvalue.data(), rlosteps, npts,
+            dist, fwhm, peakscale);
+}
+
+
+void PDFCalculator::addPeak(const PeakProfile& pkf, double* rdf,
+        int rlosteps, int npts,
+        double dist, double fwhm, double peakscale) const
+{
+    const double& dr = this->getRstep();
+    double xlo = dist + pkf.xboundlo(fwhm);
+    double xhi = dist + pkf.xboundhi(fwhm);
+    int i = max(0, int(floor(xlo / dr)) - rlosteps);
+    int ilast = min(npts, int(floor(xhi / dr)) - rlosteps + 1);
+    assert(eps_gt(dist, 0.0));
+    // use vectorized kernel for the plain Gaussian profile
+    if (_usesGaussianKernel(pkf))
+    {
+        if (fwhm <= 0 || i >= ilast)  return;
+        simdkernels::addGaussianRDF(rdf, i, ilast,
+                rlosteps, dr, dist, fwhm, peakscale);
+        return;
+    }
+    PeakProfileTablePtr tbl;
+    if (pkf.getTabulated())  tbl = pkf.table();
+    for (; i < ilast; ++i)
+    {
+        double x = (rlosteps + i) * dr - dist;
+        double y = tbl ? (*tbl)(x, fwhm) : pkf(x, fwhm);
+        // Contributions in G(r) need to be normalized by pair distance,
+        // not by r as done in PDFfit or PDFfit2.  Here we rescale RDF
+        // in such way that division by r will give a correct result.
+        double yrdf = y * (x / dist + 1);
+        rdf[i] += peakscale * yrdf;
+    }
+}
+
+
+void PDFCalculator::addPeakPositionGradients(const BaseBondGenerator& bnds,
+        double fwhm, double peakscale)
+{
+    const int i0 = bnds.site0();
+    const int i1 = bnds.site1();
+    // periodic images of the same site do not depend on its position
+    if (i0 == i1 || fwhm <= 0)  return;
+    const PeakProfile& pkf = *(this->getPeakProfile());
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    const double& dist = bnds.distance();
+    const R3::Vector u = bnds.r01() / dist;
+    // gradient of the peak width with respect to the bond vector
+    R3::Vector dw = pwm.derivativeMSD(bnds) * bnds.msdGradient();
+    dw += pwm.derivativeDistance(bnds) * u;
+    double xlo = dist + pkf.xboundlo(fwhm);
+    double xhi = dist + pkf.xboundhi(fwhm);
+    const int npts = this->countCalcPoints();
+    int i = max(0, this->calcIndex(xlo));
+    int ilast = min(npts, this->calcIndex(xhi) + 1);
+    double* g0 = mgradients.positions.data() + R3::Ndim * i0 * npts;
+    double* g1 = mgradients.positions.data() + R3::Ndim * i1 * npts;
+    for (; i < ilast; ++i)
+    {
+        // the peak is peakscale * r / dist * pkf(r - dist, fwhm)
+        double r = (this->rcalcloSteps() + i) * this->getRstep();
+        double x = r - dist;
+        double a = peakscale * r / dist;
+        double ydist = -a * (pkf(x, fwhm) / dist + pkf.derivativeX(x, fwhm));
+        double yfwhm = a * pkf.derivativeFWHM(x, fwhm);
+        for (int k = 0; k < R3::Ndim; ++k)
+        {
+            double gk = ydist * u[k] + yfwhm * dw[k];
+            g1[k * npts + i] += gk;
+            g0[k * npts + i] -= gk;
+        }
+    }
+}
+
+
+void PDFCalculator::addPeakParameterGradients(const BaseBondGenerator& bnds,
+        double fwhm, double peakscale)
+{
+    if (fwhm <= 0)  return;
+    const PeakProfile& pkf = *(this->getPeakProfile());
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    const int nparams = mparametercache.size();
+    // derivatives of the peak width with respect to each parameter
+    thread_local vector<double> dw;
+    dw.resize(nparams);
+    if (!mparametercache.widthDerivatives(pwm, bnds, dw.data()))  return;
+    const double& dist = bnds.distance();
+    double xlo = dist + pkf.xboundlo(fwhm);
+    double xhi = dist + pkf.xboundhi(fwhm);
+    const int npts = this->countCalcPoints();
+    int i = max(0, this->calcIndex(xlo));
+    int ilast = min(npts, this->calcIndex(xhi) + 1);
+    double* g = mgradients.parameters.data();
+    for (; i < ilast; ++i)
+    {
+        double r = (this->rcalcloSteps() + i) * this->getRstep();
+        double x = r - dist;
+        double yfwhm = peakscale * r / dist * pkf.derivativeFWHM(x, fwhm);
+        for (int p = 0; p < nparams; ++p)
+        {
+            g[p * npts + i] += yfwhm * dw[p];
+        }
+    }
+}
+
+
+void PDFCalculator::addCachedBonds(const vector<int>& indices, int sign)
+{
+    const double rlo = this->rcalclo();
+    const double rhi = this->rcalchi();
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    CachedBondGenerator bnds(mstructure);
+    vector<int>::const_iterator kk = indices.begin();
+    for (; kk != indices.end(); ++kk)
+    {
+        const CachedBond& bnd = mbondcache.bonds[*kk];
+        if (bnd.distance < rlo || bnd.distance > rhi)  continue;
+        bnds.setBond(bnd.site0, bnd.site1, bnd.distance, bnd.msd);
+        double fwhm = pwm.calculate(bnds);
+        double sfprod = this->sfSite(bnd.site0) * this->sfSite(bnd.site1);
+        double peakscale = sign * sfprod * bnd.pairscale;
+        this->addPeak(bnd.distance, fwhm, peakscale);
+        if (mparametercache.empty())  continue;
+        this->addPeakParameterGradients(bnds, fwhm, peakscale);
+    }
+}
+
+
+bool PDFCalculator::replayDisplacedPairs(
+        StructureAdapterPtr stru, const StructureDifference& sd)
+{
+    if (!mbondcache.valid || !this->usesCachedBondWidths())  return false;
+    if (mconfigticker != mbondcache.configticker)  return false;
+    if (mparametercache.usesBondDirections())  return false;
+    // change of the msd contribution from each displaced site.
+    // Use stru0 as the current structure may have been changed in place.
+    const int cntsites = sd.stru0->countSites();
+    vector<double> dmsd(cntsites, 0.0);
+    vector<bool> isdisplaced(cntsites, false);
+    SiteIndices::const_iterator ii = sd.displaced.begin();
+    for (; ii != sd.displaced.end(); ++ii)
+    {
+        assert(!sd.stru0->siteAnisotropy(*ii));
+        assert(!stru->siteAnisotropy(*ii));
+        dmsd[*ii] = stru->siteCartesianUij(*ii)(0, 0) -
+            sd.stru0->siteCartesianUij(*ii)(0, 0);
+        isdisplaced[*ii] = true;
+    }
+    vector<int> affected;
+    for (size_t k = 0; k < mbondcache.bonds.size(); ++k)
+    {
+        const CachedBond& bnd = mbondcache.bonds[k];
+        if (isdisplaced[bnd.site0] || isdisplaced[bnd.site1])
+        {
+            affected.push_back(k);
+        }
+    }
+    // remove peaks for the old displacement parameters
+    mpartials.valid = false;
+    this->addCachedBonds(affected, -1);
+    const int lo0 = this->rcalcloSteps();
+    const int hi0 = this->rcalchiSteps();
+    this->stashPartialValue();
+    this->setStructureKeepBonds(stru);
+    this->restorePartialValue();
+    this->ticker();
+    if (mconfigticker != mbondcache.configticker)  return false;
+    // stashed value has no peaks from the other pairs in a wider range
+    if (this->rcalcloSteps() < lo0 || this->rcalchiSteps() > hi0)
+    {
+        return false;
+    }
+    if (this->rcalclo() < mbondcache.rmin ||
+            this->rcalchi() > mbondcache.rmax)  return false;
+    // update the bond table and add peaks with the new msd values
+    vector<int>::const_iterator kk = affected.begin();
+    for (; kk != affected.end(); ++kk)
+    {
+        CachedBond& bnd = mbondcache.bonds[*kk];
+        bnd.msd += dmsd[bnd.site0] + dmsd[bnd.site1];
+    }
+    this->addCachedBonds(affected, +1);
+    return true;
+}
+
+
+bool PDFCalculator::replayDeformedPairs(
+        StructureAdapterPtr stru, const StructureDifference& sd)
+{
+    if (!mbondcache.valid || !this->usesCachedBondWidths())  return false;
+    if (mconfigticker != mbondcache.configticker)  return false;
+    if (mparametercache.usesBondDirections())  return false;
+    const R3::Matrix& D = sd.deformation;
+    // uniform scaling keeps bond directions and thus the msd values
+    const double s = D(0, 0);
+    const R3::Matrix S = s * R3::identity();
+    const bool uniform = mathutils::EpsilonEqual(1e-12)(D, S) && s > 0;
+    // bounds of the scaling of pair distances, for other deformations
+    // obtained from the Frobenius norm of D - I
+    double smin = s;
+    double smax = s;
+    if (!uniform)
+    {
+        // msd of anisotropic sites depends on the bond direction
+        for (int i = 0; i < stru->countSites(); ++i)
+        {
+            if (stru->siteAnisotropy(i))  return false;
+        }
+        double enorm2 = 0.0;
+        for (int k = 0; k < R3::Ndim; ++k)
+        {
+            for (int l = 0; l < R3::Ndim; ++l)
+            {
+                const double ekl = D(k, l) - ((k == l) ? 1.0 : 0.0);
+                enorm2 += ekl * ekl;
+            }
+        }
+        smin = 1.0 - sqrt(enorm2);
+        smax = 1.0 + sqrt(enorm2);
+        if (smin <= 0.0)  return false;
+    }
+    vector<CachedBond>::iterator bnd = mbondcache.bonds.begin();
+    for (; bnd != mbondcache.bonds.end(); ++bnd)
+    {
+        bnd->r01 = R3::mxvecproduct(bnd->r01, D);
+        bnd->distance = uniform ? (s * bnd->distance) : R3::norm(bnd->r01);
+    }
+    // bonds outside of the original limits may move only outside of the
+    // transformed limits.  replayPairContributions checks the new range.
+    mbondcache.rmin *= smax;
+    mbondcache.rmax *= smin;
+    return this->replayPairContributions(stru);
+}
+
+
+void PDFCalculator::resizePartials()
+{
+    const size_t n = this->countSites();
+    const size_t npairs = n * (n + 1) / 2;
+    mpartials.values.resize(npairs * this->countCalcPoints(), 0.0);
+}
+
+
+bool PDFCalculator::replayReoccupiedPairs(
+        StructureAdapterPtr stru, const StructureDifference& sd)
+{
+    // the partials have no derivatives, use the bond table instead
+    if (!mpartials.valid || !mparametercache.empty())
+    {
+        return mbondcache.valid && this->replayPairContributions(stru);
+    }
+    const int lo0 = this->rcalcloSteps();
+    const int hi0 = this->rcalchiSteps();
+    this->setStructureKeepBonds(stru);
+    if (this->rcalcloSteps() != lo0 || this->rcalchiSteps() != hi0)
+    {
+        return false;
+    }
+    // value is a sum of the partials weighted by scattering factors
+    // that include the site occupancies
+    assert(sd.stru0->countSites() == this->countSites());
+    const int cntsites = this->countSites();
+    const int npts = this->countCalcPoints();
+    const double* pij = mpartials.values.data();
+    for (int j = 0; j < cntsites; ++j)
+    {
+        for (int i = 0; i <= j; ++i, pij += npts)
+        {
+            const double w = this->sfSite(i) * this->sfSite(j);
+            if (w == 0.0)  continue;
+            for (int k = 0; k < npts; ++k)  mvalue[k] += w * pij[k];
+        }
+    }
+    return true;
+}
+
+
+void PDFCalculator::resetDensityGrid()
+{
+    mfftgrid.grid.reset();
+    mfftgrid.histogram.clear();
+    mfftgrid.smearing.clear();
+    if (!(mfftgridstep > 0.0))  return;
+    // check the grid evaluation is applicable
+    const PeriodicStructureAdapter* pstru =
+        dynamic_cast<const PeriodicStructureAdapter*>(mstructure.get());
+    if (!pstru)
+    {
+        const char* emsg = "FFT grid requires periodic structure.";
+        throw invalid_argument(emsg);
+    }
+    for (int i = 0; i < this->countSites(); ++i)
+    {
+        if (mstructure->siteMultiplicity(i) == 1)  continue;
+        const char* emsg = "FFT grid requires structure "
+            "without symmetry expansion.";
+        throw invalid_argument(emsg);
+    }
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    const PeakProfile& pkf = *(this->getPeakProfile());
+    if (typeid(pwm) != typeid(ConstantPeakWidth) ||
+            typeid(pkf) != typeid(GaussianProfile))
+    {
+        const char* emsg = "FFT grid requires Gaussian peaks "
+            "of constant width.";
+        throw invalid_argument(emsg);
+    }
+    if (this->hasMask() || mpositiongradients ||
+            !mparametergradients.empty() || mevaluator->isParallel())
+    {
+        const char* emsg = "FFT grid does not support pair masks, "
+            "derivatives or parallel evaluation.";
+        throw invalid_argument(emsg);
+    }
+    boost::shared_ptr<ScatteringDensityGrid> grid(
+            new ScatteringDensityGrid(pstru->getLattice(), mfftgridstep));
+    // the grid kernel accounts for part of the peak broadening
+    const double fwhm = static_cast<const ConstantPeakWidth&>(pwm).getWidth();
+    const double fwhmtosigma = 1.0 / (2 * sqrt(2 * M_LN2));
+    const double sigma = fwhm * fwhmtosigma;
+    const double sigma2smear = sigma * sigma - grid->kernelVariance();
+    if (!(sigma2smear > 0.0))
+    {
+        const char* emsg = "FFT grid step is too coarse for the peak width.";
+        throw invalid_argument(emsg);
+    }
+    const double& dr = this->getRstep();
+    const double sigmasmear = sqrt(sigma2smear);
+    const int nk = int(ceil(pkf.xboundhi(sigmasmear / fwhmtosigma) / dr));
+    double smearingsum = 0.0;
+    for (int k = -nk; k <= nk; ++k)
+    {
+        const double x = k * dr / sigmasmear;
+        mfftgrid.smearing.push_back(exp(-0.5 * x * x));
+        smearingsum += mfftgrid.smearing.back();
+    }
+    for (double& w : mfftgrid.smearing)  w /= smearingsum;
+    // histogram spans the calculated grid and the smearing tails
+    mfftgrid.hlosteps = max(0, this->rcalcloSteps() - nk);
+    const int hhisteps = this->rcalchiSteps() + nk;
+    const double extent = grid->kernelExtent();
+    if (hhisteps * dr + 2 * extent > grid->maxDistance())
+    {
+        const char* emsg = "FFT grid requires r-range within "
+            "half of the cell width.";
+        throw invalid_argument(emsg);
+    }
+    mfftgrid.rmin = max(0.0, mfftgrid.hlosteps * dr - extent);
+    mfftgrid.rmax = max(mfftgrid.rmin,
+            min(mfftsplitdistance, hhisteps * dr + extent));
+    const int nbins = hhisteps - mfftgrid.hlosteps;
+    mfftgrid.histogram.assign(nbins, 0.0);
+    double* hist = mfftgrid.histogram.data();
+    for (int i = 0; i < this->countSites(); ++i)
+    {
+        const R3::Vector& xyz = mstructure->siteCartesianPosition(i);
+        const double& w = this->sfSite(i);
+        grid->deposit(xyz, w);
+        // remove self-pair terms spread by the kernel
+        grid->addPairKernel(xyz, xyz, -w * w,
+                hist, mfftgrid.hlosteps, nbins, dr);
+    }
+    grid->addRadialAutocorrelation(hist, mfftgrid.hlosteps, nbins, dr);
+    mfftgrid.grid = grid;
+}
+
+
+void PDFCalculator::addDensityGridValue()
+{
+    const vector<double>& hist = mfftgrid.histogram;
+    const vector<double>& smearing = mfftgrid.smearing;
+    const int nk = smearing.size() / 2;
+    const int nbins = hist.size();
+    const int npts = this->countCalcPoints();
+    for (int i = 0; i < npts; ++i)
+    {
+        const int ir = this->rcalcloSteps() + i;
+        double y = 0.0;
+        for (int k = -nk; k <= nk; ++k)
+        {
+            const int j = ir + k - mfftgrid.hlosteps;
+            if (j < 0 || j >= nbins)  continue;
+            y += smearing[nk + k] * hist[j];
+        }
+        // histogram holds contributions per rstep divided by distance
+        mvalue[i] += ir * y;
+    }
+    // release grid data that are specific to this evaluation
+    mfftgrid.grid.reset();
+    vector<double>().swap(mfftgrid.histogram);
+}
+
+
+void PDFCalculator::setStructureKeepBonds(StructureAdapterPtr stru)
+{
+    mbondcache.replaying = true;
+    try {
+        this->setStructure(stru);
+    }
+    catch (...) {
+        mbondcache.replaying = false;
+        throw;
+    }
+    mbondcache.replaying = false;
+}
+
+
+bool PDFCalculator::usesCachedBondWidths() const
+{
+    // these models depend only on the pair distance and msd
+    const PeakWidthModel& pwm = *(this->getPeakWidthModel());
+    const type_info& tp = typeid(pwm);
+    bool rv = (tp == typeid(ConstantPeakWidth)) ||
+        (tp == typeid(DebyeWallerPeakWidth)) ||
+        (tp == typeid(JeongPeakWidth));
+    return rv;
+}
+
+
+QuantityType PDFCalculator::extendedPDF(
+        const double* calcvalue, bool baseline) const
+{
+    QuantityType rgrid_ext = this->getExtendedRgrid();
+    // Skip FFT when qmax is not specified and qmin does not exclude the
+    // the F(Q=Qstep) point (excluding F(0) == 0 makes no difference to G).
+    const bool skipfft =
+        !eps_lt(this->getQmax(), M_PI / this->getRstep()) &&
+        !(1 < pdfutils_qminSteps(this));
+    if (skipfft)
+    {
+        QuantityType rdfpr = this->extendedRDFperR(calcvalue);
+        if (baseline)  rdfpr = this->applyBaseline(rgrid_ext, rdfpr);
+        QuantityType pdf = this->applyEnvelopes(rgrid_ext, rdfpr);
+        return pdf;
+    }
+    // FFT required here
+    // we need a full range PDF to apply termination ripples correctly
+    QuantityType f_ext = this->extendedF(calcvalue, baseline);
+    // zero all F points at Q < Qmin
+    QuantityType::iterator ii_qmin =
+        f_ext.begin() + min(pdfutils_qminSteps(this), int(f_ext.size()));
+    fill(f_ext.begin(), ii_qmin, 0.0);
+    // zero all F points at Q >= Qmax
+    assert(pdfutils_qmaxSteps(this) <= int(f_ext.size()));
+    QuantityType::iterator ii_qmax = f_ext.begin() + pdfutils_qmaxSteps(this);
+    fill(ii_qmax, f_ext.end(), 0.0);
+    QuantityType pdf1 = fftftog(f_ext, this->getQstep());
+    // cut away the FFT padded points
+    assert(this->extendedRmaxSteps() <= int(pdf1.size()));
+    pdf1.erase(pdf1.begin() + this->extendedRmaxSteps(), pdf1.end());
+    pdf1.erase(pdf1.begin(), pdf1.begin() + this->extendedRminSteps());
+    QuantityType pdf2 = this->applyEnvelopes(rgrid_ext, pdf1);
+    return pdf2;
+}
+
+
+QuantityType PDFCalculator::extendedRDF(const double* calcvalue) const
+{
+    QuantityType rdf(this->countExtendedPoints());
+    const double rdf_scale = this->rdfScale();
+    QuantityType::iterator iirdf = rdf.begin();
+    const double* iival = calcvalue +
+        this->extendedRminSteps() - this->rcalcloSteps();
+    assert(this->extendedRminSteps() >= this->rcalcloSteps());
+    assert(this->extendedRmaxSteps() <= this->rcalchiSteps());
+    for (; iirdf != rdf.end(); ++iival, ++iirdf)
+    {
+        *iirdf = *iival * rdf_scale;
+    }
+    return rdf;
+}
+
+
+QuantityType PDFCalculator::extendedRDFperR(const double* calcvalue) const
+{
+    QuantityType rdf_ext = this->extendedRDF(calcvalue);
+    // evaluate r-values in place to avoid allocating the extended r-grid
+    int ri = this->extendedRminSteps();
+    QuantityType::iterator rdfi = rdf_ext.begin();
+    for (; rdfi != rdf_ext.end(); ++ri, ++rdfi)
+    {
+        const double r = ri * this->getRstep();
+        *rdfi = eps_gt(r, 0) ? (*rdfi / r) : 0.0;
+    }
+    return rdf_ext;
+}
+
+
+QuantityType PDFCalculator::extendedF(
+        const double* calcvalue, bool baseline) const
+{
+    QuantityType rdfperr_ext = this->extendedRDFperR(calcvalue);
+    if (baseline)
+    {
+        QuantityType rgrid_ext = this->getExtendedRgrid();
+        rdfperr_ext = this->applyBaseline(rgrid_ext, rdfperr_ext);
+    }
+    const double rmin_ext = this->getExtendedRmin();
+    QuantityType rv = fftgtof(rdfperr_ext, this->getRstep(), rmin_ext);
+    assert(rv.empty() || eps_eq(M_PI,
+                this->getQstep() * rv.size() * this->getRstep()));
+    return rv;
+}
+
+
 void PDFCalculator::cutRipplePoints(QuantityType& y) const
 {
     if (y.empty())  return;
@@ -664,6 +2080,98 @@ void PDFCalculator::cutRipplePoints(QuantityType& y) const
 }
 
 
+void PDFCalculator::updateResidual() const
+{
+    FitResidual& fit = mresidual.fit;
+    if (fit.empty())
+    {
+        const char* emsg = "Observed PDF is not set.  Call setObservedPDF().";
+        throw logic_error(emsg);
+    }
+    // values outside the changed window stay the same only when
+    // there are no termination ripples and the scaling is the same
+    const bool skipfft =
+        !eps_lt(this->getQmax(), M_PI / this->getRstep()) &&
+        !(1 < pdfutils_qminSteps(this));
+    string signature = this->residualSignature();
+    const bool changed = mresidual.dirtylo < mresidual.dirtyhi;
+    const bool fullupdate = !fit.hasCalculated() ||
+        signature != mresidual.signature || (changed && !skipfft) ||
+        (mresidual.dirtylo == 0 && mresidual.dirtyhi == INT_MAX);
+    if (fullupdate)
+    {
+        fit.update(this->getPDF());
+    }
+    else if (changed)
+    {
+        // convert window of calculated points to the result indices
+        const int rminsteps = pdfutils_rminSteps(this);
+        const int offset = this->rcalcloSteps() - rminsteps;
+        const int npts = fit.getObserved().size();
+        const int lo = max(0, mresidual.dirtylo + offset);
+        const int hi = min(npts, mresidual.dirtyhi + offset);
+        if (lo < hi)
+        {
+            // same steps as in extendedPDF without the FFT
+            const double rdf_scale = this->rdfScale();
+            QuantityType x(hi - lo), y(hi - lo);
+            for (int j = lo; j < hi; ++j)
+            {
+                const double r = (rminsteps + j) * this->getRstep();
+                x[j - lo] = r;
+                y[j - lo] = eps_gt(r, 0) ?
+                    (mvalue[j - offset] * rdf_scale / r) : 0.0;
+            }
+            y = this->applyBaseline(x, y);
+            y = this->applyEnvelopes(x, y);
+            fit.updateWindow(lo, y);
+        }
+    }
+    mresidual.signature.swap(signature);
+    mresidual.dirtylo = INT_MAX;
+    mresidual.dirtyhi = 0;
+}
+
+
+string PDFCalculator::residualSignature() const
+{
+    ostringstream sig;
+    sig.precision(17);
+    sig << this->rdfScale() << ' ' << this->getBaseline()->type();
+    set<string> envtypes = this->usedEnvelopeTypes();
+    set<string>::const_iterator tp = envtypes.begin();
+    for (; tp != envtypes.end(); ++tp)  sig << ' ' << *tp;
+    // double attributes include the baseline and envelope parameters
+    set<string> names = this->namesOfDoubleAttributes();
+    set<string>::const_iterator nm = names.begin();
+    for (; nm != names.end(); ++nm)
+    {
+        sig << ' ' << *nm << '=' << this->getDoubleAttr(*nm);
+    }
+    return sig.str();
+}
+
+
+double PDFCalculator::rdfScale() const
+{
+    const double& totocc = mstructure_cache.totaloccupancy;
+    double sfavg = this->sfAverage();
+    double rv = (totocc * sfavg == 0.0) ? 0.0 :
+        1.0 / (totocc * sfavg * sfavg);
+    return rv;
+}
+
+
+double PDFCalculator::linearBaselineSlope() const
+{
+    double partialpdfscale =
+        (0.0 == mstructure_cache.totaloccupancy) ? 0.0 :
+        mstructure_cache.activeoccupancy / mstructure_cache.totaloccupancy;
+    double pnumdensity = partialpdfscale * mstructure->numberDensity();
+    return -4 * M_PI * pnumdensity;
+}
+
+
 const double& PDFCalculator::sfSite(int siteidx) const
 {
     assert(0 <= siteidx && siteidx < int(mstructure_cache.sfsite.size()));
@@ -19,16 +19,23 @@
 #ifndef PDFCALCULATOR_HPP_INCLUDED
 #define PDFCALCULATOR_HPP_INCLUDED
 
+#include <map>
+
 #include <diffpy/srreal/PairQuantity.hpp>
 #include <diffpy/srreal/PeakProfile.hpp>
 #include <diffpy/srreal/PeakWidthModel.hpp>
+#include <diffpy/srreal/ParameterGradients.hpp>
 #include <diffpy/srreal/PDFBaseline.hpp>
 #include <diffpy/srreal/PDFEnvelope.hpp>
 #include <diffpy/srreal/ScatteringFactorTable.hpp>
+#include <diffpy/srreal/SinglePrecisionSums.hpp>
+#include <diffpy/srreal/FitResidual.hpp>
 
 namespace diffpy {
 namespace srreal {
 
+class ScatteringDensityGrid;
+
 class PDFCalculator :
     public PairQuantity,
     public PeakWidthModelOwner,
@@ -42,6 +49,9 @@ class PDFCalculator :
 
         // PairQuantity overloads
         virtual eventticker::EventTicker& ticker() const;
+        virtual std::string getParallelData() const;
+        virtual MemoryUsage memoryUsage() const;
+        virtual MemoryUsage estimateMemoryUsage(StructureAdapterPtr) const;
 
         // results
         QuantityType getPDF() const;
@@ -60,6 +70,67 @@ class PDFCalculator :
         /// r-grid extended for termination ripples
         QuantityType getExtendedRgrid() const;
 
+        // derivatives with respect to site positions
+        /// accumulate derivatives of the PDF with respect to Cartesian
+        /// coordinates of every site.  Disabled by default.
+        void setPositionGradients(bool);
+        bool getPositionGradients() const;
+        /// derivatives of getPDF() with respect to Cartesian coordinates,
+        /// where row 3 * i + k is for the k-th coordinate of site i
+        std::vector<QuantityType> getPDFPositionJacobian() const;
+
+        // derivatives with respect to width and displacement parameters
+        /// accumulate derivatives of the PDF with respect to the named
+        /// parameters.  These are double attributes of the peak width model
+        /// or "Uiso:T", "U11:T", ..., "U23:T" for Cartesian displacement
+        /// parameters shared by all sites of the atom type T.
+        void setParameterGradients(const std::vector<std::string>& names);
+        const std::vector<std::string>& getParameterGradients() const;
+        /// derivative of getPDF() with respect to the named parameter
+        QuantityType getPDFDerivative(const std::string& name) const;
+
+        // comparison with observed data
+        /// set observed PDF on the getRgrid() points and its weights,
+        /// unit weights when empty.  Empty gobs disables the comparison.
+        void setObservedPDF(const QuantityType& gobs,
+                const QuantityType& weights=QuantityType());
+        const QuantityType& getObservedPDF() const;
+        /// weighted residual sqrt(w) * (Gcalc - Gobs)
+        QuantityType getResidual() const;
+        /// sum of w * (Gcalc - Gobs)**2.  After optimized evaluation this
+        /// is updated only from the r-window of changed peaks unless the
+        /// PDF has termination ripples, i.e., Qmax is below pi / rstep.
+        double getChiSquared() const;
+        /// agreement factor sqrt(chi2 / sum(w * Gobs**2))
+        double getRw() const;
+
+        // parameter sweeps
+        typedef std::map<std::string, double> AttributeSettings;
+        /// PDFs for a list of double attribute settings, e.g., of peak
+        /// widths or envelopes, from a single pass of the bond generator.
+        /// The peaks are rendered in ncpu threads.  Swept attributes are
+        /// restored and the calculator value is reset afterwards.
+        std::vector<QuantityType> sweepPDF(StructureAdapterPtr,
+                const std::vector<AttributeSettings>& settings, int ncpu=1);
+
+        // evaluation at arbitrary points
+        /// PDF at the sorted r-points from a single pass of the bond
+        /// generator, where peaks are added only at the points.  This
+        /// ignores the r-range configuration and requires Qmax at or above
+        /// the Nyquist limit pi / rstep, which applies no termination
+        /// ripples.  The calculator value is reset afterwards.
+        QuantityType evalPDFAtPoints(StructureAdapterPtr,
+                const QuantityType& rpoints);
+
+        // ensemble averages
+        /// accumulate raw values of the ensemble configurations in ncpu
+        /// threads and keep their average, so that getPDF and other
+        /// results are post-processed only once.  The r-grid and RDF
+        /// normalization follow the first configuration.
+        const QuantityType& evalEnsemble(
+                const std::vector<StructureAdapterPtr>& ensemble,
+                int ncpu=1);
+
         // Q-range methods
         QuantityType getQgrid() const;
         // Q-range configuration
@@ -92,6 +163,37 @@ class PDFCalculator :
         void setPeakProfileByType(const std::string& tp);
         PeakProfilePtr& getPeakProfile();
         const PeakProfilePtr& getPeakProfile() const;
+        /// keep a table of bonds from the last complete evaluation so that
+        /// changes of peak width or profile parameters are applied without
+        /// rerunning the bond generator.  Disabled by default.
+        void setBondCaching(bool);
+        bool getBondCaching() const;
+        /// keep unweighted partial RDFs of all site pairs from the last
+        /// complete evaluation, so that changes of site occupancies, e.g.,
+        /// in disordered-site models, only recombine the partials.
+        /// Memory use grows with the square of site count.  Disabled
+        /// by default.
+        void setOccupancyPartials(bool);
+        bool getOccupancyPartials() const;
+        /// evaluate pairs beyond the split distance from autocorrelation of
+        /// scattering density on a grid with this spacing, where work grows
+        /// with the cell volume instead of the number of pairs.  Requires
+        /// periodic structure without symmetry expansion, Gaussian profile
+        /// of constant width and the r-range within half of the cell width.
+        /// Zero value disables the grid evaluation, which is the default.
+        void setFFTGridStep(double);
+        const double& getFFTGridStep() const;
+        /// pairs shorter than this distance are summed exactly when the
+        /// FFT grid is used
+        void setFFTSplitDistance(double);
+        const double& getFFTSplitDistance() const;
+        /// add Gaussian peaks in single precision to float partial sums
+        /// that are added to the double value in short blocks.  This is
+        /// faster on wide SIMD units at relative error of about 1e-6.
+        /// Other profiles and the derivatives use double precision.
+        /// Disabled by default.
+        void setMixedPrecision(bool);
+        bool getMixedPrecision() const;
 
         // PDF baseline configuration
         // application on an array
@@ -111,9 +213,17 @@ class PDFCalculator :
         virtual void resetValue();
         virtual void configureBondGenerator(BaseBondGenerator&) const;
         virtual void addPairContribution(const BaseBondGenerator&, int);
+        virtual void executeParallelMerge(const std::string& pdata);
+        virtual std::vector<QuantityType*> getParallelSumArrays();
+        virtual void finishValue();
         // support for PQEvaluatorOptimized
+        virtual bool requiresFixedSiteIndex() const;
         virtual void stashPartialValue();
         virtual void restorePartialValue();
+        virtual bool hasCachedPairs() const;
+        virtual bool replayPairContributions(StructureAdapterPtr);
+        virtual bool replayChangedPairs(StructureAdapterPtr,
+                const StructureDifference&);
 
     private:
 
@@ -140,9 +250,58 @@ class PDFCalculator :
         int countCalcPoints() const;
         /// index of a nearby point in the complete calculated r-grid
         int calcIndex(double r) const;
+        /// add profile of a single peak to the calculated grid
+        void addPeak(double dist, double fwhm, double peakscale);
+        /// add peak profile to the rdf array of npts points starting
+        /// at rlosteps
+        void addPeak(const PeakProfile&, double* rdf, int rlosteps, int npts,
+                double dist, double fwhm, double peakscale) const;
+        /// add derivatives of a peak with respect to the bonded sites
+        void addPeakPositionGradients(const BaseBondGenerator&,
+                double fwhm, double peakscale);
+        /// add derivatives of a peak with respect to the named parameters
+        void addPeakParameterGradients(const BaseBondGenerator&,
+                double fwhm, double peakscale);
+        /// scale of the raw values to the RDF
+        double rdfScale() const;
+        /// slope of the linear baseline for the current structure
+        double linearBaselineSlope() const;
+        /// RDF on the extended grid from values on the calculated grid
+        QuantityType extendedRDF(const double* calcvalue) const;
+        /// RDF divided by r on the extended grid
+        QuantityType extendedRDFperR(const double* calcvalue) const;
+        /// F(Q) transformed from values on the calculated grid
+        QuantityType extendedF(const double* calcvalue, bool baseline) const;
+        /// PDF on the extended grid from values on the calculated grid
+        QuantityType extendedPDF(const double* calcvalue, bool baseline) const;
+        /// check if peak widths can be obtained from cached bonds
+        bool usesCachedBondWidths() const;
+        /// add or remove peaks of the cached bonds from the table indices
+        void addCachedBonds(const std::vector<int>& indices, int sign);
+        /// update cached bonds for changed isotropic displacements
+        bool replayDisplacedPairs(StructureAdapterPtr,
+                const StructureDifference&);
+        /// update cached bonds for a deformation of the lattice
+        bool replayDeformedPairs(StructureAdapterPtr,
+                const StructureDifference&);
+        /// allocate zero partial RDFs for all site pairs
+        void resizePartials();
+        /// recombine pair partials or cached bonds for new occupancies
+        bool replayReoccupiedPairs(StructureAdapterPtr,
+                const StructureDifference&);
+        /// set structure while keeping the bond table
+        void setStructureKeepBonds(StructureAdapterPtr);
+        /// prepare grid autocorrelation for the current structure
+        void resetDensityGrid();
+        /// add grid autocorrelation broadened to the peak width to value
+        void addDensityGridValue();
         /// reduce extended grid to user-requested results grid
         /// by cutting away the points for termination ripples
         void cutRipplePoints(QuantityType& y) const;
+        /// compare new PDF values with the observed data
+        void updateResidual() const;
+        /// configuration that affects PDF values of unchanged peaks
+        std::string residualSignature() const;
 
         // structure factors - fast lookup by site index
         /// effective scattering factor at a given site scaled by occupancy
@@ -158,6 +317,13 @@ class PDFCalculator :
         double mqmax;
         double mrstep;
         double mmaxextension;
+        bool mbondcaching;
+        bool moccupancypartials;
+        bool mpositiongradients;
+        double mfftgridstep;
+        double mfftsplitdistance;
+        bool mmixedprecision;
+        std::vector<std::string> mparametergradients;
         PeakProfilePtr mpeakprofile;
         PDFBaselinePtr mbaseline;
         struct {
@@ -175,8 +341,72 @@ class PDFCalculator :
         // support for PQEvaluatorOptimized
         struct {
             QuantityType value;
+            QuantityType positions;
+            QuantityType parameters;
             int rclosteps;
         } mstashedvalue;
+        // derivatives of value on the calculated grid, where positions
+        // has a row of countCalcPoints() for each Cartesian coordinate
+        // and parameters a row for each entry in mparametergradients
+        struct {
+            QuantityType positions;
+            QuantityType parameters;
+        } mgradients;
+        // gradient parameters resolved for the current structure
+        ParameterGradients mparametercache;
+        // bonds from the last complete evaluation
+        struct CachedBond {
+            double distance;
+            double msd;
+            int site0;
+            int site1;
+            int pairscale;
+            R3::Vector r01;
+        };
+        struct {
+            std::vector<CachedBond> bonds;
+            bool recording;
+            bool valid;
+            bool replaying;
+            double rmin;
+            double rmax;
+            eventticker::EventTicker configticker;
+        } mbondcache;
+        // unweighted partial RDFs from the last complete evaluation with
+        // a row of countCalcPoints() for each site pair i <= j
+        struct {
+            std::vector<double> values;
+            bool recording;
+            bool valid;
+        } mpartials;
+        // grid evaluation with a histogram of inverse pair distances at
+        // (hlosteps + k) * rstep, Gaussian smearing of the histogram to
+        // the peak width and bond range of the exact pair sum
+        struct {
+            boost::shared_ptr<ScatteringDensityGrid> grid;
+            std::vector<double> histogram;
+            std::vector<double> smearing;
+            int hlosteps;
+            double rmin;
+            double rmax;
+        } mfftgrid;
+        // pending single precision peaks when mmixedprecision is set
+        SinglePrecisionSums mfloatsums;
+        // comparison with observed PDF and the range of calculated points
+        // [dirtylo, dirtyhi) changed since its last update
+        struct ResidualCache {
+            FitResidual fit;
+            std::string signature;
+            int dirtylo;
+            int dirtyhi;
+            int stashlo;
+            int stashhi;
+        };
+        mutable ResidualCache mresidual;
+        // ticker of own configuration changes, i.e., excluding peak widths,
+        // peak profile and scattering factors
+        mutable eventticker::EventTicker mconfigticker;
+        mutable eventticker::EventTicker mmergedticker;
         // serialization
         friend class boost::serialization::access;
         template<class Archive>
@@ -201,6 +431,25 @@ class PDFCalculator :
             ar & mrlimits_cache.extendedrmaxsteps;
             ar & mrlimits_cache.rcalclosteps;
             ar & mrlimits_cache.rcalchisteps;
+            if (version >= 1) {
+                ar & mbondcaching;
+            }
+            if (version >= 2) {
+                ar & mpositiongradients;
+            }
+            if (version >= 3) {
+                ar & mparametergradients;
+            }
+            if (version >= 4) {
+                ar & moccupancypartials;
+            }
+            if (version >= 5) {
+                ar & mfftgridstep;
+                ar & mfftsplitdistance;
+            }
+            if (version >= 6) {
+                ar & mmixedprecision;
+            }
         }
 
 };  // class PDFCalculator
@@ -210,6 +459,7 @@ class PDFCalculator :
 
 // Serialization -------------------------------------------------------------
 
+BOOST_CLASS_VERSION(diffpy::srreal::PDFCalculator, 6)
 BOOST_CLASS_EXPORT_KEY(diffpy::srreal::PDFCalculator)
 
 #endif  // PDFCALCULATOR_HPP_INCLUDED
@@ -0,0 +1,221 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PDFTrajectoryAccumulator -- running and windowed averages of the
+*     PDF and F(Q) over frames of a molecular dynamics trajectory
+*
+*****************************************************************************/
+
+#include <stdexcept>
+#include <algorithm>
+
+#include <diffpy/srreal/PDFTrajectoryAccumulator.hpp>
+#include <diffpy/validators.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+using namespace diffpy::validators;
+
+// Constructor ---------------------------------------------------------------
+
+PDFTrajectoryAccumulator::PDFTrajectoryAccumulator() :
+    mnblist(new NeighborListStructureAdapter),
+    mwindowsize(0),
+    mframecount(0),
+    mwindowcount(0)
+{ }
+
+// Public Methods ------------------------------------------------------------
+
+// configuration
+
+PDFCalculator& PDFTrajectoryAccumulator::getCalculator()
+{
+    return mcalculator;
+}
+
+
+const PDFCalculator& PDFTrajectoryAccumulator::getCalculator() const
+{
+    return mcalculator;
+}
+
+
+void PDFTrajectoryAccumulator::setSkin(double skin)
+{
+    mnblist->setSkin(skin);
+}
+
+
+const double& PDFTrajectoryAccumulator::getSkin() const
+{
+    return mnblist->getSkin();
+}
+
+
+void PDFTrajectoryAccumulator::setWindowSize(int windowsize)
+{
+    ensureNonNegative("windowsize", windowsize);
+    mwindowsize = windowsize;
+    mwindowcount = 0;
+    mwindowpdf = WindowAverage();
+    mwindowf = WindowAverage();
+}
+
+
+int PDFTrajectoryAccumulator::getWindowSize() const
+{
+    return mwindowsize;
+}
+
+// methods
+
+void PDFTrajectoryAccumulator::addFrame(StructureAdapterPtr frame)
+{
+    mnblist->setFrame(frame);
+    // the neighbor list adapter is the same object for all frames
+    mcalculator.setEvaluatorType(BASIC);
+    mcalculator.eval(mnblist);
+    const QuantityType pdf = mcalculator.getPDF();
+    const QuantityType f = mcalculator.getF();
+    if (mframecount && (pdf.size() != mpdf.size() || f.size() != mf.size()))
+    {
+        const char* emsg = "Frames must give the same r-grid and Q-grid.";
+        throw invalid_argument(emsg);
+    }
+    ++mframecount;
+    if (mframecount == 1)
+    {
+        mpdf = pdf;
+        mf = f;
+    }
+    else
+    {
+        const double w = 1.0 / mframecount;
+        for (size_t i = 0; i < pdf.size(); ++i)
+        {
+            mpdf[i] += w * (pdf[i] - mpdf[i]);
+        }
+        for (size_t i = 0; i < f.size(); ++i)
+        {
+            mf[i] += w * (f[i] - mf[i]);
+        }
+    }
+    if (mwindowsize == 0)  return;
+    ++mwindowcount;
+    this->addToWindow(mwindowpdf, pdf);
+    this->addToWindow(mwindowf, f);
+}
+
+
+void PDFTrajectoryAccumulator::reset()
+{
+    mframecount = 0;
+    mpdf.clear();
+    mf.clear();
+    this->setWindowSize(mwindowsize);
+}
+
+
+int PDFTrajectoryAccumulator::countFrames() const
+{
+    return mframecount;
+}
+
+
+int PDFTrajectoryAccumulator::countNeighborListBuilds() const
+{
+    return mnblist->countNeighborListBuilds();
+}
+
+// results
+
+const QuantityType& PDFTrajectoryAccumulator::getPDF() const
+{
+    return mpdf;
+}
+
+
+const QuantityType& PDFTrajectoryAccumulator::getF() const
+{
+    return mf;
+}
+
+
+QuantityType PDFTrajectoryAccumulator::getWindowPDF() const
+{
+    return this->windowAverage(mwindowpdf);
+}
+
+
+QuantityType PDFTrajectoryAccumulator::getWindowF() const
+{
+    return this->windowAverage(mwindowf);
+}
+
+
+QuantityType PDFTrajectoryAccumulator::getRgrid() const
+{
+    return mcalculator.getRgrid();
+}
+
+
+QuantityType PDFTrajectoryAccumulator::getQgrid() const
+{
+    return mcalculator.getQgrid();
+}
+
+// Private Methods -----------------------------------------------------------
+
+void PDFTrajectoryAccumulator::addToWindow(
+        WindowAverage& wavg, const QuantityType& y) const
+{
+    const size_t slot = (mwindowcount - 1) % mwindowsize;
+    if (slot == wavg.frames.size())
+    {
+        wavg.frames.push_back(y);
+        wavg.sum.resize(y.size(), 0.0);
+        for (size_t i = 0; i < y.size(); ++i)  wavg.sum[i] += y[i];
+        return;
+    }
+    // replace the oldest frame in place
+    QuantityType& yold = wavg.frames[slot];
+    for (size_t i = 0; i < y.size(); ++i)  wavg.sum[i] += y[i] - yold[i];
+    copy(y.begin(), y.end(), yold.begin());
+    // sum the window again once per cycle to limit rounding drift
+    if (slot != 0)  return;
+    fill(wavg.sum.begin(), wavg.sum.end(), 0.0);
+    for (const QuantityType& yk : wavg.frames)
+    {
+        for (size_t i = 0; i < yk.size(); ++i)  wavg.sum[i] += yk[i];
+    }
+}
+
+
+QuantityType PDFTrajectoryAccumulator::windowAverage(
+        const WindowAverage& wavg) const
+{
+    QuantityType rv = wavg.sum;
+    const int n = wavg.frames.size();
+    for (double& y : rv)  y /= n;
+    return rv;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,104 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PDFTrajectoryAccumulator -- running and windowed averages of the
+*     PDF and F(Q) over frames of a molecular dynamics trajectory
+*
+* Frames are evaluated by a PDFCalculator with bonds generated from
+* a NeighborListStructureAdapter, so that pairs are not searched again
+* while atoms move less than half of the neighbor list skin.  Frames can
+* be the same adapter object with positions updated in place.  The r-grid
+* and Q-grid of the averages follow the first frame and later frames must
+* give the same grids.
+*
+*****************************************************************************/
+
+#ifndef PDFTRAJECTORYACCUMULATOR_HPP_INCLUDED
+#define PDFTRAJECTORYACCUMULATOR_HPP_INCLUDED
+
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/NeighborListStructureAdapter.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class PDFTrajectoryAccumulator
+{
+    public:
+
+        // constructor
+        PDFTrajectoryAccumulator();
+
+        // configuration
+        /// calculator for the frames.  Frames are always evaluated with
+        /// the BASIC evaluator.
+        PDFCalculator& getCalculator();
+        const PDFCalculator& getCalculator() const;
+        /// margin of the neighbor list for atom displacements
+        void setSkin(double);
+        const double& getSkin() const;
+        /// number of the last frames in the windowed averages.
+        /// Changing the size restarts the windowed averages.
+        void setWindowSize(int);
+        int getWindowSize() const;
+
+        // methods
+        /// evaluate the next frame and add it to the averages
+        void addFrame(StructureAdapterPtr);
+        /// discard all frames from the averages
+        void reset();
+        int countFrames() const;
+        int countNeighborListBuilds() const;
+
+        // results
+        /// PDF averaged over all frames
+        const QuantityType& getPDF() const;
+        /// F(Q) averaged over all frames
+        const QuantityType& getF() const;
+        /// PDF averaged over the last window size frames
+        QuantityType getWindowPDF() const;
+        /// F(Q) averaged over the last window size frames
+        QuantityType getWindowF() const;
+        QuantityType getRgrid() const;
+        QuantityType getQgrid() const;
+
+    private:
+
+        // types
+        struct WindowAverage
+        {
+            std::vector<QuantityType> frames;
+            QuantityType sum;
+        };
+
+        // data
+        PDFCalculator mcalculator;
+        NeighborListStructureAdapterPtr mnblist;
+        int mwindowsize;
+        int mframecount;
+        int mwindowcount;
+        QuantityType mpdf;
+        QuantityType mf;
+        WindowAverage mwindowpdf;
+        WindowAverage mwindowf;
+
+        // methods
+        void addToWindow(WindowAverage&, const QuantityType&) const;
+        QuantityType windowAverage(const WindowAverage&) const;
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PDFTRAJECTORYACCUMULATOR_HPP_INCLUDED
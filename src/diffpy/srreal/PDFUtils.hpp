@@ -34,6 +34,7 @@ namespace srreal {
 const double DEFAULT_PDFCALCULATOR_RMAX = 10.0;
 const double DEFAULT_PDFCALCULATOR_RSTEP = 0.01;
 const double DEFAULT_PDFCALCULATOR_MAXEXTENSION = 10.0;
+const double DEFAULT_PDFCALCULATOR_FFTSPLITDISTANCE = 5.0;
 /// Default peak precision was obtained from the tunePeakPrecision.py script
 /// and it was tuned to give average zero slope in the difference curve
 /// between pdffit2 and PDFCalculator results.
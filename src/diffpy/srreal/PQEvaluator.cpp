@@ -159,6 +159,18 @@ bool PQEvaluatorBasic::isParallel() const
     return mncpu > 1;
 }
 
+
+MemoryUsage PQEvaluatorBasic::memoryUsage() const
+{
+    return MemoryUsage();
+}
+
+
+MemoryUsage PQEvaluatorBasic::estimateMemoryUsage(StructureAdapterPtr) const
+{
+    return MemoryUsage();
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // class PQEvaluatorOptimized
 //////////////////////////////////////////////////////////////////////////////
@@ -185,15 +197,24 @@ void PQEvaluatorOptimized::updateValue(
     // if PairQuantity uses mask
     if (pq.ticker() >= mvalue_ticker || !mlast_structure)
     {
+        if (this->replayCachedPairs(pq, stru))  return;
         return this->updateValueCompletely(pq, stru);
     }
-    // do not do fast updates if they take more work
     StructureDifference sd = mlast_structure->diff(stru);
+    // changes of lattice, displacement parameters or occupancies
+    // can reuse the cached pair data
+    const bool cachedpairs =
+        (sd.diffmethod == StructureDifference::Method::LATTICE) ||
+        sd.displacementonly() || sd.occupancyonly();
+    if (cachedpairs && this->replayChangedPairs(pq, stru, sd))  return;
+    // do not do fast updates if they take more work
     if (!sd.allowsfastupdate())
     {
         return this->updateValueCompletely(pq, stru);
     }
-    if ((this->getFlag(FIXEDSITEINDEX) || pq.hasPairMask()) &&
+    const bool fixedsiteindex = this->getFlag(FIXEDSITEINDEX) ||
+        pq.hasPairMask() || pq.requiresFixedSiteIndex();
+    if (fixedsiteindex &&
             sd.diffmethod != StructureDifference::Method::SIDEBYSIDE)
     {
         return this->updateValueCompletely(pq, stru);
@@ -298,6 +319,57 @@ void PQEvaluatorOptimized::updateValue(
 }
 
 
+MemoryUsage PQEvaluatorOptimized::memoryUsage() const
+{
+    MemoryUsage rv;
+    if (mlast_structure)
+    {
+        rv.add(mlast_structure->memoryUsage(), "laststructure.");
+    }
+    return rv;
+}
+
+
+MemoryUsage
+PQEvaluatorOptimized::estimateMemoryUsage(StructureAdapterPtr stru) const
+{
+    // the evaluator keeps a copy of the last structure for comparison
+    MemoryUsage rv;
+    rv.add(stru->memoryUsage(), "laststructure.");
+    return rv;
+}
+
+
+bool PQEvaluatorOptimized::replayCachedPairs(
+        PairQuantity& pq, StructureAdapterPtr stru)
+{
+    // cached pair data are only valid for the same structure
+    if (!mlast_structure || !pq.hasCachedPairs())  return false;
+    StructureDifference sd = mlast_structure->diff(stru);
+    if (!sd.pop0.empty() || !sd.add1.empty())  return false;
+    if (!pq.replayPairContributions(stru))  return false;
+    mvalue_ticker.click();
+    return true;
+}
+
+
+bool PQEvaluatorOptimized::replayChangedPairs(PairQuantity& pq,
+        StructureAdapterPtr stru, const StructureDifference& sd)
+{
+    if (!pq.hasCachedPairs())  return false;
+    // pq may be left in a partial state when replay fails
+    if (!pq.replayChangedPairs(stru, sd) ||
+            pq.ticker() >= mvalue_ticker)
+    {
+        this->updateValueCompletely(pq, stru);
+        return true;
+    }
+    mlast_structure = pq.getStructure()->clone();
+    mvalue_ticker.click();
+    return true;
+}
+
+
 void PQEvaluatorOptimized::updateValueCompletely(
         PairQuantity& pq, StructureAdapterPtr stru)
 {
@@ -70,6 +70,11 @@ class PQEvaluatorBasic
         bool getFlag(PQEvaluatorFlag flag) const;
         void setupParallelRun(int cpuindex, int ncpu);
         bool isParallel() const;
+        /// heap memory held by the evaluator
+        virtual MemoryUsage memoryUsage() const;
+        /// heap memory the evaluator would hold after evaluation
+        /// of the specified structure
+        virtual MemoryUsage estimateMemoryUsage(StructureAdapterPtr) const;
 
     protected:
 
@@ -106,13 +111,18 @@ class PQEvaluatorOptimized : public PQEvaluatorBasic
         virtual PQEvaluatorType typeint() const;
         virtual void validate(PairQuantity&) const;
         virtual void updateValue(PairQuantity&, StructureAdapterPtr);
+        virtual MemoryUsage memoryUsage() const;
+        virtual MemoryUsage estimateMemoryUsage(StructureAdapterPtr) const;
 
     private:
 
         // data
         StructureAdapterPtr mlast_structure;
 
-        // helper method
+        // helper methods
+        bool replayCachedPairs(PairQuantity&, StructureAdapterPtr);
+        bool replayChangedPairs(PairQuantity&, StructureAdapterPtr,
+                const StructureDifference&);
         void updateValueCompletely(PairQuantity&, StructureAdapterPtr);
 
         // serialization
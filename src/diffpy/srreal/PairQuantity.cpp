@@ -337,6 +337,33 @@ bool PairQuantity::getTypeMask(const string& smbli, const string& smblj) const
     return rv;
 }
 
+
+MemoryUsage PairQuantity::memoryUsage() const
+{
+    MemoryUsage rv;
+    rv.add("value", byteSize(mvalue));
+    size_t maskbytes = byteSize(minvertpairmask) +
+        byteSize(msiteallmask) + byteSize(mtypemask);
+    rv.add("masks", maskbytes);
+    rv.add(mstructure->memoryUsage(), "structure.");
+    rv.add(mevaluator->memoryUsage(), "evaluator.");
+    return rv;
+}
+
+
+MemoryUsage PairQuantity::estimateMemoryUsage(StructureAdapterPtr stru) const
+{
+    if (!stru)  stru = emptyStructureAdapter();
+    MemoryUsage rv;
+    // current mask data, these may grow when expanded for the new sites
+    size_t maskbytes = byteSize(minvertpairmask) +
+        byteSize(msiteallmask) + byteSize(mtypemask);
+    rv.add("masks", maskbytes);
+    rv.add(stru->memoryUsage(), "structure.");
+    rv.add(mevaluator->estimateMemoryUsage(stru), "evaluator.");
+    return rv;
+}
+
 // Protected Methods ---------------------------------------------------------
 
 void PairQuantity::resizeValue(size_t sz)
@@ -374,6 +401,13 @@ void PairQuantity::executeParallelMerge(const string& pdata)
 }
 
 
+vector<QuantityType*> PairQuantity::getParallelSumArrays()
+{
+    vector<QuantityType*> rv(1, &mvalue);
+    return rv;
+}
+
+
 int PairQuantity::countSites() const
 {
     int rv = mstructure.get() ? mstructure->countSites() : 0;
@@ -417,6 +451,36 @@ void PairQuantity::restorePartialValue()
     throw logic_error(emsg);
 }
 
+
+bool PairQuantity::requiresFixedSiteIndex() const
+{
+    return false;
+}
+
+
+bool PairQuantity::hasCachedPairs() const
+{
+    return false;
+}
+
+
+bool PairQuantity::replayPairContributions(StructureAdapterPtr)
+{
+    const char* emsg =
+        "replayPairContributions(StructureAdapterPtr) is not defined "
+        "in the calculator class.";
+    throw logic_error(emsg);
+}
+
+
+bool PairQuantity::replayChangedPairs(
+        StructureAdapterPtr, const StructureDifference&)
+{
+    const char* emsg =
+        "replayChangedPairs() is not defined in the calculator class.";
+    throw logic_error(emsg);
+}
+
 // Private Methods -----------------------------------------------------------
 
 void PairQuantity::updateMaskData()
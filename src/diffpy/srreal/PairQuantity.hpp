@@ -77,6 +77,17 @@ class PairQuantity : public diffpy::Attributes
         void setTypeMask(std::string, std::string, bool mask);
         bool getTypeMask(const std::string&, const std::string&) const;
 
+        // memory footprint
+        /// heap memory held by the calculator split per data component.
+        /// Components of the structure and evaluator objects are prefixed
+        /// with "structure." and "evaluator.".
+        virtual MemoryUsage memoryUsage() const;
+        /// estimate of the memoryUsage after evaluation of the structure
+        /// in the current configuration without doing the calculation.
+        /// The "transient" component is the peak memory of temporary
+        /// arrays used when retrieving results.
+        virtual MemoryUsage estimateMemoryUsage(StructureAdapterPtr) const;
+
         // ticker for any updates in configuration
         virtual eventticker::EventTicker& ticker() const  { return mticker; }
 
@@ -84,6 +95,7 @@ class PairQuantity : public diffpy::Attributes
 
         friend class PQEvaluatorBasic;
         friend class PQEvaluatorOptimized;
+        friend class MPIEvaluator;
         friend StructureAdapterPtr
             replacePairQuantityStructure(PairQuantity&, StructureAdapterPtr);
 
@@ -93,14 +105,22 @@ class PairQuantity : public diffpy::Attributes
         virtual void configureBondGenerator(BaseBondGenerator&) const;
         virtual void addPairContribution(const BaseBondGenerator&, int) { }
         virtual void executeParallelMerge(const std::string& pdata);
+        /// partial result arrays that executeParallelMerge adds together.
+        /// Empty when the parallel data are merged in some other way.
+        virtual std::vector<QuantityType*> getParallelSumArrays();
         virtual void finishValue() { }
         int countSites() const;
         // support methods for PQEvaluatorOptimized
         bool hasMask() const;
         bool hasPairMask() const;
         bool hasTypeMask() const;
+        virtual bool requiresFixedSiteIndex() const;
         virtual void stashPartialValue();
         virtual void restorePartialValue();
+        virtual bool hasCachedPairs() const;
+        virtual bool replayPairContributions(StructureAdapterPtr);
+        virtual bool replayChangedPairs(StructureAdapterPtr,
+                const StructureDifference&);
 
         // data
         typedef std::unordered_set<
@@ -0,0 +1,358 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PairQuantityPipeline -- asynchronous evaluation of PairQuantity
+*     calculators in a pool of worker threads
+*
+*****************************************************************************/
+
+#include <cassert>
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#include <diffpy/srreal/PairQuantityPipeline.hpp>
+#include <diffpy/srreal/PairQuantity.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Shared State --------------------------------------------------------------
+
+struct PairQuantityPipeline::Task
+{
+    enum Stage {WAITING, LOADING, LOADED, RUNNING, DONE};
+
+    PairQuantity* calculator;
+    StructureAdapterPtr structure;
+    StructureLoader loader;
+    ResultGetter getter;
+    Stage stage;
+    promise<QuantityType> result;
+};
+
+
+struct PairQuantityPipeline::Scheduler
+{
+    // data
+    mutex lock;
+    /// signals the workers that a task may be available
+    condition_variable workready;
+    /// signals the submitters and waiters that a task left the queue
+    condition_variable changed;
+    /// tasks that have not started evaluation in the submission order
+    deque<TaskPtr> queue;
+    /// calculators that are being evaluated
+    unordered_set<const PairQuantity*> busy;
+    int maxqueued;
+    int unfinished;
+    bool stopped;
+    vector<thread> workers;
+
+    // methods, all but work must be called with the lock held
+    void work();
+    TaskPtr nextTask();
+    void complete(TaskPtr, const QuantityType&, exception_ptr);
+    bool cancel(TaskPtr);
+};
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+const char* EMSGCANCELLED = "Evaluation was cancelled.";
+
+}   // namespace
+
+// Scheduler Methods ---------------------------------------------------------
+
+void PairQuantityPipeline::Scheduler::work()
+{
+    unique_lock<mutex> lck(lock);
+    while (true)
+    {
+        TaskPtr task;
+        workready.wait(lck,
+                [&]() { return (task = this->nextTask()) || stopped; });
+        if (!task)  return;
+        exception_ptr err;
+        // load the structure and return the task to the queue
+        if (task->stage == Task::LOADING)
+        {
+            StructureAdapterPtr stru;
+            lck.unlock();
+            try {
+                stru = task->loader();
+            }
+            catch (...) {
+                err = current_exception();
+            }
+            lck.lock();
+            task->loader = nullptr;
+            // skip tasks cancelled during the loading
+            if (task->stage != Task::LOADING)  continue;
+            if (err)
+            {
+                queue.erase(find(queue.begin(), queue.end(), task));
+                this->complete(task, QuantityType(), err);
+                continue;
+            }
+            task->structure = stru;
+            task->stage = Task::LOADED;
+            workready.notify_all();
+            continue;
+        }
+        // evaluate task that was already removed from the queue
+        assert(task->stage == Task::RUNNING);
+        QuantityType value;
+        lck.unlock();
+        try {
+            PairQuantity& pq = *(task->calculator);
+            pq.eval(task->structure);
+            value = task->getter ? task->getter(pq) : pq.value();
+        }
+        catch (...) {
+            err = current_exception();
+        }
+        lck.lock();
+        busy.erase(task->calculator);
+        this->complete(task, value, err);
+        // the next task of the same calculator can run now
+        workready.notify_all();
+    }
+}
+
+
+PairQuantityPipeline::TaskPtr
+PairQuantityPipeline::Scheduler::nextTask()
+{
+    // evaluate the first loaded task whose calculator has no earlier task
+    unordered_set<const PairQuantity*> blocked(busy);
+    deque<TaskPtr>::iterator tsk = queue.begin();
+    for (; tsk != queue.end(); ++tsk)
+    {
+        const PairQuantity* pq = (*tsk)->calculator;
+        if ((*tsk)->stage == Task::LOADED && !blocked.count(pq))
+        {
+            TaskPtr rv = *tsk;
+            queue.erase(tsk);
+            busy.insert(pq);
+            rv->stage = Task::RUNNING;
+            changed.notify_all();
+            return rv;
+        }
+        blocked.insert(pq);
+    }
+    // otherwise load the first structure that is not loaded yet
+    for (tsk = queue.begin(); tsk != queue.end(); ++tsk)
+    {
+        if ((*tsk)->stage != Task::WAITING)  continue;
+        (*tsk)->stage = Task::LOADING;
+        return *tsk;
+    }
+    return TaskPtr();
+}
+
+
+void PairQuantityPipeline::Scheduler::complete(
+        TaskPtr task, const QuantityType& value, exception_ptr err)
+{
+    assert(task->stage != Task::DONE);
+    task->stage = Task::DONE;
+    task->structure.reset();
+    task->getter = nullptr;
+    if (err)  task->result.set_exception(err);
+    else  task->result.set_value(value);
+    --unfinished;
+    changed.notify_all();
+}
+
+
+bool PairQuantityPipeline::Scheduler::cancel(TaskPtr task)
+{
+    if (task->stage == Task::RUNNING || task->stage == Task::DONE)
+    {
+        return false;
+    }
+    queue.erase(find(queue.begin(), queue.end(), task));
+    exception_ptr err = make_exception_ptr(runtime_error(EMSGCANCELLED));
+    this->complete(task, QuantityType(), err);
+    // removal may unblock later tasks of the same calculator
+    workready.notify_all();
+    return true;
+}
+
+// class PairQuantityPipeline::Handle ----------------------------------------
+
+PairQuantityPipeline::Handle::Handle()
+{ }
+
+
+bool PairQuantityPipeline::Handle::ready() const
+{
+    return mresult.valid() &&
+        mresult.wait_for(chrono::seconds(0)) == future_status::ready;
+}
+
+
+void PairQuantityPipeline::Handle::wait() const
+{
+    mresult.wait();
+}
+
+
+QuantityType PairQuantityPipeline::Handle::get() const
+{
+    return mresult.get();
+}
+
+
+bool PairQuantityPipeline::Handle::cancel()
+{
+    if (!mtask)  return false;
+    lock_guard<mutex> lck(mscheduler->lock);
+    return mscheduler->cancel(mtask);
+}
+
+// Constructor ---------------------------------------------------------------
+
+PairQuantityPipeline::PairQuantityPipeline(int nthreads, int maxqueued)
+{
+    if (nthreads < 1)
+    {
+        const char* emsg = "Number of threads must be at least 1.";
+        throw invalid_argument(emsg);
+    }
+    if (maxqueued < 1)
+    {
+        const char* emsg = "Queue size maxqueued must be at least 1.";
+        throw invalid_argument(emsg);
+    }
+    mscheduler.reset(new Scheduler);
+    mscheduler->maxqueued = maxqueued;
+    mscheduler->unfinished = 0;
+    mscheduler->stopped = false;
+    Scheduler* sched = mscheduler.get();
+    for (int k = 0; k < nthreads; ++k)
+    {
+        mscheduler->workers.push_back(thread([sched]() { sched->work(); }));
+    }
+}
+
+
+PairQuantityPipeline::~PairQuantityPipeline()
+{
+    {
+        lock_guard<mutex> lck(mscheduler->lock);
+        mscheduler->stopped = true;
+        while (!mscheduler->queue.empty())
+        {
+            mscheduler->cancel(mscheduler->queue.front());
+        }
+        mscheduler->workready.notify_all();
+    }
+    for (auto&& w : mscheduler->workers)  w.join();
+}
+
+// Public Methods ------------------------------------------------------------
+
+PairQuantityPipeline::Handle
+PairQuantityPipeline::submit(PairQuantity& pq, StructureAdapterPtr stru,
+        ResultGetter getter)
+{
+    return this->enqueue(pq, stru, nullptr, getter);
+}
+
+
+PairQuantityPipeline::Handle
+PairQuantityPipeline::submit(PairQuantity& pq, StructureLoader loader,
+        ResultGetter getter)
+{
+    if (!loader)
+    {
+        const char* emsg = "Structure loader must be callable.";
+        throw invalid_argument(emsg);
+    }
+    return this->enqueue(pq, StructureAdapterPtr(), loader, getter);
+}
+
+
+void PairQuantityPipeline::cancelAll()
+{
+    lock_guard<mutex> lck(mscheduler->lock);
+    while (!mscheduler->queue.empty())
+    {
+        mscheduler->cancel(mscheduler->queue.front());
+    }
+}
+
+
+void PairQuantityPipeline::waitAll() const
+{
+    unique_lock<mutex> lck(mscheduler->lock);
+    mscheduler->changed.wait(lck,
+            [this]() { return mscheduler->unfinished == 0; });
+}
+
+
+int PairQuantityPipeline::countQueued() const
+{
+    lock_guard<mutex> lck(mscheduler->lock);
+    return mscheduler->queue.size();
+}
+
+
+int PairQuantityPipeline::countThreads() const
+{
+    return mscheduler->workers.size();
+}
+
+// Private Methods -----------------------------------------------------------
+
+PairQuantityPipeline::Handle
+PairQuantityPipeline::enqueue(PairQuantity& pq, StructureAdapterPtr stru,
+        StructureLoader loader, ResultGetter getter)
+{
+    TaskPtr task(new Task);
+    task->calculator = &pq;
+    task->structure = stru;
+    task->loader = loader;
+    task->getter = getter;
+    task->stage = loader ? Task::WAITING : Task::LOADED;
+    Handle rv;
+    rv.mtask = task;
+    rv.mscheduler = mscheduler;
+    rv.mresult = task->result.get_future().share();
+    // block while the queue is full
+    unique_lock<mutex> lck(mscheduler->lock);
+    const size_t maxqueued = mscheduler->maxqueued;
+    mscheduler->changed.wait(lck,
+            [&]() { return mscheduler->queue.size() < maxqueued; });
+    mscheduler->queue.push_back(task);
+    ++(mscheduler->unfinished);
+    mscheduler->workready.notify_all();
+    return rv;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
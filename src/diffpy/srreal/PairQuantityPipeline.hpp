@@ -0,0 +1,141 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class PairQuantityPipeline -- asynchronous evaluation of PairQuantity
+*     calculators in a pool of worker threads
+*
+* Tasks are submitted with a calculator and a structure, or with a loader
+* function that produces the structure in a worker thread.  The submit
+* methods return a Handle that gives the result of the task once it is
+* done.  Structures of later tasks are loaded while earlier tasks are
+* evaluated, and tasks of different calculators are evaluated in parallel.
+* Tasks of the same calculator run one at a time in the submission order,
+* therefore the OPTIMIZED evaluator can update from the previous task.
+*
+* The number of tasks that wait for evaluation is bounded by the maxqueued
+* argument of the constructor.  The submit methods block when the queue
+* is full, which limits the memory taken by loaded structures.
+*
+* Calculators must not be used or destroyed by the caller while they have
+* unfinished tasks.  Tasks of different calculators may use the same
+* structure object.  CrystalStructureAdapter builds its symmetry positions
+* on first use, call its updateSymmetryPositions before sharing.
+*
+*****************************************************************************/
+
+#ifndef PAIRQUANTITYPIPELINE_HPP_INCLUDED
+#define PAIRQUANTITYPIPELINE_HPP_INCLUDED
+
+#include <functional>
+#include <future>
+#include <boost/shared_ptr.hpp>
+
+#include <diffpy/srreal/QuantityType.hpp>
+#include <diffpy/srreal/forwardtypes.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class PairQuantity;
+
+class PairQuantityPipeline
+{
+    private:
+
+        // forward declarations of the shared state
+        struct Task;
+        struct Scheduler;
+        typedef boost::shared_ptr<Task> TaskPtr;
+        typedef boost::shared_ptr<Scheduler> SchedulerPtr;
+
+    public:
+
+        // types
+        /// function that produces the structure for a task
+        typedef std::function<StructureAdapterPtr()> StructureLoader;
+        /// function that extracts the result from an evaluated calculator.
+        /// It runs in the worker thread right after the evaluation.
+        typedef std::function<QuantityType(PairQuantity&)> ResultGetter;
+
+        /// @class Handle
+        /// @brief result of a submitted task
+        class Handle
+        {
+            public:
+
+                // constructor
+                Handle();
+
+                // methods
+                /// true when the task is finished, cancelled or failed
+                bool ready() const;
+                /// block until the task is ready
+                void wait() const;
+                /// result of the task.  Rethrow the exception of a failed
+                /// task or throw runtime_error for a cancelled one.
+                QuantityType get() const;
+                /// remove task from the queue if it has not started
+                /// evaluation.  Return true if the task was cancelled.
+                bool cancel();
+
+            private:
+
+                friend class PairQuantityPipeline;
+
+                // data
+                TaskPtr mtask;
+                SchedulerPtr mscheduler;
+                std::shared_future<QuantityType> mresult;
+        };
+
+        // constructor and destructor
+        PairQuantityPipeline(int nthreads, int maxqueued);
+        /// cancel the queued tasks and wait for the running ones
+        ~PairQuantityPipeline();
+
+        // methods
+        /// queue evaluation of the calculator for the structure
+        Handle submit(PairQuantity&, StructureAdapterPtr,
+                ResultGetter getter=ResultGetter());
+        /// queue evaluation of the calculator for a structure that is
+        /// produced by the loader in a worker thread
+        Handle submit(PairQuantity&, StructureLoader,
+                ResultGetter getter=ResultGetter());
+        /// cancel all tasks that have not started evaluation
+        void cancelAll();
+        /// block until all submitted tasks are ready
+        void waitAll() const;
+        /// number of tasks that have not started evaluation
+        int countQueued() const;
+        /// number of worker threads
+        int countThreads() const;
+
+    private:
+
+        // data
+        SchedulerPtr mscheduler;
+
+        // disable copying
+        PairQuantityPipeline(const PairQuantityPipeline&);
+        PairQuantityPipeline& operator=(const PairQuantityPipeline&);
+
+        // methods
+        Handle enqueue(PairQuantity&, StructureAdapterPtr,
+                StructureLoader, ResultGetter);
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PAIRQUANTITYPIPELINE_HPP_INCLUDED
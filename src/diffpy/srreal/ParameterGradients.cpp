@@ -0,0 +1,158 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class ParameterGradients -- resolve names of parameters for analytical
+*     derivatives of pair quantities with respect to peak widths
+*
+*****************************************************************************/
+
+#include <stdexcept>
+
+#include <diffpy/srreal/ParameterGradients.hpp>
+#include <diffpy/srreal/StructureAdapter.hpp>
+#include <diffpy/srreal/PeakWidthModel.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// Parse displacement parameter name in the form "Uiso:T" or "Ukl:T".
+/// Return false for other names, i.e., the peak width attributes.
+bool _parseDisplacementParameter(const string& name,
+        int& k, int& l, string& atomtype)
+{
+    string::size_type colon = name.find(':');
+    if (colon == string::npos)  return false;
+    const string u = name.substr(0, colon);
+    atomtype = name.substr(colon + 1);
+    k = l = -1;
+    if (u == "Uiso")  return true;
+    const bool isuij = (u.size() == 3 && u[0] == 'U' &&
+            '1' <= u[1] && u[1] <= '3' && '1' <= u[2] && u[2] <= '3');
+    if (!isuij)
+    {
+        string emsg = "Invalid displacement parameter '" + name + "'.";
+        throw invalid_argument(emsg);
+    }
+    k = u[1] - '1';
+    l = u[2] - '1';
+    return true;
+}
+
+}   // namespace
+
+// Public Methods ------------------------------------------------------------
+
+void ParameterGradients::checkNames(const vector<string>& names)
+{
+    int k, l;
+    string atomtype;
+    vector<string>::const_iterator nm = names.begin();
+    for (; nm != names.end(); ++nm)
+    {
+        _parseDisplacementParameter(*nm, k, l, atomtype);
+    }
+}
+
+
+void ParameterGradients::resolve(const vector<string>& names,
+        StructureAdapterConstPtr stru, const PeakWidthModel& pwm)
+{
+    mparams.clear();
+    const int cntsites = stru->countSites();
+    vector<string>::const_iterator nm = names.begin();
+    for (; nm != names.end(); ++nm)
+    {
+        Parameter pm;
+        string atomtype;
+        pm.name = *nm;
+        pm.displacement =
+            _parseDisplacementParameter(*nm, pm.k, pm.l, atomtype);
+        if (!pm.displacement && !pwm.hasDoubleAttr(*nm))
+        {
+            string emsg = "Peak width model '" + pwm.type() +
+                "' has no parameter '" + *nm + "'.";
+            throw invalid_argument(emsg);
+        }
+        for (int i = 0; pm.displacement && i < cntsites; ++i)
+        {
+            const bool hastype = (stru->siteAtomType(i) == atomtype);
+            pm.sitemask.push_back(hastype);
+            if (!hastype || pm.k < 0)  continue;
+            // symmetry images have rotated Cartesian Uij
+            if (stru->siteAnisotropy(i) && stru->siteMultiplicity(i) == 1)
+            {
+                continue;
+            }
+            string emsg = "Derivatives for '" + *nm + "' require "
+                "anisotropic sites without symmetry expansion.";
+            throw invalid_argument(emsg);
+        }
+        mparams.push_back(pm);
+    }
+}
+
+
+bool ParameterGradients::usesBondDirections() const
+{
+    vector<Parameter>::const_iterator pm = mparams.begin();
+    for (; pm != mparams.end(); ++pm)
+    {
+        if (pm->displacement && pm->k >= 0)  return true;
+    }
+    return false;
+}
+
+
+bool ParameterGradients::widthDerivatives(const PeakWidthModel& pwm,
+        const BaseBondGenerator& bnds, double* dw) const
+{
+    const int i0 = bnds.site0();
+    const int i1 = bnds.site1();
+    bool rv = false;
+    vector<Parameter>::const_iterator pm = mparams.begin();
+    for (; pm != mparams.end(); ++pm, ++dw)
+    {
+        *dw = 0.0;
+        if (!pm->displacement)
+        {
+            *dw = pwm.derivativeAttr(pm->name, bnds);
+            rv = rv || (*dw != 0.0);
+            continue;
+        }
+        // bond msd is a sum of contributions from both sites
+        const int nsites = int(pm->sitemask[i0]) + int(pm->sitemask[i1]);
+        if (!nsites)  continue;
+        double dmsd = nsites;
+        if (pm->k >= 0)
+        {
+            const R3::Vector& s = bnds.r01();
+            dmsd *= s[pm->k] * s[pm->l] / R3::dot(s, s);
+            if (pm->k != pm->l)  dmsd *= 2;
+        }
+        *dw = pwm.derivativeMSD(bnds) * dmsd;
+        rv = rv || (*dw != 0.0);
+    }
+    return rv;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,77 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class ParameterGradients -- resolve names of parameters for analytical
+*     derivatives of pair quantities with respect to peak widths
+*
+* The parameters are double attributes of the peak width model or the
+* Cartesian displacement parameters "Uiso:T", "U11:T", ..., "U23:T" shared
+* by all sites of the atom type T.
+*
+*****************************************************************************/
+
+#ifndef PARAMETERGRADIENTS_HPP_INCLUDED
+#define PARAMETERGRADIENTS_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include <diffpy/srreal/forwardtypes.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class BaseBondGenerator;
+class PeakWidthModel;
+
+class ParameterGradients
+{
+    public:
+
+        // methods
+        /// check syntax of the parameter names, throw invalid_argument
+        static void checkNames(const std::vector<std::string>& names);
+        /// resolve parameter names for the structure and peak width model
+        void resolve(const std::vector<std::string>& names,
+                StructureAdapterConstPtr, const PeakWidthModel&);
+        /// number of the resolved parameters
+        int size() const  { return mparams.size(); }
+        bool empty() const  { return mparams.empty(); }
+        /// true when some derivatives depend on the bond direction
+        bool usesBondDirections() const;
+        /// store derivatives of the peak width in dw and return false
+        /// if they are all zero
+        bool widthDerivatives(const PeakWidthModel&,
+                const BaseBondGenerator&, double* dw) const;
+
+    private:
+
+        // types
+        struct Parameter {
+            std::string name;
+            bool displacement;
+            int k;
+            int l;
+            std::vector<bool> sitemask;
+        };
+
+        // data
+        std::vector<Parameter> mparams;
+
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // PARAMETERGRADIENTS_HPP_INCLUDED
@@ -16,6 +16,10 @@
 *
 *****************************************************************************/
 
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
 #include <diffpy/srreal/PeakProfile.hpp>
 #include <diffpy/HasClassRegistry.ipp>
 #include <diffpy/serialization.ipp>
@@ -27,13 +31,69 @@ template class HasClassRegistry<srreal::PeakProfile>;
 
 namespace srreal {
 
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// guard of table builds for profiles shared by parallel calculators
+std::mutex& tableBuildLock()
+{
+    static std::mutex lck;
+    return lck;
+}
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class PeakProfileTable
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+PeakProfileTable::PeakProfileTable() :
+    mxlo(0.0), minvstep(0.0), mlastindex(0.0), mprecise(false)
+{ }
+
+// Public Methods ------------------------------------------------------------
+
+bool PeakProfileTable::build(const PeakProfile& pkf)
+{
+    mticker = pkf.ticker();
+    mvalues.clear();
+    mxlo = pkf.xboundlo(1.0);
+    const double xhi = pkf.xboundhi(1.0);
+    minvstep = mlastindex = 0.0;
+    mprecise = false;
+    if (!(mxlo < xhi) || !std::isfinite(xhi - mxlo))  return mprecise;
+    // start with a coarse grid and refine while the midpoints deviate
+    for (int n = 64; 2 * n + 1 <= MAX_SIZE && !mprecise; n *= 2)
+    {
+        const double dx = (xhi - mxlo) / n;
+        mvalues.resize(n + 1);
+        for (int i = 0; i <= n; ++i)  mvalues[i] = pkf(mxlo + i * dx, 1.0);
+        double ymax = 0.0;
+        for (double y : mvalues)  ymax = std::max(ymax, fabs(y));
+        const double tolerance = pkf.getPrecision() * ymax;
+        mprecise = true;
+        for (int i = 0; i < n && mprecise; ++i)
+        {
+            const double y = pkf(mxlo + (i + 0.5) * dx, 1.0);
+            mprecise = fabs(y - 0.5 * (mvalues[i] + mvalues[i + 1])) <=
+                tolerance;
+        }
+    }
+    minvstep = (mvalues.size() - 1) / (xhi - mxlo);
+    mlastindex = mvalues.size() - 1;
+    return mprecise;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // class PeakProfile
 //////////////////////////////////////////////////////////////////////////////
 
 // Constructors --------------------------------------------------------------
 
-PeakProfile::PeakProfile() : mprecision(0.0)
+PeakProfile::PeakProfile() : mprecision(0.0), mtabulated(false)
 {
     this->registerDoubleAttribute("peakprecision",
             this, &PeakProfile::getPrecision, &PeakProfile::setPrecision);
@@ -53,6 +113,62 @@ const double& PeakProfile::getPrecision() const
     return mprecision;
 }
 
+
+void PeakProfile::setTabulated(bool flag)
+{
+    if (mtabulated != flag)  mticker.click();
+    mtabulated = flag;
+}
+
+
+bool PeakProfile::getTabulated() const
+{
+    return mtabulated;
+}
+
+
+PeakProfileTablePtr PeakProfile::table() const
+{
+    const eventticker::EventTicker& tic = this->ticker();
+    PeakProfileTablePtr tbl = boost::atomic_load(&mtable);
+    if (!tbl || tbl->ticker() < tic)
+    {
+        // tables are immutable once published, other threads may keep
+        // using the previous table while a new one is built
+        std::lock_guard<std::mutex> lck(tableBuildLock());
+        tbl = boost::atomic_load(&mtable);
+        if (!tbl || tbl->ticker() < tic)
+        {
+            boost::shared_ptr<PeakProfileTable> newtbl(new PeakProfileTable);
+            newtbl->build(*this);
+            tbl = newtbl;
+            boost::atomic_store(&mtable, tbl);
+        }
+    }
+    return tbl->isPrecise() ? tbl : PeakProfileTablePtr();
+}
+
+
+double PeakProfile::derivativeX(double x, double fwhm) const
+{
+    // central difference for profiles without analytical derivatives
+    const double h = 1e-6 * fwhm;
+    if (h <= 0.0)  return 0.0;
+    const PeakProfile& pkf = *this;
+    double rv = (pkf(x + h, fwhm) - pkf(x - h, fwhm)) / (2 * h);
+    return rv;
+}
+
+
+double PeakProfile::derivativeFWHM(double x, double fwhm) const
+{
+    const double h = 1e-6 * fwhm;
+    if (h <= 0.0)  return 0.0;
+    const PeakProfile& pkf = *this;
+    double rv = (pkf(x, fwhm + h) - pkf(x, fwhm - h)) / (2 * h);
+    return rv;
+}
+
 }   // namespace srreal
 }   // namespace diffpy
 
@@ -18,16 +18,29 @@
 *     Methods xboundlo(fwhm), xboundhi(fwhm) return low and high x-boundaries,
 *     where amplitude relative to the maximum becomes smaller than precision
 *     set by setPrecision().
+*     Methods derivativeX(x, fwhm) and derivativeFWHM(x, fwhm) return partial
+*     derivatives of the profile amplitude.
+*
+* class PeakProfileTable -- profile of unit width sampled on a grid for
+*     linear interpolation.  It assumes the profile shape scales with fwhm,
+*     i.e., pkf(x, fwhm) == pkf(x / fwhm, 1) / fwhm, which is the case for
+*     the Gaussian profiles.  Grid spacing is halved until the error at
+*     midpoints is below the profile precision relative to the maximum.
+*     Tables that do not reach the precision within MAX_SIZE points are
+*     not used and the peaks are evaluated by the profile instead.
 *
 *****************************************************************************/
 
 #ifndef PEAKPROFILE_HPP_INCLUDED
 #define PEAKPROFILE_HPP_INCLUDED
 
+#include <vector>
+
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/assume_abstract.hpp>
 #include <boost/serialization/export.hpp>
 #include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/version.hpp>
 
 #include <diffpy/Attributes.hpp>
 #include <diffpy/HasClassRegistry.hpp>
@@ -36,6 +49,54 @@
 namespace diffpy {
 namespace srreal {
 
+class PeakProfile;
+
+class PeakProfileTable
+{
+    public:
+
+        // constants
+        static const int MAX_SIZE = 1 << 18;
+
+        // constructor
+        PeakProfileTable();
+
+        // methods
+        /// sample the profile between its bounds at unit width,
+        /// return false when the table cannot reach the profile precision
+        bool build(const PeakProfile&);
+        /// interpolated profile value at x for the specified width
+        double operator()(double x, double fwhm) const
+        {
+            if (fwhm <= 0)  return 0.0;
+            const double u = (x / fwhm - mxlo) * minvstep;
+            if (!(u >= 0.0 && u < mlastindex))  return 0.0;
+            const int i = int(u);
+            const double f = u - i;
+            const double* y = mvalues.data() + i;
+            return (y[0] + f * (y[1] - y[0])) / fwhm;
+        }
+        /// number of sampled points
+        int size() const  { return mvalues.size(); }
+        /// true when the interpolation is within the profile precision
+        bool isPrecise() const  { return mprecise; }
+        /// state of the profile when the table was built
+        const eventticker::EventTicker& ticker() const  { return mticker; }
+
+    private:
+
+        // data
+        std::vector<double> mvalues;
+        double mxlo;
+        double minvstep;
+        double mlastindex;
+        bool mprecise;
+        eventticker::EventTicker mticker;
+};
+
+typedef boost::shared_ptr<const PeakProfileTable> PeakProfileTablePtr;
+
+
 class PeakProfile :
     public diffpy::Attributes,
     public diffpy::HasClassRegistry<PeakProfile>
@@ -48,9 +109,20 @@ class PeakProfile :
         virtual double operator()(double x, double fwhm) const = 0;
         virtual double xboundlo(double fwhm) const = 0;
         virtual double xboundhi(double fwhm) const = 0;
+        virtual double derivativeX(double x, double fwhm) const;
+        virtual double derivativeFWHM(double x, double fwhm) const;
         virtual void setPrecision(double eps);
         const double& getPrecision() const;
         virtual eventticker::EventTicker& ticker() const  { return mticker; }
+        /// evaluate peaks by interpolation in a table of the profile, which
+        /// is built on first use after every change.  This is faster for
+        /// profiles with expensive operator().  Disabled by default.
+        void setTabulated(bool);
+        bool getTabulated() const;
+        /// interpolation table of the current profile or a null pointer
+        /// when the table cannot reach the precision.  Safe to call from
+        /// parallel threads.
+        PeakProfileTablePtr table() const;
 
     protected:
 
@@ -61,6 +133,8 @@ class PeakProfile :
 
         // data
         double mprecision;
+        bool mtabulated;
+        mutable PeakProfileTablePtr mtable;
 
         // serialization
         friend class boost::serialization::access;
@@ -68,6 +142,9 @@ class PeakProfile :
             void serialize(Archive& ar, const unsigned int version)
         {
             ar & mticker & mprecision;
+            if (version >= 1) {
+                ar & mtabulated;
+            }
         }
 
 };
@@ -80,5 +157,6 @@ typedef PeakProfile::SharedPtr PeakProfilePtr;
 // Serialization -------------------------------------------------------------
 
 BOOST_SERIALIZATION_ASSUME_ABSTRACT(diffpy::srreal::PeakProfile)
+BOOST_CLASS_VERSION(diffpy::srreal::PeakProfile, 1)
 
 #endif  // PEAKPROFILE_HPP_INCLUDED
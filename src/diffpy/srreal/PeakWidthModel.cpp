@@ -16,12 +16,16 @@
 *
 *****************************************************************************/
 
+#include <stdexcept>
+
 #include <diffpy/srreal/PeakWidthModel.hpp>
 #include <diffpy/HasClassRegistry.ipp>
 #include <diffpy/validators.hpp>
 #include <diffpy/serialization.ipp>
 
 using std::string;
+using std::logic_error;
+using std::invalid_argument;
 using diffpy::validators::ensureNonNull;
 
 namespace diffpy {
@@ -31,6 +35,32 @@ template class HasClassRegistry<srreal::PeakWidthModel>;
 
 namespace srreal {
 
+// class PeakWidthModel ------------------------------------------------------
+
+double PeakWidthModel::derivativeDistance(const BaseBondGenerator&) const
+{
+    const char* emsg =
+        "derivativeDistance() is not defined in the peak width model.";
+    throw logic_error(emsg);
+}
+
+
+double PeakWidthModel::derivativeMSD(const BaseBondGenerator&) const
+{
+    const char* emsg =
+        "derivativeMSD() is not defined in the peak width model.";
+    throw logic_error(emsg);
+}
+
+
+double PeakWidthModel::derivativeAttr(
+        const string& name, const BaseBondGenerator&) const
+{
+    string emsg = "Peak width model '" + this->type() +
+        "' does not define derivative for '" + name + "'.";
+    throw invalid_argument(emsg);
+}
+
 // class PeakWidthModelOwner -------------------------------------------------
 
 void PeakWidthModelOwner::setPeakWidthModel(PeakWidthModelPtr pwm)
@@ -48,6 +48,13 @@ class PeakWidthModel :
         virtual double calculate(const BaseBondGenerator&) const = 0;
         virtual double maxWidth(StructureAdapterPtr,
                 double rmin, double rmax) const = 0;
+        /// derivative of calculate() with respect to the bond distance
+        virtual double derivativeDistance(const BaseBondGenerator&) const;
+        /// derivative of calculate() with respect to the bond msd
+        virtual double derivativeMSD(const BaseBondGenerator&) const;
+        /// derivative of calculate() with respect to a double attribute
+        virtual double derivativeAttr(const std::string& name,
+                const BaseBondGenerator&) const;
         virtual eventticker::EventTicker& ticker() const  { return mticker; }
 
     protected:
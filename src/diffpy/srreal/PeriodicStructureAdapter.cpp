@@ -31,6 +31,39 @@ using namespace std;
 namespace diffpy {
 namespace srreal {
 
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+/// Return true if the structures have the same atoms in fractional
+/// coordinates and the same Cartesian displacement parameters.
+bool sameFractionalAtoms(const PeriodicStructureAdapter& stru0,
+        const PeriodicStructureAdapter& stru1)
+{
+    // tolerate round-off from conversions by toFractional and toCartesian
+    const mathutils::EpsilonEqual allclose(1e-12);
+    const int cntsites = stru0.countSites();
+    if (cntsites != stru1.countSites())  return false;
+    const Lattice& L0 = stru0.getLattice();
+    const Lattice& L1 = stru1.getLattice();
+    R3::Vector f0;
+    for (int i = 0; i < cntsites; ++i)
+    {
+        const Atom& a0 = stru0[i];
+        const Atom& a1 = stru1[i];
+        bool same = (a0.atomtype == a1.atomtype) &&
+            (a0.occupancy == a1.occupancy) &&
+            (a0.anisotropy == a1.anisotropy) &&
+            allclose(a0.uij_cartn, a1.uij_cartn);
+        if (!same)  return false;
+        f0 = L0.fractional(a0.xyz_cartn);
+        if (!allclose(f0, L1.fractional(a1.xyz_cartn)))  return false;
+    }
+    return true;
+}
+
+}   // namespace
+
 //////////////////////////////////////////////////////////////////////////////
 // class PeriodicStructureAdapter
 //////////////////////////////////////////////////////////////////////////////
@@ -69,7 +102,17 @@ PeriodicStructureAdapter::diff(StructureAdapterConstPtr other) const
     PPtr pother = boost::dynamic_pointer_cast<PPtr::element_type>(other);
     if (!pother)  return sd;
     assert(pother == sd.stru1);
-    if (this->getLattice() != pother->getLattice())  return sd;
+    if (this->getLattice() != pother->getLattice())
+    {
+        if (sameFractionalAtoms(*this, *pother))
+        {
+            const Lattice& L0 = this->getLattice();
+            const Lattice& L1 = pother->getLattice();
+            sd.diffmethod = StructureDifference::Method::LATTICE;
+            sd.deformation = R3::prod(L0.recbase(), L1.base());
+        }
+        return sd;
+    }
     sd = this->AtomicStructureAdapter::diff(other);
     return sd;
 }
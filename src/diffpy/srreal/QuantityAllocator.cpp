@@ -0,0 +1,290 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Memory management for the QuantityType arrays.
+*
+*****************************************************************************/
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <new>
+
+#include <diffpy/srreal/QuantityAllocator.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+atomic<size_t> gallocations(0);
+atomic<size_t> gdeallocations(0);
+atomic<size_t> gnewbuffers(0);
+atomic<size_t> gallocatedbytes(0);
+atomic<size_t> gnewbytes(0);
+
+
+// The arena objects are intentionally never destroyed so that QuantityType
+// arrays with static storage can be safely released at program exit.
+
+QuantityArenaPtr& defaultArena()
+{
+    static QuantityArenaPtr* arena =
+        new QuantityArenaPtr(new HeapQuantityArena);
+    return *arena;
+}
+
+
+QuantityArenaPtr& arenaHolder()
+{
+    static QuantityArenaPtr* arena = new QuantityArenaPtr(defaultArena());
+    return *arena;
+}
+
+
+// Every buffer starts with a header that points to the arena which
+// allocated it.  Arenas are kept in arenaUses while active or while
+// they have outstanding buffers.
+
+struct ArenaUse
+{
+    QuantityArenaPtr arena;
+    size_t nbuffers;
+};
+
+typedef std::map<const QuantityArena*, ArenaUse> ArenaUses;
+
+ArenaUses& arenaUses()
+{
+    static ArenaUses* uses = new ArenaUses;
+    return *uses;
+}
+
+
+mutex& arenaLock()
+{
+    static mutex* lck = new mutex;
+    return *lck;
+}
+
+
+// size of the buffer header that keeps the alignment of operator new
+const size_t HEADER_SIZE = alignof(max_align_t);
+static_assert(sizeof(QuantityArena*) <= HEADER_SIZE,
+        "QuantityArena pointer does not fit in the buffer header.");
+
+
+/// register the active arena for a new buffer and return it
+QuantityArena* acquireActiveArena()
+{
+    lock_guard<mutex> lck(arenaLock());
+    const QuantityArenaPtr& arena = arenaHolder();
+    ArenaUse& use = arenaUses()[arena.get()];
+    if (!use.arena)  use.arena = arena;
+    ++use.nbuffers;
+    return arena.get();
+}
+
+
+/// unregister buffer of the arena, release arena that is no longer used
+void releaseArena(const QuantityArena* arena)
+{
+    QuantityArenaPtr unused;
+    lock_guard<mutex> lck(arenaLock());
+    ArenaUses::iterator ii = arenaUses().find(arena);
+    assert(ii != arenaUses().end() && ii->second.nbuffers > 0);
+    if (--(ii->second.nbuffers) > 0)  return;
+    if (ii->second.arena == arenaHolder())  return;
+    // destroy the arena after the lock is released
+    unused.swap(ii->second.arena);
+    arenaUses().erase(ii);
+}
+
+}   // namespace
+
+//////////////////////////////////////////////////////////////////////////////
+// class QuantityArena
+//////////////////////////////////////////////////////////////////////////////
+
+// Protected Methods ---------------------------------------------------------
+
+void QuantityArena::countNewBuffer(size_t nbytes)
+{
+    ++gnewbuffers;
+    gnewbytes += nbytes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class HeapQuantityArena
+//////////////////////////////////////////////////////////////////////////////
+
+// Public Methods ------------------------------------------------------------
+
+void* HeapQuantityArena::allocate(size_t nbytes)
+{
+    void* rv = ::operator new(nbytes);
+    this->countNewBuffer(nbytes);
+    return rv;
+}
+
+
+void HeapQuantityArena::deallocate(void* p, size_t nbytes)
+{
+    ::operator delete(p);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// class PooledQuantityArena
+//////////////////////////////////////////////////////////////////////////////
+
+// Constructor ---------------------------------------------------------------
+
+PooledQuantityArena::PooledQuantityArena() : mpooledbytes(0)
+{ }
+
+
+PooledQuantityArena::~PooledQuantityArena()
+{
+    this->release();
+}
+
+// Public Methods ------------------------------------------------------------
+
+void* PooledQuantityArena::allocate(size_t nbytes)
+{
+    {
+        lock_guard<mutex> lck(mlock);
+        FreeLists::iterator ii = mfreelists.find(nbytes);
+        if (ii != mfreelists.end() && !ii->second.empty())
+        {
+            void* rv = ii->second.back();
+            ii->second.pop_back();
+            mpooledbytes -= nbytes;
+            return rv;
+        }
+    }
+    void* rv = ::operator new(nbytes);
+    this->countNewBuffer(nbytes);
+    return rv;
+}
+
+
+void PooledQuantityArena::deallocate(void* p, size_t nbytes)
+{
+    lock_guard<mutex> lck(mlock);
+    mfreelists[nbytes].push_back(p);
+    mpooledbytes += nbytes;
+}
+
+
+void PooledQuantityArena::release()
+{
+    lock_guard<mutex> lck(mlock);
+    FreeLists::iterator ii;
+    for (ii = mfreelists.begin(); ii != mfreelists.end(); ++ii)
+    {
+        vector<void*>::iterator pp = ii->second.begin();
+        for (; pp != ii->second.end(); ++pp)  ::operator delete(*pp);
+    }
+    mfreelists.clear();
+    mpooledbytes = 0;
+}
+
+
+size_t PooledQuantityArena::pooledBytes() const
+{
+    lock_guard<mutex> lck(mlock);
+    return mpooledbytes;
+}
+
+// Functions -----------------------------------------------------------------
+
+void setQuantityArena(QuantityArenaPtr arena)
+{
+    if (!arena)  arena = defaultArena();
+    lock_guard<mutex> lck(arenaLock());
+    // previous arena is released here unless it has outstanding buffers
+    ArenaUses::iterator ii = arenaUses().find(arenaHolder().get());
+    if (ii != arenaUses().end() && ii->second.nbuffers == 0)
+    {
+        arenaUses().erase(ii);
+    }
+    arena.swap(arenaHolder());
+}
+
+
+QuantityArenaPtr getQuantityArena()
+{
+    lock_guard<mutex> lck(arenaLock());
+    return arenaHolder();
+}
+
+
+QuantityAllocationStats getQuantityAllocationStats()
+{
+    QuantityAllocationStats rv;
+    rv.allocations = gallocations;
+    rv.deallocations = gdeallocations;
+    rv.newbuffers = gnewbuffers;
+    rv.allocatedbytes = gallocatedbytes;
+    rv.newbytes = gnewbytes;
+    return rv;
+}
+
+
+void resetQuantityAllocationStats()
+{
+    gallocations = 0;
+    gdeallocations = 0;
+    gnewbuffers = 0;
+    gallocatedbytes = 0;
+    gnewbytes = 0;
+}
+
+
+void* allocateQuantityBuffer(size_t nbytes)
+{
+    ++gallocations;
+    gallocatedbytes += nbytes;
+    QuantityArena* arena = acquireActiveArena();
+    char* p;
+    try {
+        p = static_cast<char*>(arena->allocate(nbytes + HEADER_SIZE));
+    }
+    catch (...) {
+        releaseArena(arena);
+        throw;
+    }
+    *reinterpret_cast<QuantityArena**>(p) = arena;
+    return p + HEADER_SIZE;
+}
+
+
+void deallocateQuantityBuffer(void* p, size_t nbytes)
+{
+    ++gdeallocations;
+    char* pbuffer = static_cast<char*>(p) - HEADER_SIZE;
+    QuantityArena* arena = *reinterpret_cast<QuantityArena**>(pbuffer);
+    arena->deallocate(pbuffer, nbytes + HEADER_SIZE);
+    releaseArena(arena);
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
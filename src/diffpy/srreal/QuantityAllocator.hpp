@@ -0,0 +1,207 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Memory management for the QuantityType arrays.
+*
+* QuantityArena -- abstract source of memory buffers for QuantityType.
+*   The active arena can be replaced with setQuantityArena.
+* PooledQuantityArena -- arena that recycles released buffers of equal size
+* QuantityAllocator -- STL allocator that forwards to the active arena
+* QuantityAllocationStats -- counters of the QuantityType buffer requests
+*
+*****************************************************************************/
+
+#ifndef QUANTITYALLOCATOR_HPP_INCLUDED
+#define QUANTITYALLOCATOR_HPP_INCLUDED
+
+#include <cstddef>
+#include <map>
+#include <vector>
+#include <mutex>
+#include <boost/shared_ptr.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+/// @class QuantityArena
+/// @brief abstract source of memory buffers for the QuantityType arrays.
+/// Derived classes must call countNewBuffer for every buffer that was
+/// newly obtained from the system, i.e., not recycled.  Buffers are
+/// returned to the arena that allocated them, which is kept alive until
+/// all its buffers are released.  The requested sizes include a small
+/// header that identifies the arena.  The built-in arenas use the global
+/// operator new.
+
+class QuantityArena
+{
+    public:
+
+        // destructor
+        virtual ~QuantityArena()  { }
+
+        // methods
+        virtual void* allocate(size_t nbytes) = 0;
+        virtual void deallocate(void* p, size_t nbytes) = 0;
+
+    protected:
+
+        /// record allocation of a fresh memory buffer of nbytes
+        static void countNewBuffer(size_t nbytes);
+};
+
+typedef boost::shared_ptr<QuantityArena> QuantityArenaPtr;
+
+
+/// @class HeapQuantityArena
+/// @brief default arena that uses the global operator new and delete.
+
+class HeapQuantityArena : public QuantityArena
+{
+    public:
+
+        // methods
+        void* allocate(size_t nbytes);
+        void deallocate(void* p, size_t nbytes);
+};
+
+
+/// @class PooledQuantityArena
+/// @brief arena that keeps released buffers for reuse by subsequent
+/// requests of the same size.  Once warmed up, repeated evaluations
+/// with the same r-grid allocate no new memory.
+
+class PooledQuantityArena : public QuantityArena
+{
+    public:
+
+        // constructor and destructor
+        PooledQuantityArena();
+        ~PooledQuantityArena();
+
+        // methods
+        void* allocate(size_t nbytes);
+        void deallocate(void* p, size_t nbytes);
+        /// free all pooled buffers that are not in use
+        void release();
+        /// total size of the pooled buffers that are not in use
+        size_t pooledBytes() const;
+
+    private:
+
+        // types
+        typedef std::map<size_t, std::vector<void*> > FreeLists;
+
+        // data
+        FreeLists mfreelists;
+        size_t mpooledbytes;
+        mutable std::mutex mlock;
+};
+
+
+/// @class QuantityAllocationStats
+/// @brief counts of buffer requests from the QuantityType arrays
+
+class QuantityAllocationStats
+{
+    public:
+
+        // constructor
+        QuantityAllocationStats() :
+            allocations(0), deallocations(0), newbuffers(0),
+            allocatedbytes(0), newbytes(0)
+        { }
+
+        // data
+        /// number of buffers handed out to QuantityType arrays
+        size_t allocations;
+        /// number of buffers returned by QuantityType arrays
+        size_t deallocations;
+        /// number of buffers newly obtained by the arena
+        size_t newbuffers;
+        /// total size of buffers handed out to QuantityType arrays
+        size_t allocatedbytes;
+        /// total size of buffers newly obtained by the arena
+        size_t newbytes;
+};
+
+// Functions -----------------------------------------------------------------
+
+/// replace the arena for QuantityType buffers, restore default when NULL.
+/// The previous arena is released once its outstanding buffers are freed.
+void setQuantityArena(QuantityArenaPtr arena);
+
+/// return the arena currently used for QuantityType buffers
+QuantityArenaPtr getQuantityArena();
+
+/// return counts of QuantityType buffer requests since the last reset
+QuantityAllocationStats getQuantityAllocationStats();
+
+/// reset the counts of QuantityType buffer requests to zero
+void resetQuantityAllocationStats();
+
+/// allocate QuantityType buffer from the active arena
+void* allocateQuantityBuffer(size_t nbytes);
+
+/// return QuantityType buffer to the arena that allocated it
+void deallocateQuantityBuffer(void* p, size_t nbytes);
+
+
+/// @class QuantityAllocator
+/// @brief STL allocator that obtains memory from the active QuantityArena
+
+template <class T>
+class QuantityAllocator
+{
+    public:
+
+        // types
+        typedef T value_type;
+
+        // constructors
+        QuantityAllocator()  { }
+        template <class U>
+            QuantityAllocator(const QuantityAllocator<U>&)  { }
+
+        // methods
+        T* allocate(size_t n)
+        {
+            void* p = allocateQuantityBuffer(n * sizeof(T));
+            return static_cast<T*>(p);
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            deallocateQuantityBuffer(p, n * sizeof(T));
+        }
+
+};
+
+
+template <class T, class U>
+bool operator==(const QuantityAllocator<T>&, const QuantityAllocator<U>&)
+{
+    return true;
+}
+
+
+template <class T, class U>
+bool operator!=(const QuantityAllocator<T>&, const QuantityAllocator<U>&)
+{
+    return false;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // QUANTITYALLOCATOR_HPP_INCLUDED
@@ -15,8 +15,12 @@
 * Shared types and small functions used by PairQuantity calculators.
 *
 * QuantityType -- type that stores PairQuantity results, an array of doubles
-*   It is a unique derived class from vector<double> to avoid conflicts with
-*   boost_python convertors in cctbx.
+*   It is a unique derived class from vector<double, QuantityAllocator> to
+*   avoid conflicts with boost_python convertors in cctbx.  The array memory
+*   is obtained from the QuantityArena set with setQuantityArena.
+*   Since version 1.5 QuantityType is not derived from std::vector<double>
+*   and it cannot be bound to std::vector<double> references or pointers.
+*   Conversions from and to std::vector<double> copy the array.
 *
 *****************************************************************************/
 
@@ -25,26 +29,36 @@
 
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/vector.hpp>
+#include <diffpy/srreal/QuantityAllocator.hpp>
 
 namespace diffpy {
 namespace srreal {
 
-class QuantityType : public std::vector<double>
+class QuantityType :
+    public std::vector<double, QuantityAllocator<double> >
 {
     private:
 
-        typedef std::vector<double> Base;
+        typedef std::vector<double, QuantityAllocator<double> > Base;
 
     public:
 
         // Constructors from std::vector
         QuantityType() : Base()  { }
         QuantityType(const Base& src) : Base(src)  { }
+        QuantityType(const std::vector<double>& src) :
+            Base(src.begin(), src.end())  { }
         explicit QuantityType(Base::size_type n) : Base(n)  { }
         explicit QuantityType(Base::size_type n, double x) : Base(n, x)  { }
         template <class Iter>
             QuantityType(Iter first, Iter last) : Base(first, last)  { }
 
+        // conversion to std::vector
+        operator std::vector<double>() const
+        {
+            return std::vector<double>(this->begin(), this->end());
+        }
+
     private:
 
         // serialization
@@ -61,7 +61,7 @@ double determinant(const Matrix& A)
 
 const Matrix& inverse(const Matrix& A)
 {
-    static Matrix B;
+    thread_local Matrix B;
     gsl_matrix* gA = gsl_matrix_alloc(Ndim, Ndim);
     for (int i = 0; i != Ndim; ++i)
     {
@@ -201,7 +201,7 @@ size_t hash_value(const Matrix& A);
 inline
 const Vector& floor(const Vector& v)
 {
-    static Vector res;
+    thread_local Vector res;
     Vector::const_iterator xi = v.begin();
     Vector::iterator xo = res.begin();
     for (; xi != v.end(); ++xi, ++xo)  *xo = std::floor(*xi);
@@ -220,7 +220,7 @@ double norm(const V& u)
 template <class V>
 double distance(const V& u, const V& v)
 {
-    static R3::Vector duv;
+    R3::Vector duv;
     duv[0] = u[0] - v[0];
     duv[1] = u[1] - v[1];
     duv[2] = u[2] - v[2];
@@ -249,7 +249,7 @@ Vector cross(const V& u, const V& v)
 template <class V>
 const Vector& mxvecproduct(const Matrix& M, const V& u)
 {
-    static Vector res;
+    thread_local Vector res;
     res[0] = M(0,0)*u[0] + M(0,1)*u[1] + M(0,2)*u[2];
     res[1] = M(1,0)*u[0] + M(1,1)*u[1] + M(1,2)*u[2];
     res[2] = M(2,0)*u[0] + M(2,1)*u[1] + M(2,2)*u[2];
@@ -260,7 +260,7 @@ const Vector& mxvecproduct(const Matrix& M, const V& u)
 template <class V>
 const Vector& mxvecproduct(const V& u, const Matrix& M)
 {
-    static Vector res;
+    thread_local Vector res;
     res[0] = u[0]*M(0,0) + u[1]*M(1,0) + u[2]*M(2,0);
     res[1] = u[0]*M(0,1) + u[1]*M(1,1) + u[2]*M(2,1);
     res[2] = u[0]*M(0,2) + u[1]*M(1,2) + u[2]*M(2,2);
@@ -0,0 +1,377 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Numerical kernels for the inner loops of the PDF calculators.
+*
+* The kernel bodies are always inlined into thin wrappers that are compiled
+* with different target attributes.  The compiler thus vectorizes every
+* variant for its own instruction set and uses the matching SIMD versions
+* of exp and sin from the vector math library when available.
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include <atomic>
+
+#include <diffpy/features.hpp>
+#include <diffpy/srreal/SIMDKernels.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+namespace simdkernels {
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+#ifdef __GNUC__
+#define DIFFPY_ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define DIFFPY_ALWAYS_INLINE inline
+#endif
+
+// kernel bodies
+
+DIFFPY_ALWAYS_INLINE
+void addGaussianRDFBody(double* y, int ilo, int ihi, int ioffset,
+        double rstep, double dist, double fwhm, double scale)
+{
+    const double ampl = scale * 2 * sqrt(M_LN2 / M_PI) / fwhm;
+    const double expscale = -4 * M_LN2 / (fwhm * fwhm);
+    const double invdist = 1.0 / dist;
+    for (int i = ilo; i < ihi; ++i)
+    {
+        const double x = (i + ioffset) * rstep - dist;
+        y[i] += ampl * exp(expscale * x * x) * (x * invdist + 1);
+    }
+}
+
+
+DIFFPY_ALWAYS_INLINE
+void addDebyeSineBody(double* y, const double* sf0, const double* sf1,
+        int kqlo, int kqhi, double qstep, double dist,
+        double dwsigma, double scale, double prec)
+{
+    // Evaluate amplitudes in blocks so that exp and sin loops are free
+    // of the early exit and can be vectorized.
+    const int blocksize = 64;
+    double amplitude[blocksize];
+    const double expscale = -0.5 * dwsigma * dwsigma;
+    for (int kb = kqlo; kb < kqhi; kb += blocksize)
+    {
+        const int n = min(blocksize, kqhi - kb);
+        for (int j = 0; j < n; ++j)
+        {
+            const double q = (kb + j) * qstep;
+            amplitude[j] = scale * exp(expscale * q * q) *
+                sf0[kb + j] * sf1[kb + j];
+        }
+        int nvalid = n;
+        for (int j = 0; j < n; ++j)
+        {
+            if (fabs(amplitude[j]) > prec)  continue;
+            nvalid = j;
+            break;
+        }
+        for (int j = 0; j < nvalid; ++j)
+        {
+            const double q = (kb + j) * qstep;
+            y[kb + j] += amplitude[j] * sin(q * dist);
+        }
+        if (nvalid < n)  break;
+    }
+}
+
+
+DIFFPY_ALWAYS_INLINE
+void addGaussianRDFBodyFloat(float* y, int ilo, int ihi, int ioffset,
+        double rstep, double dist, double fwhm, double scale)
+{
+    const float ampl = scale * 2 * sqrt(M_LN2 / M_PI) / fwhm;
+    const float expscale = -4 * M_LN2 / (fwhm * fwhm);
+    const float invdist = 1.0 / dist;
+    const float xlo = (ilo + ioffset) * rstep - dist;
+    const float dx = rstep;
+    for (int i = ilo; i < ihi; ++i)
+    {
+        const float x = xlo + (i - ilo) * dx;
+        y[i] += ampl * expf(expscale * x * x) * (x * invdist + 1);
+    }
+}
+
+
+DIFFPY_ALWAYS_INLINE
+void addDebyeSineBodyFloat(float* y, const float* sf0, const float* sf1,
+        int kqlo, int kqhi, double qstep, double dist,
+        double dwsigma, double scale, double prec)
+{
+    const int blocksize = 64;
+    float amplitude[blocksize];
+    float phase[blocksize];
+    const float fscale = scale;
+    const float fqstep = qstep;
+    const float expscale = -0.5 * dwsigma * dwsigma;
+    const double phasestep = qstep * dist;
+    const double inv2pi = 0.5 / M_PI;
+    for (int kb = kqlo; kb < kqhi; kb += blocksize)
+    {
+        const int n = min(blocksize, kqhi - kb);
+        for (int j = 0; j < n; ++j)
+        {
+            const float q = (kb + j) * fqstep;
+            amplitude[j] = fscale * expf(expscale * q * q) *
+                sf0[kb + j] * sf1[kb + j];
+        }
+        int nvalid = n;
+        for (int j = 0; j < n; ++j)
+        {
+            if (fabsf(amplitude[j]) > prec)  continue;
+            nvalid = j;
+            break;
+        }
+        for (int j = 0; j < nvalid; ++j)
+        {
+            const double p = (kb + j) * phasestep;
+            phase[j] = p - 2 * M_PI * floor(p * inv2pi + 0.5);
+        }
+        for (int j = 0; j < nvalid; ++j)
+        {
+            y[kb + j] += amplitude[j] * sinf(phase[j]);
+        }
+        if (nvalid < n)  break;
+    }
+}
+
+// declare kernel variants
+
+#define DIFFPY_DEFINE_KERNELS(isa, targetattr) \
+    targetattr void addGaussianRDF_##isa(double* y, int ilo, int ihi, \
+            int ioffset, double rstep, double dist, double fwhm, \
+            double scale) \
+    { \
+        addGaussianRDFBody(y, ilo, ihi, ioffset, rstep, dist, fwhm, scale); \
+    } \
+    targetattr void addDebyeSine_##isa(double* y, const double* sf0, \
+            const double* sf1, int kqlo, int kqhi, double qstep, \
+            double dist, double dwsigma, double scale, double prec) \
+    { \
+        addDebyeSineBody(y, sf0, sf1, kqlo, kqhi, qstep, dist, \
+                dwsigma, scale, prec); \
+    } \
+    targetattr void addGaussianRDFFloat_##isa(float* y, int ilo, int ihi, \
+            int ioffset, double rstep, double dist, double fwhm, \
+            double scale) \
+    { \
+        addGaussianRDFBodyFloat(y, ilo, ihi, ioffset, rstep, dist, \
+                fwhm, scale); \
+    } \
+    targetattr void addDebyeSineFloat_##isa(float* y, const float* sf0, \
+            const float* sf1, int kqlo, int kqhi, double qstep, \
+            double dist, double dwsigma, double scale, double prec) \
+    { \
+        addDebyeSineBodyFloat(y, sf0, sf1, kqlo, kqhi, qstep, dist, \
+                dwsigma, scale, prec); \
+    } \
+
+
+#ifdef DIFFPY_HAS_SIMD_DISPATCH
+DIFFPY_DEFINE_KERNELS(sse2, )
+DIFFPY_DEFINE_KERNELS(avx2, __attribute__((target("avx2,fma"))))
+DIFFPY_DEFINE_KERNELS(avx512, __attribute__((target("avx512f,avx2,fma"))))
+#else
+DIFFPY_DEFINE_KERNELS(generic, )
+#endif
+
+#undef DIFFPY_DEFINE_KERNELS
+
+// table of kernel variants
+
+typedef void (*GaussianRDFKernel)(double*, int, int, int,
+        double, double, double, double);
+typedef void (*DebyeSineKernel)(double*, const double*, const double*,
+        int, int, double, double, double, double, double);
+typedef void (*GaussianRDFFloatKernel)(float*, int, int, int,
+        double, double, double, double);
+typedef void (*DebyeSineFloatKernel)(float*, const float*, const float*,
+        int, int, double, double, double, double, double);
+
+struct KernelVariant
+{
+    std::string isa;
+    bool supported;
+    GaussianRDFKernel addgaussianrdf;
+    DebyeSineKernel adddebyesine;
+    GaussianRDFFloatKernel addgaussianrdffloat;
+    DebyeSineFloatKernel adddebyesinefloat;
+};
+
+
+vector<KernelVariant> createKernelVariants()
+{
+    vector<KernelVariant> rv;
+#ifdef DIFFPY_HAS_SIMD_DISPATCH
+    __builtin_cpu_init();
+    const bool hasavx2 = __builtin_cpu_supports("avx2") &&
+        __builtin_cpu_supports("fma");
+    const bool hasavx512 = hasavx2 && __builtin_cpu_supports("avx512f");
+    KernelVariant kv_sse2 = {"sse2", true,
+        addGaussianRDF_sse2, addDebyeSine_sse2,
+        addGaussianRDFFloat_sse2, addDebyeSineFloat_sse2};
+    KernelVariant kv_avx2 = {"avx2", hasavx2,
+        addGaussianRDF_avx2, addDebyeSine_avx2,
+        addGaussianRDFFloat_avx2, addDebyeSineFloat_avx2};
+    KernelVariant kv_avx512 = {"avx512", hasavx512,
+        addGaussianRDF_avx512, addDebyeSine_avx512,
+        addGaussianRDFFloat_avx512, addDebyeSineFloat_avx512};
+    rv.push_back(kv_sse2);
+    rv.push_back(kv_avx2);
+    rv.push_back(kv_avx512);
+#else
+    KernelVariant kv_generic = {"generic", true,
+        addGaussianRDF_generic, addDebyeSine_generic,
+        addGaussianRDFFloat_generic, addDebyeSineFloat_generic};
+    rv.push_back(kv_generic);
+#endif
+    return rv;
+}
+
+
+const vector<KernelVariant>& kernelVariants()
+{
+    static vector<KernelVariant> rv = createKernelVariants();
+    return rv;
+}
+
+
+const KernelVariant* findSupportedVariant(const string& isa)
+{
+    const vector<KernelVariant>& kvs = kernelVariants();
+    vector<KernelVariant>::const_iterator kv = kvs.begin();
+    for (; kv != kvs.end(); ++kv)
+    {
+        if (kv->supported && kv->isa == isa)  return &(*kv);
+    }
+    return NULL;
+}
+
+
+const KernelVariant* selectVariantAtLoad()
+{
+    const char* envisa = getenv("DIFFPYSIMDISA");
+    const KernelVariant* rv = envisa ? findSupportedVariant(envisa) : NULL;
+    if (rv)  return rv;
+    const vector<KernelVariant>& kvs = kernelVariants();
+    vector<KernelVariant>::const_reverse_iterator kv = kvs.rbegin();
+    for (; kv != kvs.rend(); ++kv)
+    {
+        if (kv->supported)  return &(*kv);
+    }
+    return &(kvs.front());
+}
+
+
+// kernels running in other threads may read the variant during setISA
+atomic<const KernelVariant*>& activeVariant()
+{
+    static atomic<const KernelVariant*> rv(selectVariantAtLoad());
+    return rv;
+}
+
+
+const KernelVariant* loadVariant()
+{
+    return activeVariant().load(memory_order_acquire);
+}
+
+// make sure the variant is selected when the library is loaded
+const KernelVariant* initial_variant = loadVariant();
+
+}   // namespace
+
+// Functions -----------------------------------------------------------------
+
+const string& activeISA()
+{
+    return loadVariant()->isa;
+}
+
+
+vector<string> availableISAs()
+{
+    vector<string> rv;
+    const vector<KernelVariant>& kvs = kernelVariants();
+    vector<KernelVariant>::const_iterator kv = kvs.begin();
+    for (; kv != kvs.end(); ++kv)
+    {
+        if (kv->supported)  rv.push_back(kv->isa);
+    }
+    return rv;
+}
+
+
+void setISA(const string& isa)
+{
+    const KernelVariant* kv = findSupportedVariant(isa);
+    if (!kv)
+    {
+        const char* emsg = "Unknown or unsupported SIMD kernels variant.";
+        throw invalid_argument(emsg);
+    }
+    activeVariant().store(kv, memory_order_release);
+}
+
+
+void addGaussianRDF(double* y, int ilo, int ihi, int ioffset, double rstep,
+        double dist, double fwhm, double scale)
+{
+    loadVariant()->addgaussianrdf(
+            y, ilo, ihi, ioffset, rstep, dist, fwhm, scale);
+}
+
+
+void addDebyeSine(double* y, const double* sf0, const double* sf1,
+        int kqlo, int kqhi, double qstep, double dist,
+        double dwsigma, double scale, double prec)
+{
+    loadVariant()->adddebyesine(
+            y, sf0, sf1, kqlo, kqhi, qstep, dist, dwsigma, scale, prec);
+}
+
+
+void addGaussianRDF(float* y, int ilo, int ihi, int ioffset, double rstep,
+        double dist, double fwhm, double scale)
+{
+    loadVariant()->addgaussianrdffloat(
+            y, ilo, ihi, ioffset, rstep, dist, fwhm, scale);
+}
+
+
+void addDebyeSine(float* y, const float* sf0, const float* sf1,
+        int kqlo, int kqhi, double qstep, double dist,
+        double dwsigma, double scale, double prec)
+{
+    loadVariant()->adddebyesinefloat(
+            y, sf0, sf1, kqlo, kqhi, qstep, dist, dwsigma, scale, prec);
+}
+
+}   // namespace simdkernels
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
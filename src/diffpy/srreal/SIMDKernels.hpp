@@ -0,0 +1,76 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Numerical kernels for the inner loops of the PDF calculators.
+*
+* The kernels are compiled for several instruction sets of the x86_64
+* processors and the best variant supported by the CPU is selected when
+* the library is loaded.  The selection can be overridden with the
+* DIFFPYSIMDISA environment variable set to "sse2", "avx2" or "avx512".
+* Other platforms use a single "generic" variant.
+*
+*****************************************************************************/
+
+#ifndef SIMDKERNELS_HPP_INCLUDED
+#define SIMDKERNELS_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+
+namespace diffpy {
+namespace srreal {
+namespace simdkernels {
+
+/// Return name of the active instruction set variant of the kernels.
+const std::string& activeISA();
+
+/// Names of the kernel variants supported by the CPU from the slowest
+/// to the fastest one.
+std::vector<std::string> availableISAs();
+
+/// Activate kernel variant of the specified name.
+/// Throw invalid_argument for unknown or unsupported variant.
+void setISA(const std::string& isa);
+
+/// Add Gaussian peak profile rescaled for the PDF pair contribution
+/// to y[i] for ilo <= i < ihi.  The peak is centered at dist at
+/// the uniform grid r_i = (i + ioffset) * rstep.
+void addGaussianRDF(double* y, int ilo, int ihi, int ioffset, double rstep,
+        double dist, double fwhm, double scale);
+
+/// Add Debye-Waller damped sine contributions to y[kq] for
+/// kqlo <= kq < kqhi and q = kq * qstep.  The amplitude at kq is
+/// scale * sf0[kq] * sf1[kq] * exp(-(dwsigma * q)**2 / 2) and the summation
+/// stops at the first point where the absolute amplitude drops to prec.
+void addDebyeSine(double* y, const double* sf0, const double* sf1,
+        int kqlo, int kqhi, double qstep, double dist,
+        double dwsigma, double scale, double prec);
+
+/// Single precision variant of addGaussianRDF.  Offsets from the peak
+/// center are evaluated in double precision so that the accuracy does not
+/// depend on the distance.
+void addGaussianRDF(float* y, int ilo, int ihi, int ioffset, double rstep,
+        double dist, double fwhm, double scale);
+
+/// Single precision variant of addDebyeSine.  Phases of the sine are
+/// reduced to [-pi, pi] in double precision.
+void addDebyeSine(float* y, const float* sf0, const float* sf1,
+        int kqlo, int kqhi, double qstep, double dist,
+        double dwsigma, double scale, double prec);
+
+}   // namespace simdkernels
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // SIMDKERNELS_HPP_INCLUDED
@@ -0,0 +1,292 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class ScatteringDensityGrid -- scattering density of a periodic structure
+*     sampled on a grid with the cloud-in-cell assignment
+*
+*****************************************************************************/
+
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_fft_complex.h>
+
+#include <diffpy/srreal/ScatteringDensityGrid.hpp>
+#include <diffpy/mathutils.hpp>
+#include <diffpy/validators.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+using namespace diffpy::mathutils;
+using namespace diffpy::validators;
+
+// Local Helpers -------------------------------------------------------------
+
+namespace {
+
+const char* EMSGFFT = "Fourier Transformation failed.";
+
+/// smallest power of 2 that is not below x
+int _powerOfTwoAtLeast(double x)
+{
+    int rv = 1;
+    while (rv < x)  rv *= 2;
+    return rv;
+}
+
+
+/// index of the k-th node in a periodic dimension of n points
+inline int _wrapIndex(int k, int n)
+{
+    int rv = k % n;
+    return (rv < 0) ? (rv + n) : rv;
+}
+
+
+/// transform complex row-major grid along all 3 dimensions
+void _fft3d(vector<double>& grid, const int* n, bool forward)
+{
+    const size_t strides[3] = {size_t(n[1]) * n[2], size_t(n[2]), 1};
+    const size_t npts = size_t(n[0]) * n[1] * n[2];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const size_t stride = strides[axis];
+        const size_t nk = n[axis];
+        for (size_t start = 0; start < npts; ++start)
+        {
+            // visit each line once from its starting node
+            if ((start / stride) % nk != 0)  continue;
+            double* line = grid.data() + 2 * start;
+            int status = forward ?
+                gsl_fft_complex_radix2_forward(line, stride, nk) :
+                gsl_fft_complex_radix2_inverse(line, stride, nk);
+            if (status != GSL_SUCCESS)  throw invalid_argument(EMSGFFT);
+        }
+    }
+}
+
+}   // namespace
+
+// Constructor ---------------------------------------------------------------
+
+ScatteringDensityGrid::ScatteringDensityGrid(
+        const Lattice& L, double gridstep)
+{
+    ensureEpsilonPositive("gridstep", gridstep);
+    mbase = L.base();
+    mrecbase = L.recbase();
+    mmaxdistance = DOUBLE_MAX;
+    size_t npts = 1;
+    for (int k = 0; k < R3::Ndim; ++k)
+    {
+        R3::Vector vk(mbase(k, 0), mbase(k, 1), mbase(k, 2));
+        mn[k] = _powerOfTwoAtLeast(R3::norm(vk) / gridstep);
+        npts *= mn[k];
+        // half of the distance between the lattice planes
+        R3::Vector rk(mrecbase(0, k), mrecbase(1, k), mrecbase(2, k));
+        mmaxdistance = min(mmaxdistance, 0.5 / R3::norm(rk));
+    }
+    mgrid.assign(2 * npts, 0.0);
+}
+
+// Public Methods ------------------------------------------------------------
+
+size_t ScatteringDensityGrid::countPoints(const Lattice& L, double gridstep)
+{
+    ensureEpsilonPositive("gridstep", gridstep);
+    const double cellsizes[3] = {L.a(), L.b(), L.c()};
+    size_t rv = 1;
+    for (int k = 0; k < R3::Ndim; ++k)
+    {
+        rv *= _powerOfTwoAtLeast(cellsizes[k] / gridstep);
+    }
+    return rv;
+}
+
+
+double ScatteringDensityGrid::maxDistance() const
+{
+    return mmaxdistance;
+}
+
+
+double ScatteringDensityGrid::kernelExtent() const
+{
+    // each node is within one grid cell diagonal of the deposited point
+    double diagmax = 0.0;
+    const double signs[4][2] = {{+1, +1}, {+1, -1}, {-1, +1}, {-1, -1}};
+    for (int s = 0; s < 4; ++s)
+    {
+        R3::Vector diag;
+        for (int j = 0; j < R3::Ndim; ++j)
+        {
+            diag[j] = mbase(0, j) / mn[0] +
+                signs[s][0] * mbase(1, j) / mn[1] +
+                signs[s][1] * mbase(2, j) / mn[2];
+        }
+        diagmax = max(diagmax, R3::norm(diag));
+    }
+    return 2 * diagmax;
+}
+
+
+double ScatteringDensityGrid::kernelVariance() const
+{
+    // cloud-in-cell assignment has variance 1/6 per point and grid axis,
+    // a pair has twice that and 1/3 of it projects to a random direction
+    double rv = 0.0;
+    for (int k = 0; k < R3::Ndim; ++k)
+    {
+        R3::Vector hk(mbase(k, 0), mbase(k, 1), mbase(k, 2));
+        hk /= mn[k];
+        rv += R3::dot(hk, hk) / 9;
+    }
+    return rv;
+}
+
+
+void ScatteringDensityGrid::deposit(const R3::Vector& xyz, double weight)
+{
+    Kernel knl;
+    this->cloudInCell(xyz, knl);
+    for (int a = 0; a < 8; ++a)
+    {
+        const int* nd = knl.node[a];
+        size_t idx = _wrapIndex(nd[0], mn[0]);
+        idx = idx * mn[1] + _wrapIndex(nd[1], mn[1]);
+        idx = idx * mn[2] + _wrapIndex(nd[2], mn[2]);
+        mgrid[2 * idx] += weight * knl.weight[a];
+    }
+}
+
+
+void ScatteringDensityGrid::addRadialAutocorrelation(
+        double* hist, int hlosteps, int nbins, double dr)
+{
+    // autocorrelation is the inverse transform of the power spectrum
+    _fft3d(mgrid, mn, true);
+    const size_t npts = mgrid.size() / 2;
+    for (size_t idx = 0; idx < npts; ++idx)
+    {
+        double& re = mgrid[2 * idx];
+        double& im = mgrid[2 * idx + 1];
+        re = re * re + im * im;
+        im = 0.0;
+    }
+    _fft3d(mgrid, mn, false);
+    int dnode[3];
+    size_t idx = 0;
+    for (int i0 = 0; i0 < mn[0]; ++i0)
+    {
+        dnode[0] = (2 * i0 > mn[0]) ? (i0 - mn[0]) : i0;
+        for (int i1 = 0; i1 < mn[1]; ++i1)
+        {
+            dnode[1] = (2 * i1 > mn[1]) ? (i1 - mn[1]) : i1;
+            for (int i2 = 0; i2 < mn[2]; ++i2, ++idx)
+            {
+                dnode[2] = (2 * i2 > mn[2]) ? (i2 - mn[2]) : i2;
+                this->addRadial(dnode, mgrid[2 * idx],
+                        hist, hlosteps, nbins, dr);
+            }
+        }
+    }
+}
+
+
+void ScatteringDensityGrid::addPairKernel(
+        const R3::Vector& xyz0, const R3::Vector& xyz1, double weight,
+        double* hist, int hlosteps, int nbins, double dr) const
+{
+    Kernel knl0, knl1;
+    this->cloudInCell(xyz0, knl0);
+    this->cloudInCell(xyz1, knl1);
+    int dnode[3];
+    for (int a = 0; a < 8; ++a)
+    {
+        for (int b = 0; b < 8; ++b)
+        {
+            for (int k = 0; k < R3::Ndim; ++k)
+            {
+                dnode[k] = knl1.node[b][k] - knl0.node[a][k];
+            }
+            const double w = weight * knl0.weight[a] * knl1.weight[b];
+            this->addRadial(dnode, w, hist, hlosteps, nbins, dr);
+        }
+    }
+}
+
+
+size_t ScatteringDensityGrid::memoryUsage() const
+{
+    return mgrid.capacity() * sizeof(double);
+}
+
+// Private Methods -----------------------------------------------------------
+
+void ScatteringDensityGrid::cloudInCell(
+        const R3::Vector& xyz, Kernel& knl) const
+{
+    int nlo[3];
+    double t[3];
+    for (int k = 0; k < R3::Ndim; ++k)
+    {
+        const double fk = mn[k] * (xyz[0] * mrecbase(0, k) +
+                xyz[1] * mrecbase(1, k) + xyz[2] * mrecbase(2, k));
+        nlo[k] = int(floor(fk));
+        t[k] = fk - nlo[k];
+    }
+    for (int a = 0; a < 8; ++a)
+    {
+        knl.weight[a] = 1.0;
+        for (int k = 0; k < R3::Ndim; ++k)
+        {
+            const int up = (a >> k) & 1;
+            knl.node[a][k] = nlo[k] + up;
+            knl.weight[a] *= up ? t[k] : (1 - t[k]);
+        }
+    }
+}
+
+
+void ScatteringDensityGrid::addRadial(const int* dnode, double value,
+        double* hist, int hlosteps, int nbins, double dr) const
+{
+    if (value == 0.0)  return;
+    R3::Vector dv;
+    for (int j = 0; j < R3::Ndim; ++j)
+    {
+        dv[j] = dnode[0] * mbase(0, j) / mn[0] +
+            dnode[1] * mbase(1, j) / mn[1] +
+            dnode[2] * mbase(2, j) / mn[2];
+    }
+    const double d = R3::norm(dv);
+    if (d == 0.0)  return;
+    const double x = d / dr - hlosteps;
+    const int i = int(floor(x));
+    if (i < -1 || i >= nbins)  return;
+    const double t = x - i;
+    const double y = value / d;
+    if (i >= 0)  hist[i] += y * (1 - t);
+    if (i + 1 < nbins)  hist[i + 1] += y * t;
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
@@ -0,0 +1,101 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class ScatteringDensityGrid -- scattering density of a periodic structure
+*     sampled on a grid with the cloud-in-cell assignment.  The radial
+*     distribution of pair vectors is evaluated from the autocorrelation
+*     of the grid obtained with 3D fast Fourier transformation.
+*
+* The autocorrelation contains every pair smeared by the assignment kernel.
+* Contributions of specific pairs, e.g., of short pairs summed exactly, can
+* be removed with the same kernel using addPairKernel.
+*
+*****************************************************************************/
+
+#ifndef SCATTERINGDENSITYGRID_HPP_INCLUDED
+#define SCATTERINGDENSITYGRID_HPP_INCLUDED
+
+#include <vector>
+
+#include <diffpy/srreal/Lattice.hpp>
+#include <diffpy/srreal/R3linalg.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class ScatteringDensityGrid
+{
+    public:
+
+        // constructor
+        /// grid with power of 2 points along each cell vector and
+        /// spacing not exceeding gridstep
+        ScatteringDensityGrid(const Lattice&, double gridstep);
+
+        // methods
+        /// total number of grid points for the lattice and gridstep
+        static size_t countPoints(const Lattice&, double gridstep);
+        /// number of grid points along the k-th cell vector
+        int size(int k) const  { return mn[k]; }
+        /// largest distance that is not aliased by periodic images
+        double maxDistance() const;
+        /// upper bound of the kernel shift of a pair distance
+        double kernelExtent() const;
+        /// mean square broadening of pair distances by the kernel
+        double kernelVariance() const;
+        /// add point scatterer at Cartesian position
+        void deposit(const R3::Vector& xyz, double weight);
+        /// add radial distribution of the grid autocorrelation to the
+        /// histogram with nbins points at (hlosteps + k) * dr.
+        /// Each pair vector d adds C(d) / |d| split linearly between
+        /// the nearest points.  This transforms the grid in place.
+        void addRadialAutocorrelation(double* hist, int hlosteps, int nbins,
+                double dr);
+        /// add kernel representation of an ordered pair at Cartesian
+        /// positions xyz0, xyz1 to the histogram as in
+        /// addRadialAutocorrelation
+        void addPairKernel(const R3::Vector& xyz0, const R3::Vector& xyz1,
+                double weight, double* hist, int hlosteps, int nbins,
+                double dr) const;
+        /// heap memory in bytes
+        size_t memoryUsage() const;
+
+    private:
+
+        // types
+        struct Kernel
+        {
+            int node[8][3];
+            double weight[8];
+        };
+
+        // methods
+        void cloudInCell(const R3::Vector& xyz, Kernel&) const;
+        void addRadial(const int* dnode, double value,
+                double* hist, int hlosteps, int nbins, double dr) const;
+
+        // data
+        R3::Matrix mbase;
+        R3::Matrix mrecbase;
+        int mn[3];
+        double mmaxdistance;
+        // complex values in the row-major order
+        std::vector<double> mgrid;
+
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // SCATTERINGDENSITYGRID_HPP_INCLUDED
@@ -0,0 +1,92 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class SinglePrecisionSums -- single precision buffer for accumulation of
+*     many small terms into a double precision array
+*
+*****************************************************************************/
+
+#include <algorithm>
+#include <cassert>
+
+#include <diffpy/srreal/SinglePrecisionSums.hpp>
+#include <diffpy/srreal/MemoryUsage.hpp>
+
+using namespace std;
+
+namespace diffpy {
+namespace srreal {
+
+// Constructor ---------------------------------------------------------------
+
+SinglePrecisionSums::SinglePrecisionSums() :
+    mcount(0), mlo(0), mhi(0)
+{ }
+
+// Public Methods ------------------------------------------------------------
+
+float* SinglePrecisionSums::accumulate(QuantityType& target, int lo, int hi)
+{
+    if (mvalues.size() != target.size())
+    {
+        assert(this->empty());
+        mvalues.assign(target.size(), 0.0f);
+        mcount = 0;
+    }
+    if (mcount >= FLUSH_COUNT)  this->flush(target);
+    assert(0 <= lo && hi <= int(mvalues.size()));
+    if (lo < hi)
+    {
+        mlo = (mlo < mhi) ? min(mlo, lo) : lo;
+        mhi = max(mhi, hi);
+    }
+    ++mcount;
+    return mvalues.data();
+}
+
+
+void SinglePrecisionSums::flush(QuantityType& target)
+{
+    assert(mlo >= mhi || mhi <= int(target.size()));
+    for (int i = mlo; i < mhi; ++i)
+    {
+        target[i] += mvalues[i];
+        mvalues[i] = 0.0f;
+    }
+    mcount = mlo = mhi = 0;
+}
+
+
+void SinglePrecisionSums::clear()
+{
+    fill(mvalues.begin(), mvalues.end(), 0.0f);
+    mcount = mlo = mhi = 0;
+}
+
+
+bool SinglePrecisionSums::empty() const
+{
+    return !(mlo < mhi);
+}
+
+
+size_t SinglePrecisionSums::memoryUsage() const
+{
+    return byteSize(mvalues);
+}
+
+}   // namespace srreal
+}   // namespace diffpy
+
+// End of file
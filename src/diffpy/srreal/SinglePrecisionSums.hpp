@@ -0,0 +1,73 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class SinglePrecisionSums -- single precision buffer for accumulation of
+*     many small terms into a double precision array
+*
+* Kernels add terms to the float buffer returned by accumulate.  The buffer
+* is added to the double target and cleared after every FLUSH_COUNT calls,
+* so that the rounding error of float sums does not grow with the number
+* of pairs.  The target array must not be used before flush.
+*
+*****************************************************************************/
+
+#ifndef SINGLEPRECISIONSUMS_HPP_INCLUDED
+#define SINGLEPRECISIONSUMS_HPP_INCLUDED
+
+#include <vector>
+
+#include <diffpy/srreal/QuantityType.hpp>
+
+namespace diffpy {
+namespace srreal {
+
+class SinglePrecisionSums
+{
+    public:
+
+        // constants
+        /// number of accumulate calls between additions to the target
+        static const int FLUSH_COUNT = 256;
+
+        // constructor
+        SinglePrecisionSums();
+
+        // methods
+        /// float buffer of the target size for adding terms to the
+        /// index range [lo, hi).  Pending sums are first added to the
+        /// target when the flush count is reached.  The buffer must be
+        /// flushed or cleared before the target changes size.
+        float* accumulate(QuantityType& target, int lo, int hi);
+        /// add pending sums to the target and clear the buffer
+        void flush(QuantityType& target);
+        /// discard pending sums
+        void clear();
+        /// true when there are no pending sums
+        bool empty() const;
+        /// heap memory in bytes
+        size_t memoryUsage() const;
+
+    private:
+
+        // data
+        std::vector<float> mvalues;
+        int mcount;
+        int mlo;
+        int mhi;
+};
+
+}   // namespace srreal
+}   // namespace diffpy
+
+#endif  // SINGLEPRECISIONSUMS_HPP_INCLUDED
@@ -19,6 +19,8 @@
 
 #include <cassert>
 #include <cctype>
+#include <cmath>
+#include <algorithm>
 
 #include <diffpy/serialization.ipp>
 #include <diffpy/mathutils.hpp>
@@ -77,6 +79,12 @@ StructureAdapter::diff(StructureAdapterConstPtr other) const
     return sd;
 }
 
+
+MemoryUsage StructureAdapter::memoryUsage() const
+{
+    return MemoryUsage();
+}
+
 // Routines ------------------------------------------------------------------
 
 double meanSquareDisplacement(const R3::Matrix& Uijcartn,
@@ -89,8 +97,7 @@ double meanSquareDisplacement(const R3::Matrix& Uijcartn,
         assert(eps_eq(Uijcartn(0,1), Uijcartn(1,0)));
         assert(eps_eq(Uijcartn(0,2), Uijcartn(2,0)));
         assert(eps_eq(Uijcartn(1,2), Uijcartn(2,1)));
-        static R3::Vector sn;
-        sn = s / R3::norm(s);
+        const R3::Vector sn = s / R3::norm(s);
         rv = Uijcartn(0,0) * sn(0) * sn(0) +
              Uijcartn(1,1) * sn(1) * sn(1) +
              Uijcartn(2,2) * sn(2) * sn(2) +
@@ -108,6 +115,22 @@ double meanSquareDisplacement(const R3::Matrix& Uijcartn,
 }
 
 
+R3::Vector meanSquareDisplacementGradient(const R3::Matrix& Uijcartn,
+        const R3::Vector& s, bool anisotropy)
+{
+    R3::Vector rv = R3::zerovector;
+    if (!anisotropy)  return rv;
+    // d(s.U.s / s.s) / ds = 2 (U.s - msd s) / s.s
+    const double ss = R3::dot(s, s);
+    assert(ss > 0);
+    const double msd = meanSquareDisplacement(Uijcartn, s, anisotropy);
+    rv = R3::prod(Uijcartn, s);
+    rv -= msd * s;
+    rv *= 2.0 / ss;
+    return rv;
+}
+
+
 double maxUii(StructureAdapterPtr stru)
 {
     if (!stru)  return 0.0;
@@ -123,6 +146,38 @@ double maxUii(StructureAdapterPtr stru)
     return rv;
 }
 
+
+double estimateNeighborCount(StructureAdapterPtr stru,
+        double rmin, double rmax)
+{
+    const int cntsites = stru ? stru->countSites() : 0;
+    if (!cntsites || rmax <= rmin)  return 0.0;
+    const double rlo = max(0.0, rmin);
+    const double shellvolume = 4.0 * M_PI / 3.0 *
+        (pow(rmax, 3) - pow(rlo, 3));
+    double density = stru->numberDensity();
+    if (density > 0)  return density * shellvolume;
+    // aperiodic structure - here the number of neighbors is limited
+    R3::Vector xyzlo = stru->siteCartesianPosition(0);
+    R3::Vector xyzhi = xyzlo;
+    for (int i = 1; i < cntsites; ++i)
+    {
+        const R3::Vector& xyz = stru->siteCartesianPosition(i);
+        for (int k = 0; k < R3::Ndim; ++k)
+        {
+            xyzlo[k] = min(xyzlo[k], xyz[k]);
+            xyzhi[k] = max(xyzhi[k], xyz[k]);
+        }
+    }
+    // pad the box by a typical interatomic distance
+    const double pad = 1.0;
+    double boxvolume = 1.0;
+    for (int k = 0; k < R3::Ndim; ++k)  boxvolume *= xyzhi[k] - xyzlo[k] + pad;
+    density = cntsites / boxvolume;
+    double rv = min(double(cntsites - 1), density * shellvolume);
+    return rv;
+}
+
 }   // namespace srreal
 }   // namespace diffpy
 
@@ -31,6 +31,7 @@
 
 #include <diffpy/srreal/R3linalg.hpp>
 #include <diffpy/srreal/BaseBondGenerator.hpp>
+#include <diffpy/srreal/MemoryUsage.hpp>
 
 namespace diffpy {
 namespace srreal {
@@ -96,6 +97,10 @@ class StructureAdapter :
         /// Return difference from the other StructureAdapter
         virtual StructureDifference diff(StructureAdapterConstPtr) const;
 
+        /// heap memory held by the adapter split per data component.
+        /// Empty for adapters that do not track their memory.
+        virtual MemoryUsage memoryUsage() const;
+
     private:
 
         // serialization
@@ -114,9 +119,19 @@ StructureAdapterPtr emptyStructureAdapter();
 double meanSquareDisplacement(const R3::Matrix& Uijcartn, const R3::Vector& s,
         bool anisotropy=true);
 
+/// Gradient of meanSquareDisplacement with respect to the direction vector s.
+R3::Vector meanSquareDisplacementGradient(const R3::Matrix& Uijcartn,
+        const R3::Vector& s, bool anisotropy=true);
+
 /// Maximum diagonal Uii element from all atoms in the structure.
 double maxUii(StructureAdapterPtr stru);
 
+/// Estimate mean number of neighbors at distances from rmin to rmax
+/// per one independent site.  Use structure number density if defined,
+/// otherwise assume uniform density within the bounding box of sites.
+double estimateNeighborCount(StructureAdapterPtr stru,
+        double rmin, double rmax);
+
 /// Translate an index container to a vector of string symbols
 template <class T>
 std::vector<std::string>
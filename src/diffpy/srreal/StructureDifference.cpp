@@ -31,7 +31,8 @@ namespace srreal {
 
 // Constructors --------------------------------------------------------------
 
-StructureDifference::StructureDifference() : diffmethod(Method::NONE)
+StructureDifference::StructureDifference() :
+    diffmethod(Method::NONE), deformation(R3::identity())
 { }
 
 
@@ -39,7 +40,8 @@ StructureDifference::StructureDifference(
         StructureAdapterConstPtr oldstru,
         StructureAdapterConstPtr newstru)
     :
-    stru0(oldstru), stru1(newstru), diffmethod(Method::NONE)
+    stru0(oldstru), stru1(newstru), diffmethod(Method::NONE),
+    deformation(R3::identity())
 {
     if (stru0 && stru0 == stru1)
     {
@@ -66,5 +68,21 @@ bool StructureDifference::allowsfastupdate() const
     return int(pop0.size()) < popbound;
 }
 
+
+bool StructureDifference::displacementonly() const
+{
+    bool rv = (diffmethod == Method::SIDEBYSIDE) && !displaced.empty() &&
+        (displaced == pop0) && (displaced == add1);
+    return rv;
+}
+
+
+bool StructureDifference::occupancyonly() const
+{
+    bool rv = (diffmethod == Method::SIDEBYSIDE) && !reoccupied.empty() &&
+        (reoccupied == pop0) && (reoccupied == add1);
+    return rv;
+}
+
 }   // namespace srreal
 }   // namespace diffpy
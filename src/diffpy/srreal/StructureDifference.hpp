@@ -23,6 +23,7 @@
 #define STRUCTUREDIFFERENCE_HPP_INCLUDED
 
 #include <diffpy/srreal/forwardtypes.hpp>
+#include <diffpy/srreal/R3linalg.hpp>
 
 namespace diffpy {
 namespace srreal {
@@ -37,7 +38,7 @@ class StructureDifference {
 
         // enumeration type for difference methods
         struct Method {
-            enum Type {NONE, SIDEBYSIDE, SORTED};
+            enum Type {NONE, SIDEBYSIDE, SORTED, LATTICE};
         };
 
         // data
@@ -52,8 +53,20 @@ class StructureDifference {
         /// indices of atoms in stru1 that are not in stru0
         /// These atoms need to be added in a fast update of PairQuantity.
         SiteIndices add1;
+        /// indices of atoms in both pop0 and add1 that differ only in
+        /// isotropic displacement parameters.  Pair distances of these
+        /// atoms are the same in stru0 and stru1.
+        SiteIndices displaced;
+        /// indices of atoms in both pop0 and add1 that differ only in
+        /// occupancy.  These change only the weights of their pairs.
+        SiteIndices reoccupied;
         /// type of comparison used in obtaining this difference
         Method::Type diffmethod;
+        /// Cartesian transformation of pair vectors for the LATTICE method,
+        /// where stru1 has the same atoms in fractional coordinates as stru0,
+        /// but a different lattice.  Pair vector r0 in stru0 corresponds to
+        /// r0 * deformation in stru1.  Identity for other methods.
+        R3::Matrix deformation;
 
         // methods
 
@@ -61,6 +74,14 @@ class StructureDifference {
         /// structure from stru0 to stru1.
         bool allowsfastupdate() const;
 
+        /// Return true if all changed atoms are in displaced so that
+        /// the update does not need new pair distances.
+        bool displacementonly() const;
+
+        /// Return true if all changed atoms are in reoccupied so that
+        /// the update needs only to reweight the pair contributions.
+        bool occupancyonly() const;
+
 };
 
 }   // namespace srreal
@@ -81,12 +81,30 @@ class TestAtomicStructureAdapter : public CxxTest::TestSuite
             TS_ASSERT(sd.allowsfastupdate())
             TS_ASSERT(sd.pop0.empty());
             TS_ASSERT(sd.add1.empty());
+            TS_ASSERT(!sd.displacementonly());
+            TS_ASSERT(!sd.occupancyonly());
+            // occupancy changes of many sites keep side-by-side difference
+            for (int i = 0; i < SZ; i += 2)  (*cpstru)[i].occupancy = 0.5;
+            sd = mstru->diff(cpstru);
+            TS_ASSERT_EQUALS(SIDEBYSIDE, sd.diffmethod);
+            TS_ASSERT(!sd.allowsfastupdate());
+            TS_ASSERT_EQUALS(5u, sd.reoccupied.size());
+            TS_ASSERT(sd.occupancyonly());
+            TS_ASSERT(!sd.displacementonly());
+            cpstru = boost::make_shared<AtomicStructureAdapter>(*mpstru);
+            (*cpstru)[1].uij_cartn = R3::identity() * 0.01;
+            sd = mstru->diff(cpstru);
+            TS_ASSERT_EQUALS(SiteIndices(1, 1), sd.displaced);
+            TS_ASSERT(sd.displacementonly());
             (*cpstru)[0].atomtype = "N";
             sd = mstru->diff(cpstru);
             TS_ASSERT_EQUALS(SIDEBYSIDE, sd.diffmethod);
             TS_ASSERT(sd.allowsfastupdate())
-            TS_ASSERT_EQUALS(1u, sd.pop0.size());
-            TS_ASSERT_EQUALS(1u, sd.add1.size());
+            TS_ASSERT_EQUALS(2u, sd.pop0.size());
+            TS_ASSERT_EQUALS(2u, sd.add1.size());
+            TS_ASSERT_EQUALS(SiteIndices(1, 1), sd.displaced);
+            TS_ASSERT(!sd.displacementonly());
+            (*cpstru)[1].uij_cartn = R3::zeromatrix();
             for (int i = 1; i < (1 - sqrt(0.5)) * SZ; ++i)
             {
                 cpstru->erase(0);
@@ -0,0 +1,169 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestBraggStructureFactorCalculator -- unit tests for
+*     the BraggStructureFactorCalculator class
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <algorithm>
+
+#include <diffpy/srreal/BraggStructureFactorCalculator.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/serialization.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+namespace {
+
+/// periodic structure with isotropic displacements uiso for all sites
+StructureAdapterPtr loadIsotropicStructure(const string& tailname,
+        double uiso)
+{
+    StructureAdapterPtr stru = loadTestPeriodicStructure(tailname);
+    PeriodicStructureAdapter& pstru =
+        dynamic_cast<PeriodicStructureAdapter&>(*stru);
+    for (int i = 0; i < pstru.countSites(); ++i)
+    {
+        pstru[i].anisotropy = false;
+        pstru[i].uij_cartn = R3::identity() * uiso;
+    }
+    return stru;
+}
+
+}   // namespace
+
+class TestBraggStructureFactorCalculator : public CxxTest::TestSuite
+{
+    private:
+
+        boost::shared_ptr<BraggStructureFactorCalculator> mbragg;
+
+    public:
+
+        void setUp()
+        {
+            mbragg.reset(new BraggStructureFactorCalculator);
+        }
+
+
+        void test_eval()
+        {
+            TS_ASSERT(mbragg->value().empty());
+            TS_ASSERT_EQUALS(0, mbragg->countReflections());
+            StructureAdapterPtr ni = loadIsotropicStructure("Ni.stru", 0.005);
+            mbragg->eval(ni);
+            QuantityType qgrid = mbragg->getQgrid();
+            TS_ASSERT_EQUALS(qgrid.size(), mbragg->value().size());
+            TS_ASSERT_LESS_THAN(0, mbragg->countReflections());
+            TS_ASSERT_EQUALS(0, mbragg->countReflections() % 2);
+            // the strongest peak of S(Q) is the Ni (111) reflection
+            QuantityType f = mbragg->getF();
+            QuantityType s = mbragg->getS();
+            const double q111 = 2 * M_PI * sqrt(3.0) / 3.52387;
+            size_t kmax = max_element(s.begin(), s.end()) - s.begin();
+            TS_ASSERT_DELTA(q111, qgrid[kmax], mbragg->getQstep());
+            for (size_t kq = 1; kq < s.size(); ++kq)
+            {
+                TS_ASSERT_DELTA(1 + f[kq] / qgrid[kq], s[kq], 1e-12);
+            }
+            TS_ASSERT_THROWS(mbragg->eval(emptyStructureAdapter()),
+                    invalid_argument);
+            TS_ASSERT_THROWS(mbragg->setQdamp(0), invalid_argument);
+        }
+
+
+        void test_PDF_consistency()
+        {
+            StructureAdapterPtr nacl =
+                loadIsotropicStructure("NaCl.stru", 0.01);
+            mbragg->setScatteringFactorTableByType("neutron");
+            mbragg->setQmax(40);
+            mbragg->setQstep(0.01);
+            mbragg->setQdamp(0.05);
+            mbragg->eval(nacl);
+            QuantityType f = mbragg->getF();
+            PDFCalculator pdfc;
+            pdfc.setScatteringFactorTableByType("neutron");
+            pdfc.setDoubleAttr("qdamp", 0.05);
+            pdfc.setRmax(8);
+            pdfc.eval(nacl);
+            QuantityType rgrid = pdfc.getRgrid();
+            QuantityType pdf = pdfc.getPDF();
+            // sine transform of F(Q) matches the PDF with Q-resolution
+            const double& dq = mbragg->getQstep();
+            for (size_t i = 100; i < rgrid.size(); i += 25)
+            {
+                const double r = rgrid[i];
+                double g = 0.0;
+                for (size_t kq = 0; kq < f.size(); ++kq)
+                {
+                    g += f[kq] * sin(kq * dq * r);
+                }
+                g *= 2 / M_PI * dq;
+                TS_ASSERT_DELTA(pdf[i], g, 1e-3 * (1 + fabs(pdf[i])));
+            }
+        }
+
+
+        void test_CrystalStructureAdapter()
+        {
+            StructureAdapterPtr nacl =
+                loadIsotropicStructure("NaCl.stru", 0.008);
+            const PeriodicStructureAdapter& pnacl =
+                dynamic_cast<const PeriodicStructureAdapter&>(*nacl);
+            // asymmetric unit with the face centering translations
+            CrystalStructureAdapterPtr cnacl(new CrystalStructureAdapter);
+            const Lattice& L = pnacl.getLattice();
+            cnacl->setLatPar(L.a(), L.b(), L.c(),
+                    L.alpha(), L.beta(), L.gamma());
+            cnacl->append(pnacl[0]);
+            cnacl->append(pnacl[4]);
+            cnacl->addSymOp(R3::identity(), R3::Vector(0.0, 0.0, 0.0));
+            cnacl->addSymOp(R3::identity(), R3::Vector(0.0, 0.5, 0.5));
+            cnacl->addSymOp(R3::identity(), R3::Vector(0.5, 0.0, 0.5));
+            cnacl->addSymOp(R3::identity(), R3::Vector(0.5, 0.5, 0.0));
+            TS_ASSERT_EQUALS(pnacl.totalOccupancy(), cnacl->totalOccupancy());
+            QuantityType f0 = mbragg->eval(nacl);
+            QuantityType f1 = mbragg->eval(cnacl);
+            TS_ASSERT_EQUALS(f0.size(), f1.size());
+            for (size_t kq = 0; kq < f0.size() && kq < f1.size(); ++kq)
+            {
+                TS_ASSERT_DELTA(f0[kq], f1[kq], 1e-8 * (1 + fabs(f0[kq])));
+            }
+        }
+
+
+        void test_serialization()
+        {
+            mbragg->setQmin(1.0);
+            mbragg->setQdamp(0.02);
+            mbragg->setScatteringFactorTableByType("neutron");
+            BraggStructureFactorCalculator bragg1;
+            diffpy::serialization_fromstring(bragg1,
+                    diffpy::serialization_tostring(*mbragg));
+            TS_ASSERT_EQUALS(1.0, bragg1.getQmin());
+            TS_ASSERT_EQUALS(0.02, bragg1.getDoubleAttr("qdamp"));
+            TS_ASSERT_EQUALS("N", bragg1.getRadiationType());
+        }
+
+};  // class TestBraggStructureFactorCalculator
+
+// End of file
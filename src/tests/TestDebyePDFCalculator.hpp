@@ -26,6 +26,7 @@
 #include <diffpy/srreal/ConstantPeakWidth.hpp>
 #include <diffpy/srreal/QResolutionEnvelope.hpp>
 #include <diffpy/serialization.hpp>
+#include "test_helpers.hpp"
 
 using namespace std;
 using namespace diffpy::srreal;
@@ -43,6 +44,53 @@ class TestDebyePDFCalculator : public CxxTest::TestSuite
         diffpy::mathutils::EpsilonEqual allclose;
         double meps;
 
+        AtomicStructureAdapterPtr gradientsStructure() const
+        {
+            AtomicStructureAdapterPtr stru(new AtomicStructureAdapter);
+            Atom ai;
+            ai.atomtype = "C";
+            ai.uij_cartn = R3::identity() * 0.005;
+            const double xyz[4][3] = {
+                {0, 0, 0}, {1.5, 0.1, 0}, {0.2, 1.4, 0.3}, {1.1, 1.2, 1.6}};
+            for (int i = 0; i < 4; ++i)
+            {
+                ai.xyz_cartn = R3::Vector(xyz[i][0], xyz[i][1], xyz[i][2]);
+                stru->append(ai);
+            }
+            (*stru)[2].atomtype = "O";
+            (*stru)[2].anisotropy = true;
+            (*stru)[2].uij_cartn(0, 0) = 0.012;
+            (*stru)[2].uij_cartn(0, 1) = (*stru)[2].uij_cartn(1, 0) = 0.002;
+            return stru;
+        }
+
+
+        void configureGradients(DebyePDFCalculator& pdfc) const
+        {
+            pdfc.setRmax(5);
+            pdfc.setQmax(25);
+            pdfc.setQmin(1);
+            pdfc.setDoubleAttr("delta2", 0.3);
+            pdfc.setDoubleAttr("qdamp", 0.02);
+        }
+
+
+        void checkDerivative(const QuantityType& yhi, const QuantityType& ylo,
+                double h, const QuantityType& dy) const
+        {
+            TS_ASSERT_EQUALS(yhi.size(), dy.size());
+            double dmax = 0.0;
+            double gmax = 0.0;
+            for (size_t i = 0; i < yhi.size() && i < dy.size(); ++i)
+            {
+                double gnum = (yhi[i] - ylo[i]) / (2 * h);
+                dmax = max(dmax, fabs(gnum - dy[i]));
+                gmax = max(gmax, fabs(gnum));
+            }
+            TS_ASSERT_LESS_THAN(0.0, gmax);
+            TS_ASSERT_LESS_THAN(dmax, 1e-5 * gmax);
+        }
+
     public:
 
         void setUp()
@@ -193,6 +241,7 @@ class TestDebyePDFCalculator : public CxxTest::TestSuite
             mpdfc->setPeakWidthModelByType("constant");
             mpdfc->setDoubleAttr("width", 0.123);
             mpdfc->setDoubleAttr("debyeprecision", 0.00011);
+            mpdfc->setDistanceBinning(true);
             mpdfc->setScatteringFactorTableByType("electronnumber");
             mpdfc->getScatteringFactorTable()->setCustomAs("H", "H", 1.1);
             // dump it to string
@@ -207,6 +256,7 @@ class TestDebyePDFCalculator : public CxxTest::TestSuite
                     pdfc1->getPeakWidthModel()->type());
             TS_ASSERT_EQUALS(0.123, pdfc1->getDoubleAttr("width"));
             TS_ASSERT_EQUALS(0.00011, pdfc1->getDoubleAttr("debyeprecision"));
+            TS_ASSERT(pdfc1->getDistanceBinning());
             TS_ASSERT_EQUALS(string("electronnumber"),
                     pdfc1->getScatteringFactorTable()->type());
             TS_ASSERT_EQUALS(1.1,
@@ -214,6 +264,252 @@ class TestDebyePDFCalculator : public CxxTest::TestSuite
         }
 
 
+        void test_getPDFPositionJacobian()
+        {
+            AtomicStructureAdapterPtr stru = this->gradientsStructure();
+            DebyePDFCalculator& pdfc = *mpdfc;
+            this->configureGradients(pdfc);
+            TS_ASSERT_THROWS(pdfc.getPDFPositionJacobian(), logic_error);
+            pdfc.setPositionGradients(true);
+            pdfc.eval(stru);
+            vector<QuantityType> fjac = pdfc.getFPositionJacobian();
+            vector<QuantityType> jac = pdfc.getPDFPositionJacobian();
+            TS_ASSERT_EQUALS(12u, fjac.size());
+            TS_ASSERT_EQUALS(12u, jac.size());
+            // compare with central differences
+            const double h = 1e-5;
+            DebyePDFCalculator pdfc1;
+            this->configureGradients(pdfc1);
+            for (int row = 0; row < 12; ++row)
+            {
+                AtomicStructureAdapterPtr stru1(
+                        new AtomicStructureAdapter(*stru));
+                (*stru1)[row / 3].xyz_cartn[row % 3] += h;
+                pdfc1.eval(stru1);
+                QuantityType fhi = pdfc1.getF();
+                QuantityType pdfhi = pdfc1.getPDF();
+                (*stru1)[row / 3].xyz_cartn[row % 3] -= 2 * h;
+                pdfc1.eval(stru1);
+                QuantityType flo = pdfc1.getF();
+                QuantityType pdflo = pdfc1.getPDF();
+                this->checkDerivative(fhi, flo, h, fjac[row]);
+                this->checkDerivative(pdfhi, pdflo, h, jac[row]);
+            }
+            // fast updates keep the derivatives consistent
+            (*stru)[1].xyz_cartn[2] += 0.1;
+            pdfc.eval(stru);
+            TS_ASSERT_EQUALS(OPTIMIZED, pdfc.getEvaluatorTypeUsed());
+            fjac = pdfc.getFPositionJacobian();
+            DebyePDFCalculator pdfc2;
+            this->configureGradients(pdfc2);
+            pdfc2.setEvaluatorType(BASIC);
+            pdfc2.setPositionGradients(true);
+            pdfc2.eval(stru);
+            vector<QuantityType> fjac2 = pdfc2.getFPositionJacobian();
+            TS_ASSERT_EQUALS(fjac2.size(), fjac.size());
+            for (size_t row = 0; row < fjac.size(); ++row)
+            {
+                TS_ASSERT(allclose(fjac2[row], fjac[row]));
+            }
+            // parallel evaluation merges the derivatives
+            const int ncpu = 3;
+            DebyePDFCalculator pmaster;
+            this->configureGradients(pmaster);
+            pmaster.setPositionGradients(true);
+            pmaster.setStructure(stru);
+            for (int cpuindex = 0; cpuindex < ncpu; ++cpuindex)
+            {
+                DebyePDFCalculator pslave;
+                this->configureGradients(pslave);
+                pslave.setPositionGradients(true);
+                pslave.setupParallelRun(cpuindex, ncpu);
+                pslave.eval(stru);
+                pmaster.mergeParallelData(pslave.getParallelData(), ncpu);
+            }
+            vector<QuantityType> fjacm = pmaster.getFPositionJacobian();
+            for (size_t row = 0; row < fjac.size(); ++row)
+            {
+                TS_ASSERT(allclose(fjac2[row], fjacm[row]));
+            }
+        }
+
+
+        void test_getPDFDerivative()
+        {
+            AtomicStructureAdapterPtr stru = this->gradientsStructure();
+            DebyePDFCalculator& pdfc = *mpdfc;
+            this->configureGradients(pdfc);
+            const char* pnames[] = {"delta2", "Uiso:C", "U12:O", "U22:O"};
+            vector<string> names(pnames, pnames + 4);
+            pdfc.setParameterGradients(names);
+            TS_ASSERT_EQUALS(names, pdfc.getParameterGradients());
+            TS_ASSERT_THROWS(pdfc.getPDFDerivative("delta2"), logic_error);
+            TS_ASSERT_THROWS(pdfc.getPDFDerivative("delta1"),
+                    invalid_argument);
+            pdfc.eval(stru);
+            // compare with central differences
+            const double h = 1e-6;
+            DebyePDFCalculator pdfc1;
+            for (size_t ip = 0; ip < names.size(); ++ip)
+            {
+                const string& nm = names[ip];
+                QuantityType fhilo[2], pdfhilo[2];
+                for (int j = 0; j < 2; ++j)
+                {
+                    const double dh = j ? -h : +h;
+                    AtomicStructureAdapterPtr stru1(
+                            new AtomicStructureAdapter(*stru));
+                    this->configureGradients(pdfc1);
+                    if (nm == "delta2")
+                    {
+                        pdfc1.setDoubleAttr(nm, pdfc1.getDoubleAttr(nm) + dh);
+                    }
+                    for (int i = 0; i < stru1->countSites(); ++i)
+                    {
+                        R3::Matrix& U = (*stru1)[i].uij_cartn;
+                        const string& tp = (*stru1)[i].atomtype;
+                        if (nm == "Uiso:C" && tp == "C")
+                        {
+                            U += dh * R3::identity();
+                        }
+                        if (nm == "U12:O" && tp == "O")
+                        {
+                            U(0, 1) += dh;
+                            U(1, 0) += dh;
+                        }
+                        if (nm == "U22:O" && tp == "O")  U(1, 1) += dh;
+                    }
+                    pdfc1.eval(stru1);
+                    fhilo[j] = pdfc1.getF();
+                    pdfhilo[j] = pdfc1.getPDF();
+                }
+                this->checkDerivative(fhilo[0], fhilo[1], h,
+                        pdfc.getFDerivative(nm));
+                this->checkDerivative(pdfhilo[0], pdfhilo[1], h,
+                        pdfc.getPDFDerivative(nm));
+            }
+        }
+
+
+        void test_setDistanceBinning()
+        {
+            // cluster with sharp pairs among the atoms of zero Uiso
+            AtomicStructureAdapterPtr stru(new AtomicStructureAdapter);
+            Atom ai;
+            for (int m = 0; m < 125; ++m)
+            {
+                ai.atomtype = (m % 2) ? "C" : "O";
+                ai.xyz_cartn = R3::Vector(2.0 * (m / 25) + 0.1 * sin(m),
+                        2.0 * (m / 5 % 5), 2.0 * (m % 5) + 0.1 * cos(m));
+                ai.uij_cartn = R3::identity() * ((m % 7) ? 0.004 : 0.0);
+                stru->append(ai);
+            }
+            DebyePDFCalculator& pdfc = *mpdfc;
+            pdfc.setRmax(12);
+            TS_ASSERT(!pdfc.getDistanceBinning());
+            pdfc.eval(stru);
+            QuantityType f0 = pdfc.getF();
+            pdfc.setDistanceBinning(true);
+            TS_ASSERT(pdfc.getDistanceBinning());
+            pdfc.eval(stru);
+            TS_ASSERT_EQUALS(BASIC, pdfc.getEvaluatorTypeUsed());
+            QuantityType f1 = pdfc.getF();
+            const double fmax = fabs(*max_element(f0.begin(), f0.end()));
+            TS_ASSERT_EQUALS(f0.size(), f1.size());
+            for (size_t kq = 0; kq < f0.size() && kq < f1.size(); ++kq)
+            {
+                TS_ASSERT_DELTA(f0[kq], f1[kq], 1e-4 * fmax);
+            }
+            // fast updates match complete evaluation
+            (*stru)[3].xyz_cartn[1] += 0.3;
+            (*stru)[4].atomtype = "N";
+            pdfc.eval(stru);
+            TS_ASSERT_EQUALS(OPTIMIZED, pdfc.getEvaluatorTypeUsed());
+            QuantityType f2 = pdfc.getF();
+            DebyePDFCalculator pdfcb;
+            pdfcb.setRmax(12);
+            pdfcb.setEvaluatorType(BASIC);
+            pdfcb.setDistanceBinning(true);
+            pdfcb.eval(stru);
+            QuantityType fb = pdfcb.getF();
+            TS_ASSERT_EQUALS(fb.size(), f2.size());
+            for (size_t kq = 0; kq < fb.size() && kq < f2.size(); ++kq)
+            {
+                TS_ASSERT_DELTA(fb[kq], f2[kq], 1e-8 * fmax);
+            }
+        }
+
+
+        void test_setMixedPrecision()
+        {
+            StructureAdapterPtr stru =
+                loadTestPeriodicStructure("ZnS_wurtzite.stru");
+            mpdfc->setPeakWidthModelByType("constant");
+            mpdfc->setDoubleAttr("width", 0.1);
+            DebyePDFCalculator& pdfc = *mpdfc;
+            pdfc.setRmax(10);
+            pdfc.setQmax(25);
+            pdfc.eval(stru);
+            QuantityType f0 = pdfc.getF();
+            TS_ASSERT(!pdfc.getMixedPrecision());
+            pdfc.setMixedPrecision(true);
+            TS_ASSERT(pdfc.getMixedPrecision());
+            pdfc.eval(stru);
+            TS_ASSERT_EQUALS(BASIC, pdfc.getEvaluatorTypeUsed());
+            QuantityType f1 = pdfc.getF();
+            TS_ASSERT_EQUALS(f0.size(), f1.size());
+            TS_ASSERT_DIFFERS(f0, f1);
+            double fmax = 0.0;
+            for (double fi : f0)  fmax = max(fmax, fabs(fi));
+            for (size_t kq = 0; kq < f0.size() && kq < f1.size(); ++kq)
+            {
+                TS_ASSERT_DELTA(f0[kq], f1[kq], 1e-5 * fmax);
+            }
+            // serialization keeps the flag
+            DebyePDFCalculator pdfc2;
+            diffpy::serialization_fromstring(pdfc2,
+                    diffpy::serialization_tostring(pdfc));
+            TS_ASSERT(pdfc2.getMixedPrecision());
+        }
+
+
+        void test_getChiSquared()
+        {
+            StructureAdapterPtr stru =
+                loadTestPeriodicStructure("ZnS_wurtzite.stru");
+            mpdfc->setPeakWidthModelByType("constant");
+            mpdfc->setDoubleAttr("width", 0.1);
+            mpdfc->setRmax(10);
+            mpdfc->setQmax(25);
+            TS_ASSERT_THROWS(mpdfc->getChiSquared(), logic_error);
+            mpdfc->eval(stru);
+            QuantityType gobs = mpdfc->getPDF();
+            QuantityType wt(gobs.size());
+            for (size_t i = 0; i < wt.size(); ++i)  wt[i] = 1.0 + i % 3;
+            TS_ASSERT_THROWS(mpdfc->setObservedPDF(gobs, QuantityType(3)),
+                    invalid_argument);
+            mpdfc->setObservedPDF(gobs, wt);
+            TS_ASSERT_EQUALS(gobs, mpdfc->getObservedPDF());
+            TS_ASSERT_DELTA(0.0, mpdfc->getChiSquared(), meps);
+            mpdfc->setDoubleAttr("width", 0.15);
+            mpdfc->eval(stru);
+            QuantityType gcalc = mpdfc->getPDF();
+            QuantityType res = mpdfc->getResidual();
+            TS_ASSERT_EQUALS(gobs.size(), res.size());
+            double chisq = 0.0, wgobs2 = 0.0;
+            for (size_t i = 0; i < gobs.size() && i < res.size(); ++i)
+            {
+                const double dg = gcalc[i] - gobs[i];
+                TS_ASSERT_DELTA(sqrt(wt[i]) * dg, res[i], meps);
+                chisq += wt[i] * dg * dg;
+                wgobs2 += wt[i] * gobs[i] * gobs[i];
+            }
+            TS_ASSERT_LESS_THAN(0.0, chisq);
+            TS_ASSERT_DELTA(chisq, mpdfc->getChiSquared(), 1e-10 * chisq);
+            TS_ASSERT_DELTA(sqrt(chisq / wgobs2), mpdfc->getRw(), meps);
+        }
+
+
         void test_DBPDF_change_atom()
         {
             using std::placeholders::_1;
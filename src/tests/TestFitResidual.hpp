@@ -0,0 +1,101 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestFitResidual -- unit tests for FitResidual class
+*
+*****************************************************************************/
+
+#include <stdexcept>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/FitResidual.hpp>
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestFitResidual : public CxxTest::TestSuite
+{
+    private:
+
+        FitResidual mfit;
+        QuantityType myobs;
+
+        double chisq(const QuantityType& ycalc) const
+        {
+            double rv = 0.0;
+            for (size_t i = 0; i < ycalc.size(); ++i)
+            {
+                const double dy = ycalc[i] - myobs[i];
+                rv += dy * dy;
+            }
+            return rv;
+        }
+
+    public:
+
+        void setUp()
+        {
+            myobs.resize(100);
+            for (size_t i = 0; i < myobs.size(); ++i)
+            {
+                myobs[i] = 0.01 * i * (i % 7);
+            }
+            mfit.setObserved(myobs);
+        }
+
+
+        void test_updateWindow()
+        {
+            QuantityType ycalc = myobs;
+            ycalc[5] += 0.5;
+            mfit.update(ycalc);
+            TS_ASSERT_EQUALS(0.25, mfit.chiSquared());
+            TS_ASSERT_THROWS(mfit.updateWindow(98, QuantityType(3)),
+                    out_of_range);
+            TS_ASSERT_THROWS(mfit.updateWindow(-1, QuantityType(1)),
+                    out_of_range);
+            // exact match after large cancellation
+            mfit.updateWindow(5, QuantityType(1, myobs[5] + 1e8));
+            mfit.updateWindow(5, QuantityType(1, myobs[5]));
+            TS_ASSERT_EQUALS(0.0, mfit.chiSquared());
+        }
+
+
+        void test_updateWindowDrift()
+        {
+            // rounding errors of large terms are not kept in small sums
+            QuantityType ycalc = myobs;
+            for (size_t i = 0; i < ycalc.size(); ++i)
+            {
+                ycalc[i] += 1e-4 * (i % 3);
+            }
+            mfit.update(ycalc);
+            const double chisq0 = this->chisq(ycalc);
+            TS_ASSERT_DELTA(chisq0, mfit.chiSquared(), 1e-12 * chisq0);
+            const int nupdates = 3 * FitResidual::FULL_UPDATE_INTERVAL;
+            for (int k = 0; k < nupdates; ++k)
+            {
+                const int lo = (7 * k) % 90;
+                QuantityType w0(ycalc.begin() + lo, ycalc.begin() + lo + 10);
+                QuantityType w1 = w0;
+                for (double& y : w1)  y += 1e4;
+                mfit.updateWindow(lo, w1);
+                mfit.updateWindow(lo, w0);
+                TS_ASSERT_DELTA(chisq0, mfit.chiSquared(), 1e-10 * chisq0);
+            }
+        }
+
+};  // class TestFitResidual
+
+// End of file
@@ -0,0 +1,215 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestMPIEvaluator -- unit tests for distributed evaluation with MPI
+*
+* The tests pass for any number of processes.  Run them distributed with
+*
+*     scons alltests tests=mpi
+*     mpirun -np 3 build/fast-x86_64/tests/alltests
+*
+*****************************************************************************/
+
+#include <cstdlib>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/MPIEvaluator.hpp>
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/DebyePDFCalculator.hpp>
+#include <diffpy/srreal/BondCalculator.hpp>
+#include <diffpy/srreal/OverlapCalculator.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+using diffpy::mathutils::EpsilonEqual;
+
+namespace {
+
+void finalizeMPI()
+{
+    int finalized;
+    MPI_Finalized(&finalized);
+    if (!finalized)  MPI_Finalize();
+}
+
+
+void initializeMPI()
+{
+    int initialized;
+    MPI_Initialized(&initialized);
+    if (initialized)  return;
+    MPI_Init(NULL, NULL);
+    atexit(finalizeMPI);
+}
+
+}   // namespace
+
+class TestMPIEvaluator : public CxxTest::TestSuite
+{
+    private:
+
+        EpsilonEqual allclose;
+        PeriodicStructureAdapterPtr mstru;
+        boost::shared_ptr<MPIEvaluator> mmpi;
+
+        /// move atoms in place in the same way in all processes
+        void rattle(int seed)
+        {
+            for (int i = 0; i < mstru->countSites(); ++i)
+            {
+                R3::Vector dxyz(sin(i + seed), cos(3 * i + seed),
+                        sin(2 * i - seed));
+                (*mstru)[i].xyz_cartn += 0.05 * dxyz;
+            }
+        }
+
+        /// structure argument that is only given in the root process
+        StructureAdapterPtr rootStructure() const
+        {
+            return mmpi->isRoot() ? mstru : StructureAdapterPtr();
+        }
+
+    public:
+
+        void setUp()
+        {
+            initializeMPI();
+            mmpi.reset(new MPIEvaluator);
+            mstru = boost::dynamic_pointer_cast<PeriodicStructureAdapter>(
+                    loadTestPeriodicStructure("ZnS_wurtzite.stru"));
+            for (Atom& a : *mstru)  a.uij_cartn = R3::identity() * 0.004;
+        }
+
+
+        void test_ctor()
+        {
+            int rank, size;
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+            MPI_Comm_size(MPI_COMM_WORLD, &size);
+            TS_ASSERT_EQUALS(rank, mmpi->rank());
+            TS_ASSERT_EQUALS(size, mmpi->size());
+            TS_ASSERT_EQUALS(0, mmpi->getRoot());
+            TS_ASSERT_EQUALS(rank == 0, mmpi->isRoot());
+            TS_ASSERT_THROWS(MPIEvaluator(MPI_COMM_WORLD, size),
+                    invalid_argument);
+        }
+
+
+        void test_broadcastStructure()
+        {
+            // other processes receive the root structure
+            StructureAdapterPtr stru =
+                mmpi->broadcastStructure(this->rootStructure());
+            TS_ASSERT_EQUALS(1, mmpi->countFullBroadcasts());
+            TS_ASSERT_EQUALS(mmpi->isRoot(), stru == mstru);
+            TS_ASSERT(*mstru ==
+                    dynamic_cast<PeriodicStructureAdapter&>(*stru));
+            // position changes update the copies in place
+            this->rattle(1);
+            (*mstru)[1].occupancy = 0.5;
+            (*mstru)[2].anisotropy = true;
+            (*mstru)[2].uij_cartn(0, 1) = (*mstru)[2].uij_cartn(1, 0) = 0.001;
+            StructureAdapterPtr stru1 =
+                mmpi->broadcastStructure(this->rootStructure());
+            TS_ASSERT_EQUALS(1, mmpi->countFullBroadcasts());
+            TS_ASSERT_EQUALS(stru, stru1);
+            TS_ASSERT(*mstru ==
+                    dynamic_cast<PeriodicStructureAdapter&>(*stru));
+            // lattice and atom type changes send the whole structure
+            mstru->setLatPar(3.9, 3.9, 6.3, 90, 90, 120);
+            mmpi->broadcastStructure(mstru);
+            TS_ASSERT_EQUALS(2, mmpi->countFullBroadcasts());
+            (*mstru)[0].atomtype = "Cd";
+            mmpi->broadcastStructure(mstru);
+            TS_ASSERT_EQUALS(3, mmpi->countFullBroadcasts());
+            mmpi->broadcastStructure(StructureAdapterPtr());
+            TS_ASSERT_EQUALS(4, mmpi->countFullBroadcasts());
+        }
+
+
+        void test_PDFCalculator()
+        {
+            PDFCalculator pdfc0, pdfc1;
+            pdfc0.setRmax(15);
+            pdfc1.setRmax(15);
+            pdfc1.setPositionGradients(true);
+            for (int seed = 0; seed < 3; ++seed)
+            {
+                this->rattle(seed);
+                pdfc0.eval(mstru);
+                mmpi->eval(pdfc1, this->rootStructure());
+                TS_ASSERT(allclose(pdfc0.getPDF(), pdfc1.getPDF()));
+            }
+            TS_ASSERT_EQUALS(1, mmpi->countFullBroadcasts());
+            // derivatives are reduced together with the value
+            PDFCalculator pdfc2 = pdfc1;
+            pdfc2.eval(mstru);
+            vector<QuantityType> jac1 = pdfc1.getPDFPositionJacobian();
+            vector<QuantityType> jac2 = pdfc2.getPDFPositionJacobian();
+            TS_ASSERT_EQUALS(jac2.size(), jac1.size());
+            for (size_t i = 0; i < jac1.size(); ++i)
+            {
+                TS_ASSERT(allclose(jac2[i], jac1[i]));
+            }
+        }
+
+
+        void test_DebyePDFCalculator()
+        {
+            DebyePDFCalculator dbpdfc0, dbpdfc1;
+            dbpdfc0.setQmax(20);
+            dbpdfc1.setQmax(20);
+            dbpdfc0.eval(mstru);
+            mmpi->eval(dbpdfc1, mstru);
+            TS_ASSERT(allclose(dbpdfc0.getF(), dbpdfc1.getF()));
+            TS_ASSERT(allclose(dbpdfc0.getPDF(), dbpdfc1.getPDF()));
+        }
+
+
+        void test_BondCalculator()
+        {
+            BondCalculator bdc0, bdc1;
+            bdc0.setRmax(5);
+            bdc1.setRmax(5);
+            bdc0.eval(mstru);
+            mmpi->eval(bdc1, mstru);
+            TS_ASSERT_EQUALS(bdc0.distances().size(), bdc1.distances().size());
+            TS_ASSERT(allclose(bdc0.distances(), bdc1.distances()));
+            TS_ASSERT_EQUALS(bdc0.sites0(), bdc1.sites0());
+            TS_ASSERT_EQUALS(bdc0.sites1(), bdc1.sites1());
+        }
+
+
+        void test_OverlapCalculator()
+        {
+            OverlapCalculator olc0, olc1;
+            for (OverlapCalculator* olc : {&olc0, &olc1})
+            {
+                olc->getAtomRadiiTable()->setCustom("Zn", 1.4);
+                olc->getAtomRadiiTable()->setCustom("S", 1.2);
+            }
+            olc0.eval(mstru);
+            mmpi->eval(olc1, mstru);
+            TS_ASSERT_LESS_THAN(0.0, olc0.totalSquareOverlap());
+            TS_ASSERT_DELTA(olc0.totalSquareOverlap(),
+                    olc1.totalSquareOverlap(), 1e-10);
+            TS_ASSERT_EQUALS(olc0.distances().size(),
+                    olc1.distances().size());
+        }
+
+};  // class TestMPIEvaluator
+
+// End of file
@@ -0,0 +1,196 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestMemoryUsage -- unit tests for the memory footprint accounting
+*     of calculators and structure adapters
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/MemoryUsage.hpp>
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/NoSymmetryStructureAdapter.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/DebyePDFCalculator.hpp>
+#include <diffpy/srreal/BondCalculator.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestMemoryUsage : public CxxTest::TestSuite
+{
+    private:
+
+        StructureAdapterPtr mni;
+
+    public:
+
+        void setUp()
+        {
+            if (!mni)  mni = loadTestPeriodicStructure("Ni.stru");
+        }
+
+
+        void test_MemoryUsage()
+        {
+            MemoryUsage mu;
+            TS_ASSERT_EQUALS(0u, mu.total());
+            mu.add("value", 100);
+            mu.add("value", 20);
+            mu.add("stash", 7);
+            TS_ASSERT_EQUALS(120u, mu.component("value"));
+            TS_ASSERT_EQUALS(0u, mu.component("invalid"));
+            TS_ASSERT_EQUALS(127u, mu.total());
+            MemoryUsage mu1;
+            mu1.add(mu, "evaluator.");
+            mu1.add(mu);
+            TS_ASSERT_EQUALS(4u, mu1.components().size());
+            TS_ASSERT_EQUALS(7u, mu1.component("evaluator.stash"));
+            TS_ASSERT_EQUALS(254u, mu1.total());
+        }
+
+
+        void test_byteSize()
+        {
+            // short strings are stored in place, longer on the heap
+            const string s0 = "Ni";
+            TS_ASSERT_EQUALS(0u, byteSize(s0));
+            for (size_t n = 16; n < 2 * sizeof(string); ++n)
+            {
+                const string s1(n, 'x');
+                TS_ASSERT_LESS_THAN_EQUALS(n + 1, byteSize(s1));
+            }
+        }
+
+
+        void test_AtomicStructureAdapter()
+        {
+            AtomicStructureAdapterPtr stru(new AtomicStructureAdapter);
+            TS_ASSERT_EQUALS(0u, stru->memoryUsage().total());
+            stru->assign(100, Atom());
+            MemoryUsage mu = stru->memoryUsage();
+            TS_ASSERT_EQUALS(1u, mu.components().size());
+            TS_ASSERT_LESS_THAN_EQUALS(
+                    100 * sizeof(Atom), mu.component("atoms"));
+            StructureAdapterPtr nsstru = nosymmetry(stru);
+            TS_ASSERT_EQUALS(mu.total(), nsstru->memoryUsage().total());
+        }
+
+
+        void test_CrystalStructureAdapter()
+        {
+            CrystalStructureAdapterPtr stru(new CrystalStructureAdapter);
+            Atom ai;
+            ai.xyz_cartn = R3::Vector(0.1, 0.2, 0.3);
+            stru->append(ai);
+            stru->addSymOp(R3::identity(), R3::Vector(0.0, 0.0, 0.0));
+            stru->addSymOp(-1 * R3::identity(), R3::Vector(0.0, 0.0, 0.0));
+            stru->updateSymmetryPositions();
+            MemoryUsage mu = stru->memoryUsage();
+            TS_ASSERT_LESS_THAN_EQUALS(sizeof(Atom), mu.component("atoms"));
+            TS_ASSERT_LESS_THAN_EQUALS(
+                    2 * sizeof(SymOpRotTrans), mu.component("symops"));
+            TS_ASSERT_LESS_THAN_EQUALS(
+                    2 * sizeof(Atom), mu.component("symatoms"));
+        }
+
+
+        void test_estimateNeighborCount()
+        {
+            TS_ASSERT_EQUALS(0.0, estimateNeighborCount(mni, 0, 0));
+            double cnt = estimateNeighborCount(mni, 0, 2.6);
+            TS_ASSERT_LESS_THAN(6, cnt);
+            TS_ASSERT_LESS_THAN(cnt, 24);
+            AtomicStructureAdapterPtr pair(new AtomicStructureAdapter);
+            Atom ai;
+            pair->append(ai);
+            ai.xyz_cartn[0] = 1.5;
+            pair->append(ai);
+            TS_ASSERT_EQUALS(1.0, estimateNeighborCount(pair, 0, 100));
+        }
+
+
+        void test_PDFCalculator()
+        {
+            PDFCalculator pdfc;
+            pdfc.setEvaluatorType(BASIC);
+            pdfc.eval(mni);
+            MemoryUsage mu = pdfc.memoryUsage();
+            TS_ASSERT_EQUALS(pdfc.value().capacity() * sizeof(double),
+                    mu.component("value"));
+            TS_ASSERT_EQUALS(mni->memoryUsage().total(),
+                    mu.component("structure.atoms"));
+            TS_ASSERT_EQUALS(0u, mu.component("evaluator.laststructure.atoms"));
+            MemoryUsage est = pdfc.estimateMemoryUsage(mni);
+            TS_ASSERT_LESS_THAN_EQUALS(
+                    mu.component("value"), est.component("value"));
+            TS_ASSERT_LESS_THAN(0u, est.component("transient"));
+            TS_ASSERT_EQUALS(0u, est.component("stash"));
+            // optimized evaluator keeps a copy of the structure
+            pdfc.setEvaluatorType(OPTIMIZED);
+            pdfc.eval(mni);
+            mu = pdfc.memoryUsage();
+            TS_ASSERT_EQUALS(mni->memoryUsage().total(),
+                    mu.component("evaluator.laststructure.atoms"));
+            est = pdfc.estimateMemoryUsage(mni);
+            TS_ASSERT_LESS_THAN_EQUALS(
+                    mu.component("evaluator.laststructure.atoms"),
+                    est.component("evaluator.laststructure.atoms"));
+            TS_ASSERT_EQUALS(est.component("value"), est.component("stash"));
+        }
+
+
+        void test_DebyePDFCalculator()
+        {
+            StructureAdapterPtr catio3 =
+                loadTestPeriodicStructure("CaTiO3.stru");
+            DebyePDFCalculator dbpdfc;
+            dbpdfc.setRmax(5);
+            dbpdfc.eval(catio3);
+            MemoryUsage mu = dbpdfc.memoryUsage();
+            MemoryUsage est = dbpdfc.estimateMemoryUsage(catio3);
+            // actual arrays may have larger capacity than needed
+            TS_ASSERT_EQUALS(dbpdfc.value().size() * sizeof(double),
+                    est.component("value"));
+            TS_ASSERT_LESS_THAN_EQUALS(
+                    est.component("value"), mu.component("value"));
+            TS_ASSERT_LESS_THAN_EQUALS(
+                    est.component("sftypeatkq"), mu.component("sftypeatkq"));
+            TS_ASSERT_EQUALS(catio3->countSites() * sizeof(int),
+                    est.component("typeofsite"));
+        }
+
+
+        void test_BondCalculator()
+        {
+            BondCalculator bnds;
+            bnds.setRmax(5);
+            bnds.eval(mni);
+            const double nbonds = bnds.distances().size();
+            TS_ASSERT_LESS_THAN(0, nbonds);
+            MemoryUsage mu = bnds.memoryUsage();
+            TS_ASSERT_LESS_THAN_EQUALS(
+                    size_t(nbonds * sizeof(double)), mu.component("value"));
+            TS_ASSERT_LESS_THAN(0u, mu.component("bonds"));
+            MemoryUsage est = bnds.estimateMemoryUsage(mni);
+            double nbondsest = est.component("value") / sizeof(double);
+            TS_ASSERT_DELTA(1.0, nbondsest / nbonds, 0.3);
+        }
+
+};  // class TestMemoryUsage
+
+// End of file
@@ -0,0 +1,136 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestNUFFTDebyeCalculator -- unit tests for
+*     the NUFFTDebyeCalculator class
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <cmath>
+#include <algorithm>
+
+#include <diffpy/srreal/NUFFTDebyeCalculator.hpp>
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include <diffpy/srreal/DebyePDFCalculator.hpp>
+#include <diffpy/serialization.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+namespace {
+
+/// distorted cubic cluster of C and O atoms with two displacement values
+AtomicStructureAdapterPtr cubicCluster(int n)
+{
+    AtomicStructureAdapterPtr stru(new AtomicStructureAdapter);
+    Atom ai;
+    for (int m = 0; m < n * n * n; ++m)
+    {
+        ai.atomtype = (m % 2) ? "C" : "O";
+        ai.xyz_cartn = R3::Vector(1.5 * (m / (n * n)) + 0.1 * sin(m),
+                1.5 * (m / n % n), 1.5 * (m % n) + 0.1 * cos(m));
+        ai.uij_cartn = R3::identity() * ((m % 3) ? 0.004 : 0.009);
+        stru->append(ai);
+    }
+    return stru;
+}
+
+}   // namespace
+
+class TestNUFFTDebyeCalculator : public CxxTest::TestSuite
+{
+    private:
+
+        boost::shared_ptr<NUFFTDebyeCalculator> mnufft;
+
+    public:
+
+        void setUp()
+        {
+            mnufft.reset(new NUFFTDebyeCalculator);
+        }
+
+
+        void test_eval()
+        {
+            TS_ASSERT(mnufft->value().empty());
+            mnufft->eval(emptyStructureAdapter());
+            TS_ASSERT_EQUALS(0, mnufft->countDirections());
+            QuantityType f = mnufft->getF();
+            TS_ASSERT_EQUALS(mnufft->getQgrid().size(), f.size());
+            TS_ASSERT_EQUALS(0.0, *min_element(f.begin(), f.end()));
+            TS_ASSERT_EQUALS(0.0, *max_element(f.begin(), f.end()));
+            mnufft->eval(cubicCluster(3));
+            TS_ASSERT_LESS_THAN(0, mnufft->countDirections());
+            TS_ASSERT_THROWS(
+                    mnufft->eval(loadTestPeriodicStructure("Ni.stru")),
+                    invalid_argument);
+            TS_ASSERT_THROWS(mnufft->setQstep(0), invalid_argument);
+        }
+
+
+        void test_DebyePDFCalculator_consistency()
+        {
+            AtomicStructureAdapterPtr stru = cubicCluster(4);
+            DebyePDFCalculator dbpdfc;
+            dbpdfc.setScatteringFactorTableByType("neutron");
+            dbpdfc.setRmax(20);
+            dbpdfc.setQmax(12);
+            dbpdfc.eval(stru);
+            QuantityType f0 = dbpdfc.getF();
+            mnufft->setScatteringFactorTableByType("neutron");
+            mnufft->setQmax(dbpdfc.getQmax());
+            mnufft->setQstep(dbpdfc.getQstep());
+            mnufft->eval(stru);
+            QuantityType f1 = mnufft->getF();
+            TS_ASSERT_EQUALS(f0.size(), f1.size());
+            const double fmax = fabs(*max_element(f0.begin(), f0.end()));
+            for (size_t kq = 0; kq < f0.size() && kq < f1.size(); ++kq)
+            {
+                TS_ASSERT_DELTA(f0[kq], f1[kq], 1e-5 * fmax);
+            }
+            // Qmin cuts the values but not the directions
+            const int ndirs = mnufft->countDirections();
+            mnufft->setQmin(5.0);
+            mnufft->eval(stru);
+            TS_ASSERT_EQUALS(ndirs, mnufft->countDirections());
+            QuantityType f2 = mnufft->getF();
+            QuantityType qgrid = mnufft->getQgrid();
+            for (size_t kq = 0; kq < f2.size(); ++kq)
+            {
+                const double fexpected = (qgrid[kq] < 5.0) ? 0.0 : f1[kq];
+                TS_ASSERT_DELTA(fexpected, f2[kq], 1e-12 * fmax);
+            }
+        }
+
+
+        void test_serialization()
+        {
+            mnufft->setQmin(1.0);
+            mnufft->setDoubleAttr("debyeprecision", 1e-4);
+            mnufft->setScatteringFactorTableByType("neutron");
+            NUFFTDebyeCalculator nufft1;
+            diffpy::serialization_fromstring(nufft1,
+                    diffpy::serialization_tostring(*mnufft));
+            TS_ASSERT_EQUALS(1.0, nufft1.getQmin());
+            TS_ASSERT_EQUALS(1e-4, nufft1.getDoubleAttr("debyeprecision"));
+            TS_ASSERT_EQUALS("N", nufft1.getRadiationType());
+        }
+
+};  // class TestNUFFTDebyeCalculator
+
+// End of file
@@ -0,0 +1,177 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestNeighborListStructureAdapter -- unit tests for the bond
+*     generation from neighbor lists of trajectory frames
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/NeighborListStructureAdapter.hpp>
+#include <diffpy/srreal/CrystalStructureAdapter.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/serialization.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+using diffpy::mathutils::EpsilonEqual;
+
+class TestNeighborListStructureAdapter : public CxxTest::TestSuite
+{
+    private:
+
+        EpsilonEqual allclose;
+        PeriodicStructureAdapterPtr mnacl;
+        NeighborListStructureAdapterPtr mnblist;
+
+        /// move atoms of mnacl in place by at most dmax
+        void rattle(double dmax, int seed)
+        {
+            for (int i = 0; i < mnacl->countSites(); ++i)
+            {
+                R3::Vector dxyz(sin(7 * i + seed), cos(3 * i + seed),
+                        sin(5 * i + 2 * seed));
+                (*mnacl)[i].xyz_cartn += dxyz * (dmax / sqrt(3.0));
+            }
+        }
+
+        /// count bonds of anchor site i0 in the selected sites
+        int countBonds(BaseBondGenerator& bnds, int i0,
+                const SiteIndices& selection)
+        {
+            bnds.selectAnchorSite(i0);
+            bnds.selectSites(selection);
+            int rv = 0;
+            for (bnds.rewind(); !bnds.finished(); bnds.next())  ++rv;
+            return rv;
+        }
+
+    public:
+
+        void setUp()
+        {
+            mnacl = boost::dynamic_pointer_cast<PeriodicStructureAdapter>(
+                    loadTestPeriodicStructure("NaCl.stru"));
+            for (Atom& a : *mnacl)  a.uij_cartn = R3::identity() * 0.005;
+            mnblist.reset(new NeighborListStructureAdapter(mnacl, 0.4));
+        }
+
+
+        void test_PDF()
+        {
+            PDFCalculator pdfc;
+            pdfc.setRmax(12);
+            pdfc.eval(mnacl);
+            QuantityType g0 = pdfc.getPDF();
+            pdfc.eval(mnblist);
+            TS_ASSERT(allclose(g0, pdfc.getPDF()));
+            TS_ASSERT_EQUALS(1, mnblist->countNeighborListBuilds());
+            // small displacements reuse the neighbor list
+            this->rattle(0.15, 1);
+            mnblist->setFrame(mnacl);
+            TS_ASSERT_LESS_THAN(0.0, mnblist->getMaxDisplacement());
+            TS_ASSERT_LESS_THAN_EQUALS(mnblist->getMaxDisplacement(), 0.15);
+            pdfc.eval(mnacl);
+            QuantityType g1 = pdfc.getPDF();
+            TS_ASSERT(!allclose(g0, g1));
+            pdfc.eval(mnblist);
+            TS_ASSERT(allclose(g1, pdfc.getPDF()));
+            TS_ASSERT_EQUALS(1, mnblist->countNeighborListBuilds());
+            // large displacements rebuild it
+            this->rattle(0.3, 2);
+            mnblist->setFrame(mnacl);
+            pdfc.eval(mnacl);
+            QuantityType g2 = pdfc.getPDF();
+            pdfc.eval(mnblist);
+            TS_ASSERT(allclose(g2, pdfc.getPDF()));
+            TS_ASSERT_EQUALS(2, mnblist->countNeighborListBuilds());
+            TS_ASSERT_EQUALS(0.0, mnblist->getMaxDisplacement());
+            // lattice change rebuilds the list
+            mnacl->setLatPar(5.7, 5.7, 5.7, 90, 90, 90);
+            mnblist->setFrame(mnacl);
+            pdfc.eval(mnacl);
+            QuantityType g3 = pdfc.getPDF();
+            pdfc.eval(mnblist);
+            TS_ASSERT(allclose(g3, pdfc.getPDF()));
+            TS_ASSERT_EQUALS(3, mnblist->countNeighborListBuilds());
+        }
+
+
+        void test_selectSites()
+        {
+            this->rattle(0.1, 3);
+            mnblist->setFrame(mnacl);
+            BaseBondGeneratorPtr bnds0 = mnacl->createBondGenerator();
+            BaseBondGeneratorPtr bnds1 = mnblist->createBondGenerator();
+            bnds0->setRmax(7);
+            bnds1->setRmax(7);
+            SiteIndices selection = {6, 1, 3};
+            for (int i0 = 0; i0 < mnacl->countSites(); ++i0)
+            {
+                TS_ASSERT_EQUALS(countBonds(*bnds0, i0, selection),
+                        countBonds(*bnds1, i0, selection));
+            }
+            bnds1->selectAnchorSite(2);
+            bnds1->selectSiteRange(2, 3);
+            for (bnds1->rewind(); !bnds1->finished(); bnds1->next())
+            {
+                TS_ASSERT_EQUALS(2, bnds1->site1());
+                TS_ASSERT_DELTA(mnacl->getLattice().a(),
+                        bnds1->distance(), 1e-8);
+            }
+        }
+
+
+        void test_setFrame()
+        {
+            CrystalStructureAdapterPtr cstru(new CrystalStructureAdapter);
+            Atom a;
+            a.atomtype = "C";
+            a.xyz_cartn = R3::Vector(0.1, 0.2, 0.3);
+            cstru->append(a);
+            cstru->addSymOp(R3::identity(), R3::zerovector);
+            R3::Matrix inversion = R3::identity();
+            inversion *= -1;
+            cstru->addSymOp(inversion, R3::zerovector);
+            TS_ASSERT_THROWS(mnblist->setFrame(cstru), invalid_argument);
+            TS_ASSERT_EQUALS(mnacl, mnblist->getSourceStructure());
+            mnblist->setFrame(StructureAdapterPtr());
+            TS_ASSERT_EQUALS(0, mnblist->countSites());
+            TS_ASSERT_THROWS(mnblist->setSkin(-1), invalid_argument);
+        }
+
+
+        void test_serialization()
+        {
+            PDFCalculator pdfc;
+            pdfc.eval(mnblist);
+            QuantityType g0 = pdfc.getPDF();
+            StructureAdapterPtr nbl1;
+            diffpy::serialization_fromstring(nbl1,
+                    diffpy::serialization_tostring(
+                        StructureAdapterPtr(mnblist)));
+            TS_ASSERT(dynamic_cast<NeighborListStructureAdapter*>(
+                        nbl1.get()));
+            pdfc.eval(nbl1);
+            TS_ASSERT(allclose(g0, pdfc.getPDF()));
+            pdfc.eval(mnblist->clone());
+            TS_ASSERT(allclose(g0, pdfc.getPDF()));
+        }
+
+};  // class TestNeighborListStructureAdapter
+
+// End of file
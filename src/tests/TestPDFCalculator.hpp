@@ -20,15 +20,59 @@
 
 #include <diffpy/srreal/StructureAdapter.hpp>
 #include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
 #include <diffpy/srreal/JeongPeakWidth.hpp>
 #include <diffpy/srreal/ConstantPeakWidth.hpp>
 #include <diffpy/srreal/QResolutionEnvelope.hpp>
+#include <diffpy/srreal/QuantityAllocator.hpp>
 #include <diffpy/serialization.hpp>
 #include "test_helpers.hpp"
 
 using namespace std;
 using namespace diffpy::srreal;
 
+namespace {
+
+// structure adapter that counts the created bond generators
+template <class T>
+class CountingAdapter : public T
+{
+    public:
+
+        CountingAdapter() : mcount(0)  { }
+
+        virtual BaseBondGeneratorPtr createBondGenerator() const
+        {
+            ++mcount;
+            return this->T::createBondGenerator();
+        }
+
+        mutable int mcount;
+};
+
+typedef CountingAdapter<AtomicStructureAdapter> CountingStructureAdapter;
+typedef CountingAdapter<PeriodicStructureAdapter> CountingPeriodicAdapter;
+
+
+/// change lattice parameters at the same fractional coordinates
+/// and Cartesian displacement parameters
+void setLatParFractional(PeriodicStructureAdapter& stru,
+        double a, double b, double c,
+        double alphadeg, double betadeg, double gammadeg)
+{
+    const Lattice L0 = stru.getLattice();
+    stru.setLatPar(a, b, c, alphadeg, betadeg, gammadeg);
+    const Lattice& L1 = stru.getLattice();
+    for (int i = 0; i < stru.countSites(); ++i)
+    {
+        R3::Vector& xyz = stru[i].xyz_cartn;
+        xyz = L1.cartesian(L0.fractional(xyz));
+    }
+}
+
+}   // namespace
+
 class TestPDFCalculator : public CxxTest::TestSuite
 {
     private:
@@ -141,6 +185,35 @@ class TestPDFCalculator : public CxxTest::TestSuite
         }
 
 
+        void test_steady_state_allocations()
+        {
+            StructureAdapterPtr ni = loadTestPeriodicStructure("Ni.stru");
+            boost::shared_ptr<PooledQuantityArena>
+                arena(new PooledQuantityArena);
+            setQuantityArena(arena);
+            mpdfc->setQmax(25);
+            for (int i = 0; i < 2; ++i)
+            {
+                mpdfc->eval(ni);
+                QuantityType pdf = mpdfc->getPDF();
+            }
+            resetQuantityAllocationStats();
+            for (int i = 0; i < 3; ++i)
+            {
+                mpdfc->eval(ni);
+                QuantityType pdf = mpdfc->getPDF();
+            }
+            QuantityAllocationStats stats = getQuantityAllocationStats();
+            setQuantityArena(QuantityArenaPtr());
+            // replaced arena is kept for the buffers of the calculator
+            TS_ASSERT_LESS_THAN(1, arena.use_count());
+            TS_ASSERT_LESS_THAN(0u, stats.allocations);
+            TS_ASSERT_EQUALS(stats.allocations, stats.deallocations);
+            TS_ASSERT_EQUALS(0u, stats.newbuffers);
+            TS_ASSERT_EQUALS(0u, stats.newbytes);
+        }
+
+
         void test_getRDF()
         {
             QuantityType rdf = mpdfc->getRDF();
@@ -251,6 +324,941 @@ class TestPDFCalculator : public CxxTest::TestSuite
         }
 
 
+        void test_setBondCaching()
+        {
+            boost::shared_ptr<CountingStructureAdapter>
+                stru(new CountingStructureAdapter);
+            Atom ai;
+            ai.atomtype = "Ni";
+            ai.uij_cartn = R3::identity() * 0.004;
+            for (int i = 0; i < 27; ++i)
+            {
+                ai.xyz_cartn = 2.5 * R3::Vector(i % 3, i / 3 % 3, i / 9);
+                stru->append(ai);
+            }
+            (*stru)[0].atomtype = "Au";
+            PDFCalculator pdfc0;
+            pdfc0.setRmax(8);
+            TS_ASSERT(!mpdfc->getBondCaching());
+            mpdfc->setRmax(8);
+            mpdfc->setBondCaching(true);
+            mpdfc->eval(stru);
+            TS_ASSERT_LESS_THAN(0u, mpdfc->memoryUsage().component("bondcache"));
+            int cnt;
+            // width changes are rendered from the bond table
+            const char* pnames[] = {"delta1", "delta2", "qbroad"};
+            const double pvalues[] = {0.3, 1.5, 0.02};
+            for (int k = 0; k < 3; ++k)
+            {
+                mpdfc->setDoubleAttr(pnames[k], pvalues[k]);
+                pdfc0.setDoubleAttr(pnames[k], pvalues[k]);
+                cnt = stru->mcount;
+                QuantityType pdf1 = mpdfc->eval(stru);
+                TS_ASSERT_EQUALS(cnt, stru->mcount);
+                QuantityType pdf0 = pdfc0.eval(stru);
+                TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+                for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+                }
+            }
+            // peak profile precision is replayed as well
+            mpdfc->setDoubleAttr("peakprecision", 1e-4);
+            cnt = stru->mcount;
+            mpdfc->eval(stru);
+            TS_ASSERT_EQUALS(cnt, stru->mcount);
+            // other changes need a complete evaluation
+            mpdfc->setDoubleAttr("rstep", 0.02);
+            mpdfc->eval(stru);
+            TS_ASSERT_LESS_THAN(cnt, stru->mcount);
+            (*stru)[1].xyz_cartn[0] += 0.1;
+            mpdfc->setDoubleAttr("delta2", 1.0);
+            pdfc0.setDoubleAttr("rstep", 0.02);
+            pdfc0.setDoubleAttr("delta2", 1.0);
+            pdfc0.setDoubleAttr("peakprecision", 1e-4);
+            QuantityType pdf1 = mpdfc->eval(stru);
+            QuantityType pdf0 = pdfc0.eval(stru);
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+            mpdfc->setBondCaching(false);
+            TS_ASSERT_EQUALS(0u, mpdfc->memoryUsage().component("bondcache"));
+        }
+
+
+        void test_setBondCachingParallel()
+        {
+            PeriodicStructureAdapterPtr ni =
+                boost::dynamic_pointer_cast<PeriodicStructureAdapter>(
+                        loadTestPeriodicStructure("Ni.stru"));
+            for (Atom& a : *ni)  a.uij_cartn = R3::identity() * 0.004;
+            PDFCalculator pdfc0;
+            pdfc0.setRmax(8);
+            mpdfc->setRmax(8);
+            mpdfc->setBondCaching(true);
+            mpdfc->eval(ni);
+            // merged value has no bond table for the width updates
+            const int ncpu = 2;
+            mpdfc->setStructure(ni);
+            for (int cpuindex = 0; cpuindex < ncpu; ++cpuindex)
+            {
+                PDFCalculator pslave;
+                pslave.setRmax(8);
+                pslave.setBondCaching(true);
+                pslave.setupParallelRun(cpuindex, ncpu);
+                pslave.eval(ni);
+                mpdfc->mergeParallelData(pslave.getParallelData(), ncpu);
+            }
+            pdfc0.eval(ni);
+            QuantityType pdf0 = pdfc0.getPDF();
+            QuantityType pdf1 = mpdfc->getPDF();
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+            mpdfc->setDoubleAttr("delta2", 2.0);
+            pdfc0.setDoubleAttr("delta2", 2.0);
+            pdfc0.eval(ni);
+            pdf0 = pdfc0.getPDF();
+            mpdfc->eval(ni);
+            pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+        }
+
+
+        void test_replayDisplacedPairs()
+        {
+            boost::shared_ptr<CountingStructureAdapter>
+                stru(new CountingStructureAdapter);
+            Atom ai;
+            ai.atomtype = "Ni";
+            ai.uij_cartn = R3::identity() * 0.004;
+            for (int i = 0; i < 27; ++i)
+            {
+                ai.xyz_cartn = 2.5 * R3::Vector(i % 3, i / 3 % 3, i / 9);
+                stru->append(ai);
+            }
+            (*stru)[0].atomtype = "Au";
+            (*stru)[5].anisotropy = true;
+            PDFCalculator pdfc0;
+            pdfc0.setRmax(8);
+            pdfc0.setEvaluatorType(BASIC);
+            mpdfc->setRmax(8);
+            mpdfc->setBondCaching(true);
+            mpdfc->eval(stru);
+            // isotropic displacement changes use the bond table
+            for (int k = 0; k < 3; ++k)
+            {
+                // smaller displacements keep the calculation range
+                (*stru)[k].uij_cartn = R3::identity() * (0.003 - 0.001 * k);
+                (*stru)[k + 10].uij_cartn *= 0.8;
+                int cnt = stru->mcount;
+                QuantityType pdf1 = mpdfc->eval(stru);
+                TS_ASSERT_EQUALS(cnt, stru->mcount);
+                TS_ASSERT_EQUALS(OPTIMIZED, mpdfc->getEvaluatorTypeUsed());
+                QuantityType pdf0 = pdfc0.eval(stru);
+                TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+                for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+                }
+            }
+            // anisotropic sites need new bonds
+            (*stru)[5].uij_cartn(0, 0) = 0.003;
+            int cnt = stru->mcount;
+            QuantityType pdf1 = mpdfc->eval(stru);
+            TS_ASSERT_LESS_THAN(cnt, stru->mcount);
+            QuantityType pdf0 = pdfc0.eval(stru);
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+        }
+
+
+        void test_replayDeformedPairs()
+        {
+            boost::shared_ptr<CountingPeriodicAdapter>
+                stru(new CountingPeriodicAdapter);
+            StructureAdapterPtr catio3 =
+                loadTestPeriodicStructure("CaTiO3.stru");
+            PeriodicStructureAdapter& pstru = *stru;
+            pstru = dynamic_cast<PeriodicStructureAdapter&>(*catio3);
+            const Lattice L = stru->getLattice();
+            PDFCalculator pdfc0;
+            pdfc0.setRmax(8);
+            pdfc0.setEvaluatorType(BASIC);
+            mpdfc->setRmax(8);
+            mpdfc->setBondCaching(true);
+            mpdfc->eval(stru);
+            // uniform expansion rescales the cached bonds
+            setLatParFractional(*stru, 1.01 * L.a(), 1.01 * L.b(),
+                    1.01 * L.c(), L.alpha(), L.beta(), L.gamma());
+            int cnt = stru->mcount;
+            QuantityType pdf1 = mpdfc->eval(stru);
+            TS_ASSERT_EQUALS(cnt, stru->mcount);
+            QuantityType pdf0 = pdfc0.eval(stru);
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+            // other deformations change msd of the anisotropic sites
+            setLatParFractional(*stru, 1.01 * L.a(), 0.99 * L.b(),
+                    L.c(), L.alpha(), L.beta(), 90.5);
+            cnt = stru->mcount;
+            pdf1 = mpdfc->eval(stru);
+            TS_ASSERT_LESS_THAN(cnt, stru->mcount);
+            pdf0 = pdfc0.eval(stru);
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+            // but transform the cached bonds for isotropic sites
+            for (int i = 0; i < stru->countSites(); ++i)
+            {
+                (*stru)[i].anisotropy = false;
+                (*stru)[i].uij_cartn = R3::identity() * (0.004 + 0.001 * i);
+            }
+            mpdfc->eval(stru);
+            setLatParFractional(*stru, L.a(), 1.02 * L.b(),
+                    0.99 * L.c(), 89.7, L.beta(), 90.2);
+            cnt = stru->mcount;
+            pdf1 = mpdfc->eval(stru);
+            TS_ASSERT_EQUALS(cnt, stru->mcount);
+            pdf0 = pdfc0.eval(stru);
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+        }
+
+
+        void test_setOccupancyPartials()
+        {
+            TS_ASSERT(!mpdfc->getOccupancyPartials());
+            boost::shared_ptr<CountingStructureAdapter>
+                stru(new CountingStructureAdapter);
+            Atom ai;
+            ai.atomtype = "Ni";
+            ai.uij_cartn = R3::identity() * 0.004;
+            for (int i = 0; i < 27; ++i)
+            {
+                ai.xyz_cartn = 2.5 * R3::Vector(i % 3, i / 3 % 3, i / 9);
+                stru->append(ai);
+            }
+            (*stru)[0].atomtype = "Au";
+            PDFCalculator pdfc0;
+            pdfc0.setRmax(8);
+            pdfc0.setEvaluatorType(BASIC);
+            mpdfc->setRmax(8);
+            mpdfc->setOccupancyPartials(true);
+            TS_ASSERT(mpdfc->getOccupancyPartials());
+            mpdfc->eval(stru);
+            TS_ASSERT_LESS_THAN(0u,
+                    mpdfc->memoryUsage().component("partials"));
+            // occupancy changes recombine the partials
+            for (int k = 0; k < 3; ++k)
+            {
+                for (int i = k; i < 27; i += 2)
+                {
+                    (*stru)[i].occupancy = 0.5 + 0.2 * k;
+                }
+                int cnt = stru->mcount;
+                QuantityType pdf1 = mpdfc->eval(stru);
+                TS_ASSERT_EQUALS(cnt, stru->mcount);
+                TS_ASSERT_EQUALS(OPTIMIZED, mpdfc->getEvaluatorTypeUsed());
+                QuantityType pdf0 = pdfc0.eval(stru);
+                TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+                for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+                }
+                pdf0 = pdfc0.getPDF();
+                pdf1 = mpdfc->getPDF();
+                for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+                }
+            }
+            // without partials the bond table is used
+            mpdfc->setOccupancyPartials(false);
+            mpdfc->setBondCaching(true);
+            mpdfc->eval(stru);
+            TS_ASSERT_EQUALS(0u, mpdfc->memoryUsage().component("partials"));
+            (*stru)[3].occupancy = 0.1;
+            int cnt = stru->mcount;
+            QuantityType pdf1 = mpdfc->eval(stru);
+            TS_ASSERT_EQUALS(cnt, stru->mcount);
+            QuantityType pdf0 = pdfc0.eval(stru);
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+        }
+
+
+        void test_setOccupancyPartialsParallel()
+        {
+            PeriodicStructureAdapterPtr ni =
+                boost::dynamic_pointer_cast<PeriodicStructureAdapter>(
+                        loadTestPeriodicStructure("Ni.stru"));
+            for (Atom& a : *ni)  a.uij_cartn = R3::identity() * 0.004;
+            PDFCalculator pdfc0;
+            pdfc0.setRmax(8);
+            mpdfc->setRmax(8);
+            mpdfc->setOccupancyPartials(true);
+            mpdfc->eval(ni);
+            // merged value has no partials for the occupancy updates
+            const int ncpu = 2;
+            mpdfc->setStructure(ni);
+            for (int cpuindex = 0; cpuindex < ncpu; ++cpuindex)
+            {
+                PDFCalculator pslave;
+                pslave.setRmax(8);
+                pslave.setOccupancyPartials(true);
+                pslave.setupParallelRun(cpuindex, ncpu);
+                pslave.eval(ni);
+                mpdfc->mergeParallelData(pslave.getParallelData(), ncpu);
+            }
+            (*ni)[1].occupancy = 0.5;
+            pdfc0.eval(ni);
+            QuantityType pdf0 = pdfc0.getPDF();
+            mpdfc->eval(ni);
+            QuantityType pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+        }
+
+
+        void test_sweepPDF()
+        {
+            boost::shared_ptr<CountingStructureAdapter>
+                stru(new CountingStructureAdapter);
+            Atom ai;
+            ai.atomtype = "Ni";
+            ai.uij_cartn = R3::identity() * 0.004;
+            for (int i = 0; i < 27; ++i)
+            {
+                ai.xyz_cartn = 2.5 * R3::Vector(i % 3, i / 3 % 3, i / 9);
+                stru->append(ai);
+            }
+            mpdfc->setRmax(8);
+            mpdfc->setDoubleAttr("delta2", 1.5);
+            vector<PDFCalculator::AttributeSettings> settings(4);
+            settings[0]["delta2"] = 0.5;
+            settings[1]["delta2"] = 2.5;
+            settings[1]["qdamp"] = 0.05;
+            settings[2]["qmax"] = 20;
+            settings[2]["rmax"] = 6;
+            settings[3]["delta1"] = 0.3;
+            settings[3]["rmin"] = 2;
+            for (int ncpu = 1; ncpu < 4; ncpu += 2)
+            {
+                int cnt = stru->mcount;
+                vector<QuantityType> pdfs =
+                    mpdfc->sweepPDF(stru, settings, ncpu);
+                TS_ASSERT_EQUALS(cnt + 1, stru->mcount);
+                TS_ASSERT_EQUALS(settings.size(), pdfs.size());
+                for (size_t k = 0; k < settings.size(); ++k)
+                {
+                    PDFCalculator pdfc0;
+                    pdfc0.setRmax(8);
+                    pdfc0.setDoubleAttr("delta2", 1.5);
+                    PDFCalculator::AttributeSettings::const_iterator kv;
+                    for (kv = settings[k].begin();
+                            kv != settings[k].end(); ++kv)
+                    {
+                        pdfc0.setDoubleAttr(kv->first, kv->second);
+                    }
+                    pdfc0.eval(stru);
+                    QuantityType pdf0 = pdfc0.getPDF();
+                    TS_ASSERT_EQUALS(pdf0.size(), pdfs[k].size());
+                    for (size_t i = 0;
+                            i < pdf0.size() && i < pdfs[k].size(); ++i)
+                    {
+                        TS_ASSERT_DELTA(pdf0[i], pdfs[k][i], meps);
+                    }
+                }
+            }
+            // swept attributes are restored
+            TS_ASSERT_EQUALS(1.5, mpdfc->getDoubleAttr("delta2"));
+            TS_ASSERT_EQUALS(0.0, mpdfc->getDoubleAttr("qdamp"));
+            TS_ASSERT_EQUALS(8.0, mpdfc->getRmax());
+            TS_ASSERT(mpdfc->sweepPDF(stru, vector<
+                        PDFCalculator::AttributeSettings>()).empty());
+            settings[0]["invalid"] = 1;
+            TS_ASSERT_THROWS(mpdfc->sweepPDF(stru, settings),
+                    diffpy::attributes::DoubleAttributeError);
+            settings[0].erase("invalid");
+            settings[2]["rstep"] = 0.02;
+            TS_ASSERT_THROWS(mpdfc->sweepPDF(stru, settings),
+                    invalid_argument);
+            TS_ASSERT_EQUALS(0.01, mpdfc->getRstep());
+            TS_ASSERT_EQUALS(8.0, mpdfc->getRmax());
+            TS_ASSERT_THROWS(mpdfc->sweepPDF(stru, settings, 0),
+                    invalid_argument);
+        }
+
+
+        void test_evalPDFAtPoints()
+        {
+            StructureAdapterPtr stru =
+                loadTestPeriodicStructure("ZnS_wurtzite.stru");
+            mpdfc->setPeakWidthModelByType("constant");
+            mpdfc->setDoubleAttr("width", 0.1);
+            mpdfc->setRmax(12);
+            mpdfc->eval(stru);
+            QuantityType rgrid = mpdfc->getRgrid();
+            QuantityType pdf0 = mpdfc->getPDF();
+            // sparse subset of the r-grid
+            QuantityType rpts, gpts;
+            for (size_t i = 0; i < rgrid.size(); i += 7)
+            {
+                rpts.push_back(rgrid[i]);
+                gpts.push_back(pdf0[i]);
+            }
+            double gmax = 0.0;
+            for (double g : pdf0)  gmax = max(gmax, fabs(g));
+            // peak tails are cut at slightly different points of the grid
+            const double eps = 1e-5 * gmax;
+            QuantityType pdf1 = mpdfc->evalPDFAtPoints(stru, rpts);
+            TS_ASSERT_EQUALS(rpts.size(), pdf1.size());
+            for (size_t i = 0; i < gpts.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(gpts[i], pdf1[i], eps);
+            }
+            // points beyond the calculator r-range
+            QuantityType rfar = vector<double>{20.015, 23.76, 31.1};
+            PDFCalculator pdfc2;
+            pdfc2.setPeakWidthModelByType("constant");
+            pdfc2.setDoubleAttr("width", 0.1);
+            pdfc2.setRmin(20);
+            pdfc2.setRmax(32);
+            pdfc2.setRstep(0.005);
+            pdfc2.eval(stru);
+            QuantityType pdf2 = pdfc2.getPDF();
+            QuantityType pdf3 = mpdfc->evalPDFAtPoints(stru, rfar);
+            QuantityType rgrid2 = pdfc2.getRgrid();
+            for (size_t k = 0; k < rfar.size(); ++k)
+            {
+                const int i = int(round((rfar[k] - rgrid2[0]) / 0.005));
+                TS_ASSERT_DELTA(rfar[k], rgrid2[i], 1e-8);
+                TS_ASSERT_DELTA(pdf2[i], pdf3[k], eps);
+            }
+            TS_ASSERT(mpdfc->evalPDFAtPoints(stru, QuantityType()).empty());
+            // invalid configurations
+            QuantityType runsorted = vector<double>{2.0, 1.0};
+            TS_ASSERT_THROWS(mpdfc->evalPDFAtPoints(stru, runsorted),
+                    invalid_argument);
+            mpdfc->setQmax(25);
+            TS_ASSERT_THROWS(mpdfc->evalPDFAtPoints(stru, rpts),
+                    invalid_argument);
+        }
+
+
+        void test_getChiSquared()
+        {
+            PeriodicStructureAdapterPtr stru =
+                boost::dynamic_pointer_cast<PeriodicStructureAdapter>(
+                        loadTestPeriodicStructure("ZnS_wurtzite.stru"));
+            for (Atom& a : *stru)  a.uij_cartn = R3::identity() * 0.004;
+            TS_ASSERT_THROWS(mpdfc->getChiSquared(), logic_error);
+            mpdfc->setRmax(10);
+            mpdfc->setBaselineByType("linear");
+            mpdfc->addEnvelopeByType("sphericalshape");
+            mpdfc->setDoubleAttr("spdiameter", 30);
+            mpdfc->eval(stru);
+            QuantityType gobs = mpdfc->getPDF();
+            QuantityType wt(gobs.size());
+            for (size_t i = 0; i < wt.size(); ++i)  wt[i] = 1.0 + i % 3;
+            TS_ASSERT_THROWS(mpdfc->setObservedPDF(gobs, QuantityType(3)),
+                    invalid_argument);
+            QuantityType wneg = wt;
+            wneg[4] = -1;
+            TS_ASSERT_THROWS(mpdfc->setObservedPDF(gobs, wneg),
+                    invalid_argument);
+            mpdfc->setObservedPDF(gobs, wt);
+            TS_ASSERT_EQUALS(gobs, mpdfc->getObservedPDF());
+            TS_ASSERT_EQUALS(0.0, mpdfc->getChiSquared());
+            TS_ASSERT_EQUALS(0.0, mpdfc->getRw());
+            // optimized updates for moved atoms compare changed window
+            for (int k = 0; k < 3; ++k)
+            {
+                (*stru)[k].xyz_cartn[k] += 0.05;
+                mpdfc->eval(stru);
+                TS_ASSERT_EQUALS(OPTIMIZED, mpdfc->getEvaluatorTypeUsed());
+                if (k == 1)  continue;
+                QuantityType gcalc = mpdfc->getPDF();
+                QuantityType res = mpdfc->getResidual();
+                TS_ASSERT_EQUALS(gobs.size(), res.size());
+                double chisq = 0.0, wgobs2 = 0.0;
+                for (size_t i = 0; i < gobs.size() && i < res.size(); ++i)
+                {
+                    const double dg = gcalc[i] - gobs[i];
+                    TS_ASSERT_DELTA(sqrt(wt[i]) * dg, res[i], meps);
+                    chisq += wt[i] * dg * dg;
+                    wgobs2 += wt[i] * gobs[i] * gobs[i];
+                }
+                TS_ASSERT_LESS_THAN(0.0, chisq);
+                TS_ASSERT_DELTA(chisq, mpdfc->getChiSquared(), 1e-10 * chisq);
+                TS_ASSERT_DELTA(sqrt(chisq / wgobs2), mpdfc->getRw(), meps);
+            }
+            // configuration changes compare the complete PDF
+            mpdfc->setDoubleAttr("scale", 1.2);
+            mpdfc->setQmax(25);
+            mpdfc->eval(stru);
+            QuantityType gcalc = mpdfc->getPDF();
+            double chisq = 0.0;
+            for (size_t i = 0; i < gobs.size(); ++i)
+            {
+                chisq += wt[i] * pow(gcalc[i] - gobs[i], 2);
+            }
+            TS_ASSERT_DELTA(chisq, mpdfc->getChiSquared(), 1e-10 * chisq);
+            // unit weights when not specified
+            mpdfc->setObservedPDF(gobs);
+            double chisq1 = 0.0;
+            for (double r : mpdfc->getResidual())  chisq1 += r * r;
+            TS_ASSERT_DELTA(chisq1, mpdfc->getChiSquared(), 1e-10 * chisq1);
+            TS_ASSERT_DIFFERS(chisq, chisq1);
+            mpdfc->setRmax(8);
+            mpdfc->eval(stru);
+            TS_ASSERT_THROWS(mpdfc->getChiSquared(), invalid_argument);
+            mpdfc->setObservedPDF(QuantityType());
+            TS_ASSERT_THROWS(mpdfc->getRw(), logic_error);
+        }
+
+
+        void test_evalEnsemble()
+        {
+            StructureAdapterPtr ni = loadTestPeriodicStructure("Ni.stru");
+            const PeriodicStructureAdapter& ni0 =
+                dynamic_cast<const PeriodicStructureAdapter&>(*ni);
+            vector<StructureAdapterPtr> ensemble;
+            for (int k = 0; k < 5; ++k)
+            {
+                PeriodicStructureAdapterPtr stru(
+                        new PeriodicStructureAdapter(ni0));
+                const Lattice& L = stru->getLattice();
+                setLatParFractional(*stru, (1 + 0.01 * k) * L.a(), L.b(),
+                        L.c(), L.alpha(), L.beta(), L.gamma());
+                (*stru)[k % 4].xyz_cartn[0] += 0.05 * k;
+                (*stru)[k % 4].occupancy = 1 - 0.1 * k;
+                (*stru)[1].uij_cartn = R3::identity() * (0.003 + 0.002 * k);
+                ensemble.push_back(stru);
+            }
+            mpdfc->setRmax(8);
+            mpdfc->setQmax(25);
+            QuantityType pdfavg;
+            for (size_t k = 0; k < ensemble.size(); ++k)
+            {
+                mpdfc->eval(ensemble[k]);
+                QuantityType pdf = mpdfc->getPDF();
+                pdfavg.resize(pdf.size(), 0.0);
+                for (size_t i = 0; i < pdf.size(); ++i)
+                {
+                    pdfavg[i] += pdf[i] / ensemble.size();
+                }
+            }
+            for (int ncpu = 1; ncpu < 8; ncpu += 3)
+            {
+                mpdfc->evalEnsemble(ensemble, ncpu);
+                QuantityType pdf1 = mpdfc->getPDF();
+                TS_ASSERT_EQUALS(pdfavg.size(), pdf1.size());
+                for (size_t i = 0; i < pdfavg.size() && i < pdf1.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(pdfavg[i], pdf1[i], meps);
+                }
+            }
+            // single configuration gives the plain result
+            vector<StructureAdapterPtr> single(1, ensemble[2]);
+            QuantityType rdf1 = mpdfc->evalEnsemble(single);
+            QuantityType rdf0 = mpdfc->eval(ensemble[2]);
+            TS_ASSERT_EQUALS(rdf0, rdf1);
+            TS_ASSERT_THROWS(mpdfc->evalEnsemble(
+                        vector<StructureAdapterPtr>()), invalid_argument);
+            TS_ASSERT_THROWS(mpdfc->evalEnsemble(ensemble, 0),
+                    invalid_argument);
+            mpdfc->setPositionGradients(true);
+            TS_ASSERT_THROWS(mpdfc->evalEnsemble(ensemble),
+                    invalid_argument);
+        }
+
+
+        void test_evalEnsembleThreads()
+        {
+            // worker threads run concurrent bond loops of the same
+            // structure objects and must match the serial evaluation
+            StructureAdapterPtr cto =
+                loadTestPeriodicStructure("CaTiO3.stru");
+            const PeriodicStructureAdapter& cto0 =
+                dynamic_cast<const PeriodicStructureAdapter&>(*cto);
+            PeriodicStructureAdapterPtr cto1(
+                    new PeriodicStructureAdapter(cto0));
+            (*cto1)[3].xyz_cartn[2] += 0.1;
+            vector<StructureAdapterPtr> ensemble;
+            for (int k = 0; k < 12; ++k)
+            {
+                ensemble.push_back((k % 3) ? cto : cto1);
+            }
+            mpdfc->setRmax(12);
+            mpdfc->evalEnsemble(ensemble, 1);
+            QuantityType pdf0 = mpdfc->getPDF();
+            mpdfc->evalEnsemble(ensemble, 4);
+            QuantityType pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], meps);
+            }
+        }
+
+
+        void test_setFFTGridStep()
+        {
+            StructureAdapterPtr ni = loadTestPeriodicStructure("Ni.stru");
+            const PeriodicStructureAdapter& ni0 =
+                dynamic_cast<const PeriodicStructureAdapter&>(*ni);
+            const Lattice& L0 = ni0.getLattice();
+            // displaced 5x5x5 supercell of Ni
+            const int ncells = 5;
+            PeriodicStructureAdapterPtr stru(new PeriodicStructureAdapter);
+            stru->setLatPar(ncells * L0.a(), ncells * L0.b(),
+                    ncells * L0.c(), L0.alpha(), L0.beta(), L0.gamma());
+            for (int k = 0; k < ncells * ncells * ncells; ++k)
+            {
+                R3::Vector cell(k % ncells, k / ncells % ncells,
+                        k / ncells / ncells);
+                for (int i = 0; i < ni0.countSites(); ++i)
+                {
+                    Atom ai = ni0[i];
+                    const int m = k * ni0.countSites() + i;
+                    R3::Vector dxyz(sin(m), cos(2 * m), sin(3 * m));
+                    ai.xyz_cartn += L0.cartesian(cell) + 0.08 * dxyz;
+                    stru->append(ai);
+                }
+            }
+            mpdfc->setPeakWidthModelByType("constant");
+            mpdfc->setDoubleAttr("width", 0.5);
+            mpdfc->setRmax(4);
+            QuantityType pdf0 = mpdfc->eval(stru);
+            pdf0 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(0.0, mpdfc->getFFTGridStep());
+            mpdfc->setDoubleAttr("fftgridstep", 0.2);
+            mpdfc->setFFTSplitDistance(3);
+            mpdfc->eval(stru);
+            QuantityType pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            const double gmax = fabs(*max_element(pdf0.begin(), pdf0.end()));
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], 0.01 * gmax);
+            }
+            // the next evaluation is complete and gives the same result
+            mpdfc->eval(stru);
+            TS_ASSERT_EQUALS(pdf1, mpdfc->getPDF());
+            // unsupported configurations
+            mpdfc->setRmax(6);
+            TS_ASSERT_THROWS(mpdfc->eval(stru), invalid_argument);
+            mpdfc->setRmax(4);
+            mpdfc->setDoubleAttr("width", 0.15);
+            TS_ASSERT_THROWS(mpdfc->eval(stru), invalid_argument);
+            mpdfc->setPeakWidthModelByType("jeong");
+            TS_ASSERT_THROWS(mpdfc->eval(stru), invalid_argument);
+            TS_ASSERT_THROWS(mpdfc->eval(emptyStructureAdapter()),
+                    invalid_argument);
+            TS_ASSERT_THROWS(mpdfc->setFFTGridStep(-1), invalid_argument);
+        }
+
+
+        void test_setMixedPrecision()
+        {
+            StructureAdapterPtr stru =
+                loadTestPeriodicStructure("ZnS_wurtzite.stru");
+            mpdfc->setPeakWidthModelByType("constant");
+            mpdfc->setDoubleAttr("width", 0.1);
+            mpdfc->setRmax(30);
+            QuantityType pdf0 = mpdfc->eval(stru);
+            pdf0 = mpdfc->getPDF();
+            TS_ASSERT(!mpdfc->getMixedPrecision());
+            mpdfc->setMixedPrecision(true);
+            TS_ASSERT(mpdfc->getMixedPrecision());
+            mpdfc->eval(stru);
+            QuantityType pdf1 = mpdfc->getPDF();
+            TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+            TS_ASSERT_DIFFERS(pdf0, pdf1);
+            const double gmax = fabs(*max_element(pdf0.begin(), pdf0.end()));
+            for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+            {
+                TS_ASSERT_DELTA(pdf0[i], pdf1[i], 1e-5 * gmax);
+            }
+            // peaks of other profiles are added in double precision
+            mpdfc->setPeakProfileByType("croppedgaussian");
+            PDFCalculator pdfc2;
+            pdfc2.setRmax(30);
+            pdfc2.setPeakWidthModelByType("constant");
+            pdfc2.setDoubleAttr("width", 0.1);
+            pdfc2.setPeakProfileByType("croppedgaussian");
+            mpdfc->eval(stru);
+            pdfc2.eval(stru);
+            TS_ASSERT_EQUALS(pdfc2.getPDF(), mpdfc->getPDF());
+        }
+
+
+        void test_tabulatedPeakProfile()
+        {
+            StructureAdapterPtr stru =
+                loadTestPeriodicStructure("ZnS_wurtzite.stru");
+            mpdfc->setPeakWidthModelByType("constant");
+            mpdfc->setDoubleAttr("width", 0.1);
+            mpdfc->setRmax(20);
+            for (string tp : {"gaussian", "croppedgaussian"})
+            {
+                mpdfc->setPeakProfileByType(tp);
+                mpdfc->getPeakProfile()->setTabulated(false);
+                QuantityType pdf0 = mpdfc->eval(stru);
+                pdf0 = mpdfc->getPDF();
+                mpdfc->getPeakProfile()->setTabulated(true);
+                mpdfc->eval(stru);
+                QuantityType pdf1 = mpdfc->getPDF();
+                TS_ASSERT_EQUALS(pdf0.size(), pdf1.size());
+                TS_ASSERT_DIFFERS(pdf0, pdf1);
+                double gmax = 0.0;
+                for (double g : pdf0)  gmax = max(gmax, fabs(g));
+                for (size_t i = 0; i < pdf0.size() && i < pdf1.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(pdf0[i], pdf1[i], 1e-5 * gmax);
+                }
+            }
+        }
+
+
+        void test_getPDFPositionJacobian()
+        {
+            AtomicStructureAdapterPtr stru(new AtomicStructureAdapter);
+            Atom ai;
+            ai.atomtype = "C";
+            ai.uij_cartn = R3::identity() * 0.005;
+            const double xyz[4][3] = {
+                {0, 0, 0}, {1.5, 0.1, 0}, {0.2, 1.4, 0.3}, {1.1, 1.2, 1.6}};
+            for (int i = 0; i < 4; ++i)
+            {
+                ai.xyz_cartn = R3::Vector(xyz[i][0], xyz[i][1], xyz[i][2]);
+                stru->append(ai);
+            }
+            (*stru)[2].atomtype = "O";
+            (*stru)[3].anisotropy = true;
+            (*stru)[3].uij_cartn(0, 0) = 0.012;
+            (*stru)[3].uij_cartn(0, 1) = (*stru)[3].uij_cartn(1, 0) = 0.002;
+            PDFCalculator& pdfc = *mpdfc;
+            pdfc.setRmax(5);
+            pdfc.setQmax(25);
+            pdfc.setDoubleAttr("delta1", 0.4);
+            pdfc.setDoubleAttr("qbroad", 0.05);
+            TS_ASSERT_THROWS(pdfc.getPDFPositionJacobian(), logic_error);
+            pdfc.setPositionGradients(true);
+            pdfc.eval(stru);
+            vector<QuantityType> jac = pdfc.getPDFPositionJacobian();
+            TS_ASSERT_EQUALS(12u, jac.size());
+            // compare with central differences
+            const double h = 1e-5;
+            PDFCalculator pdfc1;
+            pdfc1.setRmax(5);
+            pdfc1.setQmax(25);
+            pdfc1.setDoubleAttr("delta1", 0.4);
+            pdfc1.setDoubleAttr("qbroad", 0.05);
+            for (int row = 0; row < 12; ++row)
+            {
+                AtomicStructureAdapterPtr stru1(new AtomicStructureAdapter(*stru));
+                (*stru1)[row / 3].xyz_cartn[row % 3] += h;
+                pdfc1.eval(stru1);
+                QuantityType pdfhi = pdfc1.getPDF();
+                (*stru1)[row / 3].xyz_cartn[row % 3] -= 2 * h;
+                pdfc1.eval(stru1);
+                QuantityType pdflo = pdfc1.getPDF();
+                TS_ASSERT_EQUALS(pdfhi.size(), jac[row].size());
+                double dmax = 0.0;
+                double gmax = 0.0;
+                for (size_t i = 0; i < pdfhi.size(); ++i)
+                {
+                    double gnum = (pdfhi[i] - pdflo[i]) / (2 * h);
+                    dmax = max(dmax, fabs(gnum - jac[row][i]));
+                    gmax = max(gmax, fabs(gnum));
+                }
+                TS_ASSERT_LESS_THAN(0.0, gmax);
+                TS_ASSERT_LESS_THAN(dmax, 1e-5 * gmax);
+            }
+            // fast updates keep the derivatives consistent
+            (*stru)[1].xyz_cartn[2] += 0.1;
+            pdfc.eval(stru);
+            jac = pdfc.getPDFPositionJacobian();
+            PDFCalculator pdfc2;
+            pdfc2.setRmax(5);
+            pdfc2.setQmax(25);
+            pdfc2.setDoubleAttr("delta1", 0.4);
+            pdfc2.setDoubleAttr("qbroad", 0.05);
+            pdfc2.setEvaluatorType(BASIC);
+            pdfc2.setPositionGradients(true);
+            pdfc2.eval(stru);
+            vector<QuantityType> jac2 = pdfc2.getPDFPositionJacobian();
+            TS_ASSERT_EQUALS(jac2.size(), jac.size());
+            for (size_t row = 0; row < jac.size(); ++row)
+            {
+                for (size_t i = 0; i < jac[row].size(); ++i)
+                {
+                    TS_ASSERT_DELTA(jac2[row][i], jac[row][i], meps);
+                }
+            }
+        }
+
+
+        void test_getPDFDerivative()
+        {
+            AtomicStructureAdapterPtr stru(new AtomicStructureAdapter);
+            Atom ai;
+            ai.atomtype = "C";
+            ai.uij_cartn = R3::identity() * 0.005;
+            const double xyz[4][3] = {
+                {0, 0, 0}, {1.5, 0.1, 0}, {0.2, 1.4, 0.3}, {1.1, 1.2, 1.6}};
+            for (int i = 0; i < 4; ++i)
+            {
+                ai.xyz_cartn = R3::Vector(xyz[i][0], xyz[i][1], xyz[i][2]);
+                stru->append(ai);
+            }
+            (*stru)[2].atomtype = "O";
+            (*stru)[2].anisotropy = true;
+            (*stru)[2].uij_cartn(0, 0) = 0.012;
+            (*stru)[2].uij_cartn(0, 1) = (*stru)[2].uij_cartn(1, 0) = 0.002;
+            PDFCalculator& pdfc = *mpdfc;
+            pdfc.setRmax(5);
+            pdfc.setQmax(25);
+            pdfc.setDoubleAttr("delta1", 0.4);
+            pdfc.setDoubleAttr("delta2", 0.3);
+            pdfc.setDoubleAttr("qbroad", 0.05);
+            const char* pnames[] = {
+                "delta1", "delta2", "qbroad", "Uiso:C", "U12:O", "U33:O"};
+            vector<string> names(pnames, pnames + 6);
+            TS_ASSERT_THROWS(pdfc.setParameterGradients(
+                        vector<string>(1, "U14:C")), invalid_argument);
+            pdfc.setParameterGradients(names);
+            TS_ASSERT_EQUALS(names, pdfc.getParameterGradients());
+            TS_ASSERT_THROWS(pdfc.getPDFDerivative("delta1"), logic_error);
+            TS_ASSERT_THROWS(pdfc.getPDFDerivative("scale"), invalid_argument);
+            pdfc.eval(stru);
+            // compare with central differences
+            const double h = 1e-6;
+            PDFCalculator pdfc1;
+            pdfc1.setRmax(5);
+            pdfc1.setQmax(25);
+            for (size_t ip = 0; ip < names.size(); ++ip)
+            {
+                const string& nm = names[ip];
+                QuantityType pdfhi, pdflo;
+                for (int sgn = +1; sgn >= -1; sgn -= 2)
+                {
+                    AtomicStructureAdapterPtr stru1(
+                            new AtomicStructureAdapter(*stru));
+                    pdfc1.setDoubleAttr("delta1", 0.4);
+                    pdfc1.setDoubleAttr("delta2", 0.3);
+                    pdfc1.setDoubleAttr("qbroad", 0.05);
+                    if (nm == "Uiso:C")
+                    {
+                        for (int i = 0; i < stru1->countSites(); ++i)
+                        {
+                            if ((*stru1)[i].atomtype != "C")  continue;
+                            (*stru1)[i].uij_cartn += sgn * h * R3::identity();
+                        }
+                    }
+                    else if (nm == "U12:O")
+                    {
+                        (*stru1)[2].uij_cartn(0, 1) += sgn * h;
+                        (*stru1)[2].uij_cartn(1, 0) += sgn * h;
+                    }
+                    else if (nm == "U33:O")
+                    {
+                        (*stru1)[2].uij_cartn(2, 2) += sgn * h;
+                    }
+                    else
+                    {
+                        double v = pdfc1.getDoubleAttr(nm);
+                        pdfc1.setDoubleAttr(nm, v + sgn * h);
+                    }
+                    pdfc1.eval(stru1);
+                    (sgn > 0 ? pdfhi : pdflo) = pdfc1.getPDF();
+                }
+                QuantityType dpdf = pdfc.getPDFDerivative(nm);
+                TS_ASSERT_EQUALS(pdfhi.size(), dpdf.size());
+                double dmax = 0.0;
+                double gmax = 0.0;
+                for (size_t i = 0; i < pdfhi.size(); ++i)
+                {
+                    double gnum = (pdfhi[i] - pdflo[i]) / (2 * h);
+                    dmax = max(dmax, fabs(gnum - dpdf[i]));
+                    gmax = max(gmax, fabs(gnum));
+                }
+                TS_ASSERT_LESS_THAN(0.0, gmax);
+                TS_ASSERT_LESS_THAN(dmax, 1e-5 * gmax);
+            }
+            // fast updates keep the derivatives consistent
+            (*stru)[1].xyz_cartn[2] += 0.1;
+            pdfc.eval(stru);
+            TS_ASSERT_EQUALS(OPTIMIZED, pdfc.getEvaluatorTypeUsed());
+            PDFCalculator pdfc2;
+            pdfc2.setRmax(5);
+            pdfc2.setQmax(25);
+            pdfc2.setDoubleAttr("delta1", 0.4);
+            pdfc2.setDoubleAttr("delta2", 0.3);
+            pdfc2.setDoubleAttr("qbroad", 0.05);
+            pdfc2.setEvaluatorType(BASIC);
+            pdfc2.setParameterGradients(names);
+            pdfc2.eval(stru);
+            for (size_t ip = 0; ip < names.size(); ++ip)
+            {
+                QuantityType d0 = pdfc.getPDFDerivative(names[ip]);
+                QuantityType d2 = pdfc2.getPDFDerivative(names[ip]);
+                TS_ASSERT_EQUALS(d2.size(), d0.size());
+                for (size_t i = 0; i < d0.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(d2[i], d0[i], meps);
+                }
+            }
+            // bond table replay applies to the width derivatives
+            vector<string> wnames(pnames, pnames + 4);
+            pdfc.setParameterGradients(wnames);
+            pdfc2.setParameterGradients(wnames);
+            pdfc.setBondCaching(true);
+            pdfc.eval(stru);
+            pdfc.setDoubleAttr("delta2", 0.35);
+            pdfc2.setDoubleAttr("delta2", 0.35);
+            pdfc.eval(stru);
+            pdfc2.eval(stru);
+            for (size_t ip = 0; ip < wnames.size(); ++ip)
+            {
+                QuantityType d0 = pdfc.getPDFDerivative(wnames[ip]);
+                QuantityType d2 = pdfc2.getPDFDerivative(wnames[ip]);
+                TS_ASSERT_EQUALS(d2.size(), d0.size());
+                for (size_t i = 0; i < d0.size(); ++i)
+                {
+                    TS_ASSERT_DELTA(d2[i], d0[i], meps);
+                }
+            }
+            // isotropic sites have no derivatives for Uij
+            pdfc.setParameterGradients(vector<string>(1, "U11:C"));
+            TS_ASSERT_THROWS(pdfc.eval(stru), invalid_argument);
+        }
+
+
         void test_serialization()
         {
             // build customized PDFCalculator
@@ -260,6 +1268,9 @@ class TestPDFCalculator : public CxxTest::TestSuite
             mpdfc->setDoubleAttr("peakprecision", 0.011);
             mpdfc->setScatteringFactorTableByType("electronnumber");
             mpdfc->getScatteringFactorTable()->setCustomAs("H", "H", 1.1);
+            mpdfc->setFFTGridStep(0.25);
+            mpdfc->setPositionGradients(true);
+            mpdfc->setParameterGradients(vector<string>(1, "width"));
             // dump it to string
             stringstream storage(ios::in | ios::out | ios::binary);
             diffpy::serialization::oarchive oa(storage, ios::binary);
@@ -276,6 +1287,10 @@ class TestPDFCalculator : public CxxTest::TestSuite
                     pdfc1->getScatteringFactorTable()->type());
             TS_ASSERT_EQUALS(1.1,
                     pdfc1->getScatteringFactorTable()->lookup("H"));
+            TS_ASSERT_EQUALS(0.25, pdfc1->getFFTGridStep());
+            TS_ASSERT(pdfc1->getPositionGradients());
+            TS_ASSERT_EQUALS(vector<string>(1, "width"),
+                    pdfc1->getParameterGradients());
         }
 
 };  // class TestPDFCalculator
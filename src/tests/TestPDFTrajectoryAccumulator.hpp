@@ -0,0 +1,128 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestPDFTrajectoryAccumulator -- unit tests for the averages
+*     of PDF and F(Q) over trajectory frames
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/PDFTrajectoryAccumulator.hpp>
+#include <diffpy/srreal/PeriodicStructureAdapter.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+using diffpy::mathutils::EpsilonEqual;
+
+namespace {
+
+/// average of the arrays in the range
+QuantityType average(vector<QuantityType>::const_iterator first,
+        vector<QuantityType>::const_iterator last)
+{
+    QuantityType rv(first->size(), 0.0);
+    const int n = last - first;
+    for (; first != last; ++first)
+    {
+        for (size_t i = 0; i < rv.size(); ++i)  rv[i] += (*first)[i] / n;
+    }
+    return rv;
+}
+
+}   // namespace
+
+class TestPDFTrajectoryAccumulator : public CxxTest::TestSuite
+{
+    private:
+
+        EpsilonEqual allclose;
+        PeriodicStructureAdapterPtr mstru;
+        boost::shared_ptr<PDFTrajectoryAccumulator> mtraj;
+
+    public:
+
+        void setUp()
+        {
+            mstru = boost::dynamic_pointer_cast<PeriodicStructureAdapter>(
+                    loadTestPeriodicStructure("ZnS_wurtzite.stru"));
+            for (Atom& a : *mstru)  a.uij_cartn = R3::identity() * 0.004;
+            mtraj.reset(new PDFTrajectoryAccumulator);
+            mtraj->getCalculator().setRmax(10);
+            mtraj->getCalculator().setQmax(25);
+        }
+
+
+        void test_addFrame()
+        {
+            mtraj->setSkin(0.5);
+            mtraj->setWindowSize(3);
+            TS_ASSERT(mtraj->getPDF().empty());
+            TS_ASSERT(mtraj->getWindowPDF().empty());
+            PDFCalculator pdfc = mtraj->getCalculator();
+            vector<QuantityType> pdfs, fs;
+            const int nframes = 7;
+            for (int k = 0; k < nframes; ++k)
+            {
+                // move atoms in place like a trajectory reader
+                for (int i = 0; i < mstru->countSites(); ++i)
+                {
+                    R3::Vector dxyz(sin(k + i), cos(2 * k + i), sin(k - i));
+                    (*mstru)[i].xyz_cartn += 0.02 * dxyz;
+                }
+                mtraj->addFrame(mstru);
+                pdfc.eval(mstru->clone());
+                pdfs.push_back(pdfc.getPDF());
+                fs.push_back(pdfc.getF());
+                TS_ASSERT_EQUALS(k + 1, mtraj->countFrames());
+                TS_ASSERT(allclose(average(pdfs.begin(), pdfs.end()),
+                            mtraj->getPDF()));
+                TS_ASSERT(allclose(average(fs.begin(), fs.end()),
+                            mtraj->getF()));
+                const int nwin = min(k + 1, 3);
+                TS_ASSERT(allclose(average(pdfs.end() - nwin, pdfs.end()),
+                            mtraj->getWindowPDF()));
+                TS_ASSERT(allclose(average(fs.end() - nwin, fs.end()),
+                            mtraj->getWindowF()));
+            }
+            TS_ASSERT_EQUALS(1, mtraj->countNeighborListBuilds());
+            TS_ASSERT_EQUALS(pdfc.getRgrid().size(), mtraj->getPDF().size());
+            TS_ASSERT_EQUALS(pdfc.getQgrid().size(), mtraj->getF().size());
+        }
+
+
+        void test_reset()
+        {
+            mtraj->setWindowSize(2);
+            mtraj->addFrame(mstru);
+            mtraj->addFrame(mstru);
+            TS_ASSERT_EQUALS(2, mtraj->countFrames());
+            mtraj->reset();
+            TS_ASSERT_EQUALS(0, mtraj->countFrames());
+            TS_ASSERT(mtraj->getPDF().empty());
+            TS_ASSERT(mtraj->getWindowF().empty());
+            mtraj->addFrame(mstru);
+            TS_ASSERT(allclose(mtraj->getPDF(), mtraj->getWindowPDF()));
+            TS_ASSERT_THROWS(mtraj->setWindowSize(-1), invalid_argument);
+            // the averages need the same r-grid for all frames
+            mtraj->getCalculator().setRmax(8);
+            TS_ASSERT_THROWS(mtraj->addFrame(mstru), invalid_argument);
+            TS_ASSERT_EQUALS(1, mtraj->countFrames());
+        }
+
+};  // class TestPDFTrajectoryAccumulator
+
+// End of file
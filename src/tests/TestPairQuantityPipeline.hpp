@@ -0,0 +1,211 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestPairQuantityPipeline -- unit tests for asynchronous evaluation
+*     in the PairQuantityPipeline class
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include <diffpy/srreal/PairQuantityPipeline.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/PairCounter.hpp>
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+using diffpy::mathutils::EpsilonEqual;
+
+class TestPairQuantityPipeline : public CxxTest::TestSuite
+{
+    private:
+
+        typedef PairQuantityPipeline::Handle Handle;
+
+        EpsilonEqual allclose;
+        vector<StructureAdapterPtr> mstructures;
+        PairCounter mcounter;
+
+    public:
+
+        void setUp()
+        {
+            if (mstructures.empty())
+            {
+                mstructures.push_back(loadTestPeriodicStructure("Ni.stru"));
+                mstructures.push_back(
+                        loadTestPeriodicStructure("NaCl.stru"));
+                mstructures.push_back(
+                        loadTestPeriodicStructure("ZnS_wurtzite.stru"));
+                mstructures.push_back(
+                        loadTestPeriodicStructure("CaTiO3.stru"));
+            }
+            mcounter.setRmax(5);
+        }
+
+
+        void test_create()
+        {
+            TS_ASSERT_THROWS(PairQuantityPipeline(0, 1), invalid_argument);
+            TS_ASSERT_THROWS(PairQuantityPipeline(1, 0), invalid_argument);
+            PairQuantityPipeline pipeline(3, 2);
+            TS_ASSERT_EQUALS(3, pipeline.countThreads());
+            TS_ASSERT_EQUALS(0, pipeline.countQueued());
+            pipeline.waitAll();
+            Handle h;
+            TS_ASSERT(!h.ready());
+            TS_ASSERT(!h.cancel());
+        }
+
+
+        void test_submit()
+        {
+            const int nst = mstructures.size();
+            // blocking evaluation of the reference values
+            PDFCalculator pdfc;
+            pdfc.setRmax(8);
+            vector<QuantityType> gexpected, cntexpected;
+            for (auto&& stru : mstructures)
+            {
+                pdfc.eval(stru);
+                gexpected.push_back(pdfc.getPDF());
+                cntexpected.push_back(mcounter.eval(stru));
+            }
+            // the same evaluations on two calculators in a pipeline
+            PDFCalculator pdfc1;
+            pdfc1.setRmax(8);
+            PairCounter pcount1;
+            pcount1.setRmax(5);
+            auto getpdf = [](PairQuantity& pq) {
+                return static_cast<PDFCalculator&>(pq).getPDF();
+            };
+            PairQuantityPipeline pipeline(3, 4);
+            vector<Handle> ghandles, cnthandles;
+            for (int k = 0; k < nst; ++k)
+            {
+                StructureAdapterPtr stru = mstructures[k];
+                ghandles.push_back(pipeline.submit(pdfc1,
+                            [stru]() { return stru; }, getpdf));
+                cnthandles.push_back(pipeline.submit(pcount1, stru));
+            }
+            pipeline.waitAll();
+            TS_ASSERT_EQUALS(0, pipeline.countQueued());
+            for (int k = 0; k < nst; ++k)
+            {
+                TS_ASSERT(ghandles[k].ready());
+                TS_ASSERT(allclose(gexpected[k], ghandles[k].get()));
+                TS_ASSERT(allclose(cntexpected[k], cnthandles[k].get()));
+            }
+            // per-calculator order keeps fast updates of the last task
+            TS_ASSERT(allclose(gexpected.back(), pdfc1.getPDF()));
+            TS_ASSERT_EQUALS(mstructures.back(), pdfc1.getStructure());
+        }
+
+
+        void test_cancel()
+        {
+            promise<void> release;
+            shared_future<void> released = release.get_future().share();
+            PairCounter pcount;
+            pcount.setRmax(5);
+            PairQuantityPipeline pipeline(2, 8);
+            StructureAdapterPtr stru = mstructures[0];
+            auto slowloader = [stru, released]() {
+                released.wait();
+                return stru;
+            };
+            Handle h0 = pipeline.submit(pcount, slowloader);
+            Handle h1 = pipeline.submit(pcount, stru);
+            Handle h2 = pipeline.submit(pcount, stru);
+            Handle h3 = pipeline.submit(pcount, stru);
+            // tasks wait behind the loader of the same calculator
+            this_thread::sleep_for(chrono::milliseconds(20));
+            TS_ASSERT_EQUALS(4, pipeline.countQueued());
+            TS_ASSERT(h2.cancel());
+            TS_ASSERT(!h2.cancel());
+            TS_ASSERT(h2.ready());
+            TS_ASSERT_THROWS(h2.get(), runtime_error);
+            TS_ASSERT_EQUALS(3, pipeline.countQueued());
+            release.set_value();
+            pipeline.waitAll();
+            TS_ASSERT(!h0.cancel());
+            QuantityType cnt = mcounter.eval(stru);
+            TS_ASSERT(allclose(cnt, h0.get()));
+            TS_ASSERT(allclose(cnt, h1.get()));
+            TS_ASSERT(allclose(cnt, h3.get()));
+        }
+
+
+        void test_bounded_queue()
+        {
+            promise<void> release;
+            shared_future<void> released = release.get_future().share();
+            PairCounter pcount;
+            pcount.setRmax(5);
+            PairQuantityPipeline pipeline(1, 2);
+            StructureAdapterPtr stru = mstructures[1];
+            auto slowloader = [stru, released]() {
+                released.wait();
+                return stru;
+            };
+            Handle h0 = pipeline.submit(pcount, slowloader);
+            Handle h1 = pipeline.submit(pcount, stru);
+            // the third submission blocks until the queue has space
+            atomic<bool> submitted(false);
+            Handle h2;
+            thread submitter([&]() {
+                h2 = pipeline.submit(pcount, stru);
+                submitted = true;
+            });
+            this_thread::sleep_for(chrono::milliseconds(20));
+            TS_ASSERT(!submitted);
+            TS_ASSERT_EQUALS(2, pipeline.countQueued());
+            release.set_value();
+            submitter.join();
+            TS_ASSERT(submitted);
+            pipeline.waitAll();
+            QuantityType cnt = mcounter.eval(stru);
+            TS_ASSERT(allclose(cnt, h0.get()));
+            TS_ASSERT(allclose(cnt, h2.get()));
+        }
+
+
+        void test_errors()
+        {
+            PairCounter pcount;
+            pcount.setRmax(5);
+            PairQuantityPipeline pipeline(2, 4);
+            auto badloader = []() -> StructureAdapterPtr {
+                throw invalid_argument("cannot load");
+            };
+            Handle h0 = pipeline.submit(pcount, badloader);
+            Handle h1 = pipeline.submit(pcount, mstructures[0]);
+            TS_ASSERT_THROWS(h0.get(), invalid_argument);
+            TS_ASSERT(allclose(mcounter.eval(mstructures[0]), h1.get()));
+            PairQuantityPipeline::StructureLoader noloader;
+            TS_ASSERT_THROWS(pipeline.submit(pcount, noloader),
+                    invalid_argument);
+        }
+
+};  // class TestPairQuantityPipeline
+
+// End of file
@@ -18,6 +18,8 @@
 
 #include <cmath>
 #include <stdexcept>
+#include <thread>
+#include <vector>
 #include <cxxtest/TestSuite.h>
 
 #include <diffpy/mathutils.hpp>
@@ -146,6 +148,77 @@ class TestPeakProfile : public CxxTest::TestSuite
         }
 
 
+        void test_setTabulated()
+        {
+            TS_ASSERT(!mpkgauss->getTabulated());
+            mpkgauss->setTabulated(true);
+            TS_ASSERT(mpkgauss->getTabulated());
+            for (const PeakProfilePtr& pkf : {mpkgauss, mpkgcrop})
+            {
+                pkf->setPrecision(1e-6);
+                PeakProfileTablePtr ptbl = pkf->table();
+                TS_ASSERT(ptbl.get());
+                if (!ptbl)  continue;
+                const PeakProfileTable& tbl = *ptbl;
+                const double fwhm = 0.37;
+                const double ymax = (*pkf)(0, fwhm);
+                const double xlo = pkf->xboundlo(fwhm);
+                const double xhi = pkf->xboundhi(fwhm);
+                for (double x = 1.1 * xlo; x < 1.1 * xhi; x += 0.00123)
+                {
+                    double y = (x < xlo || x > xhi) ? 0.0 : (*pkf)(x, fwhm);
+                    TS_ASSERT_DELTA(y, tbl(x, fwhm), 1e-6 * ymax);
+                }
+                TS_ASSERT_EQUALS(0.0, tbl(0, 0));
+            }
+            // table is rebuilt for a new precision
+            const int sz = mpkgauss->table()->size();
+            mpkgauss->setPrecision(1e-3);
+            TS_ASSERT_LESS_THAN(mpkgauss->table()->size(), sz);
+            TS_ASSERT_LESS_THAN_EQUALS(mpkgauss->table()->size(),
+                    PeakProfileTable::MAX_SIZE);
+            TS_ASSERT_EQUALS(mpkgauss->table(), mpkgauss->table());
+            PeakProfilePtr pk1 = dumpandload(mpkgauss);
+            TS_ASSERT(pk1->getTabulated());
+        }
+
+
+        void test_tableImprecise()
+        {
+            // no table within MAX_SIZE points or for unbounded profile
+            mpkgauss->setTabulated(true);
+            mpkgauss->setPrecision(1e-15);
+            TS_ASSERT(!mpkgauss->table());
+            mpkgauss->setPrecision(0.0);
+            TS_ASSERT(!mpkgauss->table());
+            mpkgauss->setPrecision(1e-6);
+            TS_ASSERT(mpkgauss->table());
+            PeakProfileTable tbl;
+            mpkgauss->setPrecision(1e-15);
+            TS_ASSERT(!tbl.build(*mpkgauss));
+            TS_ASSERT(!tbl.isPrecise());
+        }
+
+
+        void test_tableThreads()
+        {
+            // concurrent first use of a shared profile
+            mpkgauss->setTabulated(true);
+            mpkgauss->setPrecision(1e-7);
+            vector<PeakProfileTablePtr> tables(4);
+            vector<thread> threads;
+            for (size_t i = 0; i < tables.size(); ++i)
+            {
+                threads.push_back(thread([&, i]() {
+                    tables[i] = mpkgauss->table();
+                }));
+            }
+            for (auto&& t : threads)  t.join();
+            TS_ASSERT(tables[0]);
+            for (auto&& t : tables)  TS_ASSERT_EQUALS(tables[0], t);
+        }
+
+
         void test_serialization()
         {
             mpkgauss->setPrecision(0.0123);
@@ -0,0 +1,161 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestPerfCalculators -- performance tests of the standard calculators
+*
+* These tests are excluded from the default test run and have to be
+* requested with "scons test tests=perf".  They use the baseline SIMD
+* kernels unless a variant is selected with DIFFPYSIMDISA.
+*
+*****************************************************************************/
+
+#include <cstdlib>
+#include <sstream>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/DebyePDFCalculator.hpp>
+#include <diffpy/srreal/BondCalculator.hpp>
+#include <diffpy/srreal/AtomicStructureAdapter.hpp>
+#include <diffpy/srreal/SIMDKernels.hpp>
+#include "test_helpers.hpp"
+#include "perf_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+
+
+class TestPerfCalculators : public CxxTest::TestSuite
+{
+    private:
+
+        StructureAdapterPtr mni;
+        StructureAdapterPtr mcatio3;
+        string misa;
+
+        // spherical cluster of fcc nickel
+        AtomicStructureAdapterPtr niCluster(double radius)
+        {
+            const double a = 3.52;
+            const double basis[4][3] = {
+                {0.0, 0.0, 0.0}, {0.5, 0.5, 0.0},
+                {0.5, 0.0, 0.5}, {0.0, 0.5, 0.5}};
+            AtomicStructureAdapterPtr rv(new AtomicStructureAdapter);
+            Atom ai;
+            ai.atomtype = "Ni";
+            ai.uij_cartn = R3::identity() * 0.005;
+            const int n = int(radius / a) + 1;
+            for (int i = -n; i <= n; ++i)
+            for (int j = -n; j <= n; ++j)
+            for (int k = -n; k <= n; ++k)
+            for (int b = 0; b < 4; ++b)
+            {
+                ai.xyz_cartn = a * R3::Vector(i + basis[b][0],
+                        j + basis[b][1], k + basis[b][2]);
+                if (R3::norm(ai.xyz_cartn) <= radius)  rv->append(ai);
+            }
+            return rv;
+        }
+
+
+        void checkBudget(const string& name, double tnorm)
+        {
+            const double budget = perf_budget(name);
+            ostringstream msg;
+            msg << name << ": normalized time " << tnorm <<
+                ", baseline " << perf_baseline(name) <<
+                ", budget " << budget;
+            TS_TRACE(msg.str());
+#ifdef NDEBUG
+            TS_ASSERT_LESS_THAN(tnorm, budget);
+#else
+            TS_WARN("Performance budgets are checked only for build=fast.");
+#endif
+        }
+
+    public:
+
+        void setUp()
+        {
+            if (!mni)  mni = loadTestPeriodicStructure("Ni.stru");
+            if (!mcatio3)  mcatio3 = loadTestPeriodicStructure("CaTiO3.stru");
+            // use the same SIMD kernels on every machine, because
+            // the calibration loop does not depend on CPU features.
+            // Keep variant requested by DIFFPYSIMDISA, e.g., for PGO.
+            misa = simdkernels::activeISA();
+            if (!getenv("DIFFPYSIMDISA"))
+            {
+                simdkernels::setISA(simdkernels::availableISAs().front());
+            }
+        }
+
+
+        void tearDown()
+        {
+            simdkernels::setISA(misa);
+        }
+
+
+        void test_PDFCalculator_basic()
+        {
+            PDFCalculator pdfc;
+            pdfc.setEvaluatorType(BASIC);
+            pdfc.setRmax(30);
+            double t = perf_normalizedTime([&]() { pdfc.eval(mcatio3); });
+            checkBudget("pdfcalculator_basic", t);
+        }
+
+
+        void test_PDFCalculator_optimized()
+        {
+            AtomicStructureAdapterPtr stru = niCluster(12);
+            PDFCalculator pdfc;
+            pdfc.setRmax(25);
+            pdfc.eval(stru);
+            int index = 0;
+            auto shiftatom = [&]() {
+                (*stru)[index].xyz_cartn[0] += 0.001;
+                index = (index + 1) % stru->countSites();
+                pdfc.eval(stru);
+            };
+            double t = perf_normalizedTime(shiftatom, 20);
+            // catch silent fallback to the full summation
+            TS_ASSERT_EQUALS(OPTIMIZED, pdfc.getEvaluatorTypeUsed());
+            checkBudget("pdfcalculator_optimized", t);
+        }
+
+
+        void test_DebyePDFCalculator()
+        {
+            AtomicStructureAdapterPtr stru = niCluster(10);
+            DebyePDFCalculator dbpdfc;
+            dbpdfc.setEvaluatorType(BASIC);
+            dbpdfc.setQmax(25);
+            double t = perf_normalizedTime([&]() { dbpdfc.eval(stru); }, 3);
+            checkBudget("debyepdfcalculator_basic", t);
+        }
+
+
+        void test_BondCalculator()
+        {
+            BondCalculator bnds;
+            bnds.setEvaluatorType(BASIC);
+            bnds.setRmax(15);
+            double t = perf_normalizedTime([&]() { bnds.eval(mcatio3); });
+            checkBudget("bondcalculator_basic", t);
+        }
+
+};  // class TestPerfCalculators
+
+// End of file
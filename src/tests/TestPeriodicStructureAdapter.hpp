@@ -25,6 +25,7 @@
 
 #include <diffpy/srreal/PeriodicStructureAdapter.hpp>
 #include <diffpy/srreal/PointsInSphere.hpp>
+#include <diffpy/srreal/StructureDifference.hpp>
 #include "test_helpers.hpp"
 #include "serialization_helpers.hpp"
 
@@ -252,6 +253,51 @@ class TestPeriodicStructureAdapter : public CxxTest::TestSuite
             TS_ASSERT_DIFFERS(kbise0, kbise2);
         }
 
+
+        void test_diff()
+        {
+            typedef StructureDifference::Method DM;
+            PeriodicStructureAdapterPtr kbise0(new PeriodicStructureAdapter(
+                    static_cast<const PeriodicStructureAdapter&>(*m_kbise)));
+            PeriodicStructureAdapterPtr kbise1(
+                    new PeriodicStructureAdapter(*kbise0));
+            StructureDifference sd = kbise0->diff(kbise1);
+            TS_ASSERT_EQUALS(DM::SIDEBYSIDE, sd.diffmethod);
+            TS_ASSERT_EQUALS(R3::identity(), sd.deformation);
+            // change lattice at the same fractional coordinates
+            const Lattice& L0 = kbise0->getLattice();
+            for (int i = 0; i < kbise1->countSites(); ++i)
+            {
+                R3::Vector& xyz = (*kbise1)[i].xyz_cartn;
+                xyz = L0.fractional(xyz);
+            }
+            kbise1->setLatPar(14, 12, 4.2, 90, 98, 88);
+            const Lattice& L1 = kbise1->getLattice();
+            for (int i = 0; i < kbise1->countSites(); ++i)
+            {
+                R3::Vector& xyz = (*kbise1)[i].xyz_cartn;
+                xyz = L1.cartesian(xyz);
+            }
+            sd = kbise0->diff(kbise1);
+            TS_ASSERT_EQUALS(DM::LATTICE, sd.diffmethod);
+            TS_ASSERT_EQUALS(23u, sd.pop0.size());
+            TS_ASSERT_EQUALS(23u, sd.add1.size());
+            const double eps = 1e-12;
+            for (int i = 0; i < kbise0->countSites(); ++i)
+            {
+                R3::Vector r1 = R3::mxvecproduct(
+                        kbise0->siteCartesianPosition(i), sd.deformation);
+                const R3::Vector& xyz1 = kbise1->siteCartesianPosition(i);
+                TS_ASSERT_DELTA(xyz1[0], r1[0], eps);
+                TS_ASSERT_DELTA(xyz1[1], r1[1], eps);
+                TS_ASSERT_DELTA(xyz1[2], r1[2], eps);
+            }
+            // lattice change with other changes needs complete update
+            (*kbise1)[3].occupancy = 0.5;
+            sd = kbise0->diff(kbise1);
+            TS_ASSERT_EQUALS(DM::NONE, sd.diffmethod);
+        }
+
 };  // class TestPeriodicStructureAdapter
 
 //////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,88 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestQuantityAllocator -- unit tests for QuantityArena management
+*
+*****************************************************************************/
+
+#include <cxxtest/TestSuite.h>
+
+#include <boost/weak_ptr.hpp>
+#include <diffpy/srreal/QuantityType.hpp>
+
+using namespace std;
+using namespace diffpy::srreal;
+
+class TestQuantityAllocator : public CxxTest::TestSuite
+{
+    private:
+
+        typedef boost::shared_ptr<PooledQuantityArena> PooledArenaPtr;
+
+    public:
+
+        void tearDown()
+        {
+            setQuantityArena(QuantityArenaPtr());
+        }
+
+
+        void test_setQuantityArena()
+        {
+            PooledArenaPtr arena(new PooledQuantityArena);
+            setQuantityArena(arena);
+            TS_ASSERT_EQUALS(arena, getQuantityArena());
+            setQuantityArena(QuantityArenaPtr());
+            TS_ASSERT_DIFFERS(arena, getQuantityArena());
+            // unused arena is released right away
+            TS_ASSERT_EQUALS(1, arena.use_count());
+        }
+
+
+        void test_owningArena()
+        {
+            PooledArenaPtr arena0(new PooledQuantityArena);
+            PooledArenaPtr arena1(new PooledQuantityArena);
+            setQuantityArena(arena0);
+            QuantityType* y0 = new QuantityType(100);
+            setQuantityArena(arena1);
+            // arena0 is kept while its buffer is in use
+            TS_ASSERT_LESS_THAN(1, arena0.use_count());
+            QuantityType y1(100);
+            delete y0;
+            // buffer goes back to the arena that allocated it
+            TS_ASSERT_LESS_THAN(0u, arena0->pooledBytes());
+            TS_ASSERT_EQUALS(0u, arena1->pooledBytes());
+            TS_ASSERT_EQUALS(1, arena0.use_count());
+        }
+
+
+        void test_replaceArenas()
+        {
+            // repeated replacement does not accumulate arenas
+            boost::weak_ptr<PooledQuantityArena> first;
+            for (int i = 0; i < 10; ++i)
+            {
+                PooledArenaPtr arena(new PooledQuantityArena);
+                if (i == 0)  first = arena;
+                setQuantityArena(arena);
+                QuantityType y(50, 1.0);
+            }
+            setQuantityArena(QuantityArenaPtr());
+            TS_ASSERT(first.expired());
+        }
+
+};  // class TestQuantityAllocator
+
+// End of file
@@ -0,0 +1,174 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* class TestSIMDKernels -- unit tests for the instruction set variants
+*     of the numerical kernels
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cxxtest/TestSuite.h>
+
+#include <diffpy/srreal/SIMDKernels.hpp>
+#include <diffpy/srreal/PDFCalculator.hpp>
+#include <diffpy/srreal/DebyePDFCalculator.hpp>
+#include "test_helpers.hpp"
+
+using namespace std;
+using namespace diffpy::srreal;
+namespace sk = diffpy::srreal::simdkernels;
+
+
+class TestSIMDKernels : public CxxTest::TestSuite
+{
+    private:
+
+        string misa;
+        double meps;
+
+        double maxDifference(const QuantityType& x, const QuantityType& y)
+        {
+            double rv = (x.size() == y.size()) ? 0.0 : HUGE_VAL;
+            for (size_t i = 0; i < min(x.size(), y.size()); ++i)
+            {
+                rv = max(rv, fabs(x[i] - y[i]));
+            }
+            return rv;
+        }
+
+    public:
+
+        void setUp()
+        {
+            misa = sk::activeISA();
+            meps = 1e-12;
+        }
+
+
+        void tearDown()
+        {
+            sk::setISA(misa);
+        }
+
+
+        void test_activeISA()
+        {
+            vector<string> isas = sk::availableISAs();
+            TS_ASSERT(!isas.empty());
+            TS_ASSERT(isas.end() != find(isas.begin(), isas.end(), misa));
+        }
+
+
+        void test_setISA()
+        {
+            TS_ASSERT_THROWS(sk::setISA("invalid"), invalid_argument);
+            TS_ASSERT_EQUALS(misa, sk::activeISA());
+            vector<string> isas = sk::availableISAs();
+            sk::setISA(isas.front());
+            TS_ASSERT_EQUALS(isas.front(), sk::activeISA());
+        }
+
+
+        void test_addGaussianRDF()
+        {
+            const double rstep = 0.01;
+            const double dist = 2.5;
+            const double fwhm = 0.2;
+            const double scale = 3.0;
+            const double A = 2 * sqrt(M_LN2 / M_PI) / fwhm;
+            QuantityType y0(400, 0.0);
+            for (int i = 10; i < 350; ++i)
+            {
+                double x = (i + 50) * rstep - dist;
+                double g = A * exp(-4 * M_LN2 * pow(x / fwhm, 2));
+                y0[i] = scale * g * (x / dist + 1);
+            }
+            vector<string> isas = sk::availableISAs();
+            for (size_t k = 0; k < isas.size(); ++k)
+            {
+                sk::setISA(isas[k]);
+                QuantityType y1(400, 0.0);
+                sk::addGaussianRDF(y1.data(), 10, 350, 50,
+                        rstep, dist, fwhm, scale);
+                TS_ASSERT_DELTA(0.0, maxDifference(y0, y1), meps);
+            }
+        }
+
+
+        void test_addDebyeSine()
+        {
+            const int nq = 500;
+            const double qstep = 0.05;
+            const double dist = 2.5;
+            const double dwsigma = 0.2;
+            const double scale = 1.5;
+            const double prec = 1e-3;
+            QuantityType sf0(nq), sf1(nq);
+            for (int kq = 0; kq < nq; ++kq)
+            {
+                sf0[kq] = 2.0 - kq * 1e-3;
+                sf1[kq] = 3.0 - kq * 2e-3;
+            }
+            QuantityType y0(nq, 0.0);
+            for (int kq = 1; kq < nq; ++kq)
+            {
+                double q = kq * qstep;
+                double a = scale * sf0[kq] * sf1[kq] *
+                    exp(-0.5 * pow(dwsigma * q, 2));
+                if (fabs(a) <= prec)  break;
+                y0[kq] += a * sin(q * dist);
+            }
+            // make sure the summation was cut before the end
+            TS_ASSERT_EQUALS(0.0, y0.back());
+            vector<string> isas = sk::availableISAs();
+            for (size_t k = 0; k < isas.size(); ++k)
+            {
+                sk::setISA(isas[k]);
+                QuantityType y1(nq, 0.0);
+                sk::addDebyeSine(y1.data(), sf0.data(), sf1.data(), 1, nq,
+                        qstep, dist, dwsigma, scale, prec);
+                TS_ASSERT_DELTA(0.0, maxDifference(y0, y1), meps);
+            }
+        }
+
+
+        void test_calculators()
+        {
+            StructureAdapterPtr ni = loadTestPeriodicStructure("Ni.stru");
+            PDFCalculator pdfc;
+            DebyePDFCalculator dbpdfc;
+            pdfc.setEvaluatorType(BASIC);
+            dbpdfc.setEvaluatorType(BASIC);
+            dbpdfc.setRmax(5);
+            vector<string> isas = sk::availableISAs();
+            sk::setISA(isas.front());
+            QuantityType pdf0 = pdfc.eval(ni);
+            QuantityType fq0 = dbpdfc.eval(ni);
+            for (size_t k = 1; k < isas.size(); ++k)
+            {
+                sk::setISA(isas[k]);
+                QuantityType pdf1 = pdfc.eval(ni);
+                QuantityType fq1 = dbpdfc.eval(ni);
+                TS_ASSERT_DELTA(0.0, maxDifference(pdf0, pdf1), 1e-8);
+                TS_ASSERT_DELTA(0.0, maxDifference(fq0, fq1), 1e-8);
+            }
+        }
+
+};  // class TestSIMDKernels
+
+// End of file
@@ -0,0 +1,165 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Definitions of helper functions for the performance tests.
+*
+*****************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include <diffpy/runtimepath.hpp>
+
+#include "test_helpers.hpp"
+#include "perf_helpers.hpp"
+
+using namespace std;
+
+namespace {
+
+const double DEFAULT_PERF_THRESHOLD = 0.6;
+
+// Fixed workload of Gaussian sums similar to the PDF peak rendering.
+double computeLoop()
+{
+    const int npts = 1000;
+    vector<double> y(npts, 0.0);
+    for (int k = 0; k < 250; ++k)
+    {
+        const double x0 = 0.02 * k;
+        for (int i = 0; i < npts; ++i)
+        {
+            const double dx = 0.01 * i - x0;
+            y[i] += exp(-dx * dx) * sin(dx);
+        }
+    }
+    double rv = 0.0;
+    for (int i = 0; i < npts; ++i)  rv += y[i];
+    return rv;
+}
+
+
+// Fixed workload of dependent random reads and data dependent branches
+// similar to the bond generator and structure lookups.
+double memoryLoop()
+{
+    const int n = 1 << 20;
+    static vector<int> next;
+    if (next.empty())
+    {
+        // single cycle permutation from a linear congruential generator
+        vector<int> order(n);
+        for (int i = 0; i < n; ++i)  order[i] = i;
+        unsigned int seed = 12345;
+        for (int i = n - 1; i > 0; --i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            swap(order[i], order[(seed >> 8) % (i + 1)]);
+        }
+        next.resize(n);
+        for (int i = 0; i < n; ++i)  next[order[i]] = order[(i + 1) % n];
+    }
+    double rv = 0.0;
+    int k = 0;
+    for (int i = 0; i < 200000; ++i)
+    {
+        k = next[k];
+        if (k & 1)  rv += k;
+        else  rv -= 0.5 * k;
+    }
+    return rv;
+}
+
+
+map<string, double> loadBaseline()
+{
+    map<string, double> rv;
+    string fname = prepend_testdata_dir("perf_baseline.dat");
+    ifstream fp(fname.c_str());
+    diffpy::runtimepath::LineReader line;
+    while (fp >> line)
+    {
+        if (line.isignored())  continue;
+        if (line.wcount() != 2)
+        {
+            throw line.format_error(fname, "Expected name and value.");
+        }
+        rv[line.words[0]] = atof(line.words[1].c_str());
+    }
+    return rv;
+}
+
+}   // namespace
+
+// Performance helpers -------------------------------------------------------
+
+double perf_calibrationTime()
+{
+    using namespace std::chrono;
+    static volatile double sink = memoryLoop();
+    steady_clock::time_point t0 = steady_clock::now();
+    sink = sink + computeLoop() + memoryLoop();
+    double rv = duration<double>(steady_clock::now() - t0).count();
+    return rv;
+}
+
+
+double perf_median(vector<double> values)
+{
+    if (values.empty())  return 0.0;
+    const size_t m = values.size() / 2;
+    nth_element(values.begin(), values.begin() + m, values.end());
+    double rv = values[m];
+    if (values.size() % 2 == 0)
+    {
+        rv = 0.5 * (rv + *max_element(values.begin(), values.begin() + m));
+    }
+    return rv;
+}
+
+
+double perf_baseline(const string& name)
+{
+    static map<string, double> baseline = loadBaseline();
+    map<string, double>::const_iterator ii = baseline.find(name);
+    if (ii == baseline.end())
+    {
+        string emsg = "Missing performance baseline for " + name + ".";
+        throw invalid_argument(emsg);
+    }
+    return ii->second;
+}
+
+
+double perf_threshold()
+{
+    const char* ev = getenv("DIFFPYPERFTHRESHOLD");
+    double rv = ev ? atof(ev) : DEFAULT_PERF_THRESHOLD;
+    return rv;
+}
+
+
+double perf_budget(const string& name)
+{
+    double rv = perf_baseline(name) * (1.0 + perf_threshold());
+    return rv;
+}
+
+// End of file
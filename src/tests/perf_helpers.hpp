@@ -0,0 +1,71 @@
+/*****************************************************************************
+*
+* libdiffpy         Complex Modeling Initiative
+*                   (c) 2026 Brookhaven Science Associates,
+*                   Brookhaven National Laboratory.
+*                   All rights reserved.
+*
+* File coded by:    Pavol Juhas
+*
+* See AUTHORS.txt for a list of people who contributed.
+* See LICENSE.txt for license information.
+*
+******************************************************************************
+*
+* Helper functions for the performance tests.
+*
+* Execution times are normalized by the time of a fixed calibration loop of
+* floating point sums and random memory reads so that they can be compared
+* between machines of different speed.  The
+* reference values are stored in the testdata/perf_baseline.dat file.
+* A test fails when its normalized time exceeds the baseline value by
+* more than the allowed threshold, which can be changed with the
+* DIFFPYPERFTHRESHOLD environment variable.
+*
+*****************************************************************************/
+
+#ifndef PERF_HELPERS_HPP_INCLUDED
+#define PERF_HELPERS_HPP_INCLUDED
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+/// Execution time in seconds of a single run of the calibration loop
+double perf_calibrationTime();
+
+/// Median of the values
+double perf_median(std::vector<double> values);
+
+/// Normalized time for the named test in the baseline file.
+/// Throw invalid_argument when the name is not in the baseline.
+double perf_baseline(const std::string& name);
+
+/// Allowed relative excess over the baseline, by default 0.6.
+double perf_threshold();
+
+/// Maximum normalized time for the named test.
+double perf_budget(const std::string& name);
+
+/// Median time of repeated calls of f divided by the median time of
+/// calibration runs.  Calibration runs are interleaved with the calls
+/// of f so that changes of machine load affect both times alike.
+template <class F>
+double perf_normalizedTime(F f, int repeats=7)
+{
+    using namespace std::chrono;
+    std::vector<double> tcalls, tcalibration;
+    for (int i = 0; i < repeats; ++i)
+    {
+        tcalibration.push_back(perf_calibrationTime());
+        steady_clock::time_point t0 = steady_clock::now();
+        f();
+        double t = duration<double>(steady_clock::now() - t0).count();
+        tcalls.push_back(t);
+    }
+    tcalibration.push_back(perf_calibrationTime());
+    return perf_median(tcalls) / perf_median(tcalibration);
+}
+
+#endif  // PERF_HELPERS_HPP_INCLUDED